@@ -0,0 +1,130 @@
+#include "fuzz_frame.h"
+#include "MicroUSC/synced_driver/esp_uart.h"
+#include "MicroUSC/synced_driver/frame_codec.h"
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define FUZZ_PORT (UART_NUM_1)
+
+#define FUZZ_CHECK(cond) do {                                                  \
+        if (!(cond)) {                                                         \
+            fprintf(stderr, "%s:%d: check failed: %s\n", __FILE__, __LINE__, #cond); \
+            abort();                                                           \
+        }                                                                      \
+    } while (0)
+
+/* The UART as uart_read_frame() sees it, replaying the input one chunk per poll */
+static struct {
+    const uint8_t *data;
+    size_t size;
+    size_t pos;        // next byte handed out
+    size_t arrived;    // bytes on the wire so far
+    uint32_t fail_every;
+    uint32_t polls;
+} fake;
+
+esp_err_t uart_get_buffered_data_len(uart_port_t uart_num, size_t *size)
+{
+    (void)uart_num;
+    if (fake.fail_every != 0 && ++fake.polls % fake.fail_every == 0) {
+        return ESP_FAIL;
+    }
+    *size = fake.arrived - fake.pos;
+    return ESP_OK;
+}
+
+int uart_read_bytes(uart_port_t uart_num, void *buf, uint32_t length, TickType_t ticks_to_wait)
+{
+    (void)uart_num;
+    (void)ticks_to_wait;
+    const size_t available = fake.arrived - fake.pos;
+    const size_t n = (length < available) ? length : available;
+    memcpy(buf, fake.data + fake.pos, n);
+    fake.pos += n;
+    return (int)n;
+}
+
+/* Referenced by uart_init(), never called here */
+esp_err_t uart_param_config(uart_port_t uart_num, const uart_config_t *uart_config) { return ESP_OK; }
+esp_err_t uart_set_pin(uart_port_t uart_num, int tx_io_num, int rx_io_num, int rts_io_num, int cts_io_num) { return ESP_OK; }
+esp_err_t uart_driver_install(uart_port_t uart_num, int rx_buffer_size, int tx_buffer_size,
+                              int queue_size, void *uart_queue, int intr_alloc_flags) { return ESP_OK; }
+
+void fuzz_frame_run(const uint8_t *data, size_t size, fuzz_frame_totals_t *totals)
+{
+    if (size < FUZZ_FRAME_HEADER) {
+        return;
+    }
+
+    const size_t len = data[0] % (2 * USC_FRAME_SIZE + 1);
+    const size_t step = (data[1] & 0x0F) + 1;
+    fake.data = data + FUZZ_FRAME_HEADER;
+    fake.size = size - FUZZ_FRAME_HEADER;
+    fake.pos = 0;
+    fake.arrived = 0;
+    fake.fail_every = (data[1] >> 4) ? (data[1] >> 4) + 1u : 0; /* not on every call, or nothing would drain */
+    fake.polls = 0;
+
+    /* Exactly len bytes, so the sanitizer catches anything written past them */
+    uint8_t *buf = malloc(len);
+    fuzz_frame_totals_t local = { .inputs = 1, .bytes = fake.size };
+
+    /* Each poll either lets more bytes arrive or, once all have, consumes at least one */
+    const size_t max_polls = 3 * fake.size + 16;
+    bool drained = false;
+    for (size_t poll = 0; poll < max_polls && !drained; poll++) {
+        fake.arrived = (fake.size - fake.arrived > step) ? fake.arrived + step : fake.size;
+        const size_t before = fake.pos;
+
+        uart_frame_status_t status;
+        const uint8_t *frame = uart_read_frame(FUZZ_PORT, buf, len, 0, &status);
+        const size_t consumed = fake.pos - before;
+
+        switch (status) {
+            case UART_FRAME_OK: {
+                uint32_t word;
+                FUZZ_CHECK(frame == buf);
+                FUZZ_CHECK(consumed == USC_FRAME_SIZE);
+                FUZZ_CHECK(usc_frame_decode(frame, len, &word));
+                FUZZ_CHECK(memcmp(frame, fake.data + before, USC_FRAME_SIZE) == 0);
+                local.frames++;
+                break;
+            }
+            case UART_FRAME_RESYNC:
+                FUZZ_CHECK(frame == NULL);
+                FUZZ_CHECK(consumed == USC_FRAME_SIZE || consumed == USC_FRAME_SIZE + 1);
+                local.resyncs++;
+                break;
+            case UART_FRAME_INCOMPLETE:
+                FUZZ_CHECK(frame == NULL);
+                FUZZ_CHECK(consumed == 0);
+                FUZZ_CHECK(fake.arrived - fake.pos < USC_FRAME_SIZE);
+                drained = (fake.arrived == fake.size);
+                break;
+            case UART_FRAME_ERROR:
+                FUZZ_CHECK(frame == NULL);
+                FUZZ_CHECK(consumed == 0);
+                drained = (len < USC_FRAME_SIZE); /* a buffer this small never gets a frame */
+                break;
+            default:
+                FUZZ_CHECK(!"unknown status");
+        }
+    }
+    FUZZ_CHECK(drained);
+    free(buf);
+
+    if (totals != NULL) {
+        totals->inputs += local.inputs;
+        totals->bytes += local.bytes;
+        totals->frames += local.frames;
+        totals->resyncs += local.resyncs;
+    }
+}
+
+int LLVMFuzzerTestOneInput(const uint8_t *data, size_t size)
+{
+    fuzz_frame_run(data, size, NULL);
+    return 0;
+}
@@ -0,0 +1,37 @@
+#pragma once
+
+/*
+ * Fuzz harness for the frame decoding path of the MicroUSC UART layer.
+ *
+ * An input is a two byte header followed by the bytes arriving on the UART:
+ *
+ *     [buffer length][arrival][stream...]
+ *
+ * The first byte picks the buffer handed to uart_read_frame(), 0 to 2 * USC_FRAME_SIZE
+ * bytes, allocated to exactly that size so any access past it is caught. In the second,
+ * the low nibble is how many bytes arrive per poll minus one, and a high nibble n makes
+ * every (n + 1)-th uart_get_buffered_data_len() fail, 0 for never.
+ *
+ * Every read is checked: a frame is only delivered when those exact six bytes were next
+ * in the stream with both delimiters in place, a rejected read consumes the frame plus
+ * at most one byte, and the stream always drains.
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define FUZZ_FRAME_HEADER (2)
+
+typedef struct {
+    uint64_t inputs;
+    uint64_t bytes;   // stream bytes, headers excluded
+    uint64_t frames;  // delivered by uart_read_frame()
+    uint64_t resyncs;
+} fuzz_frame_totals_t;
+
+/**
+ * @brief Decode one input, aborting on the first violated check.
+ *
+ * @param totals Accumulates what was decoded, may be NULL.
+ */
+void fuzz_frame_run(const uint8_t *data, size_t size, fuzz_frame_totals_t *totals);
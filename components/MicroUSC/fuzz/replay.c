@@ -0,0 +1,151 @@
+/*
+ * Reruns fuzz_frame over a corpus without libFuzzer: every input once under the
+ * harness checks, then the whole corpus repeatedly for a second to measure decode
+ * throughput. The result is printed as `FUZZ {json}` so runs can be compared.
+ *
+ *     fuzz_frame_replay <file or directory>...
+ */
+
+#include "fuzz_frame.h"
+#include <dirent.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <time.h>
+
+#define REPLAY_MIN_NS (1000000000ull) // time the corpus for at least a second
+
+#ifdef MICROUSC_FUZZ_SANITIZE
+#define REPLAY_SANITIZED "true"
+#else
+#define REPLAY_SANITIZED "false"
+#endif
+
+typedef struct {
+    uint8_t *data;
+    size_t size;
+} input_t;
+
+static input_t *inputs;
+static size_t input_count;
+static size_t input_capacity;
+
+static bool load_file(const char *path)
+{
+    FILE *f = fopen(path, "rb");
+    if (f == NULL) {
+        perror(path);
+        return false;
+    }
+    fseek(f, 0, SEEK_END);
+    const long size = ftell(f);
+    fseek(f, 0, SEEK_SET);
+
+    if (input_count == input_capacity) {
+        const size_t capacity = input_capacity ? 2 * input_capacity : 64;
+        input_t *grown = realloc(inputs, capacity * sizeof(*inputs));
+        if (grown == NULL) {
+            fclose(f);
+            fprintf(stderr, "out of memory\n");
+            return false;
+        }
+        inputs = grown;
+        input_capacity = capacity;
+    }
+    input_t *in = &inputs[input_count];
+    in->size = (size > 0) ? (size_t)size : 0;
+    in->data = malloc(in->size ? in->size : 1);
+    const bool ok = in->data != NULL && fread(in->data, 1, in->size, f) == in->size;
+    fclose(f);
+    if (!ok) {
+        fprintf(stderr, "%s: could not read\n", path);
+        return false;
+    }
+    input_count++;
+    return true;
+}
+
+static bool load_path(const char *path)
+{
+    struct stat st;
+    if (stat(path, &st) != 0) {
+        perror(path);
+        return false;
+    }
+    if (!S_ISDIR(st.st_mode)) {
+        return load_file(path);
+    }
+
+    DIR *dir = opendir(path);
+    if (dir == NULL) {
+        perror(path);
+        return false;
+    }
+    bool ok = true;
+    struct dirent *entry;
+    while (ok && (entry = readdir(dir)) != NULL) {
+        if (entry->d_name[0] == '.') {
+            continue;
+        }
+        char child[4096];
+        snprintf(child, sizeof(child), "%s/%s", path, entry->d_name);
+        ok = load_path(child);
+    }
+    closedir(dir);
+    return ok;
+}
+
+static uint64_t now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+int main(int argc, char **argv)
+{
+    if (argc < 2) {
+        fprintf(stderr, "usage: %s <file or directory>...\n", argv[0]);
+        return 2;
+    }
+    for (int i = 1; i < argc; i++) {
+        if (!load_path(argv[i])) {
+            return 1;
+        }
+    }
+    if (input_count == 0) {
+        fprintf(stderr, "empty corpus\n");
+        return 1;
+    }
+
+    /* Any failed check aborts in here */
+    fuzz_frame_totals_t pass = { 0 };
+    for (size_t i = 0; i < input_count; i++) {
+        fuzz_frame_run(inputs[i].data, inputs[i].size, &pass);
+    }
+
+    fuzz_frame_totals_t timed = { 0 };
+    const uint64_t start = now_ns();
+    uint64_t elapsed;
+    do {
+        for (size_t i = 0; i < input_count; i++) {
+            fuzz_frame_run(inputs[i].data, inputs[i].size, &timed);
+        }
+        elapsed = now_ns() - start;
+    } while (elapsed < REPLAY_MIN_NS);
+
+    const double seconds = (double)elapsed / 1e9;
+    printf("FUZZ {\"inputs\":%zu,\"bytes\":%llu,\"frames\":%llu,\"resyncs\":%llu,"
+           "\"mb_per_s\":%.2f,\"frames_per_s\":%.0f,\"sanitized\":%s}\n",
+           input_count, (unsigned long long)pass.bytes, (unsigned long long)pass.frames,
+           (unsigned long long)pass.resyncs, (double)timed.bytes / seconds / 1e6,
+           (double)timed.frames / seconds, REPLAY_SANITIZED);
+
+    for (size_t i = 0; i < input_count; i++) {
+        free(inputs[i].data);
+    }
+    free(inputs);
+    return 0;
+}
@@ -0,0 +1,12 @@
+#pragma once
+
+#include <stdlib.h>
+
+typedef int esp_err_t;
+
+#define ESP_OK              (0)
+#define ESP_FAIL            (-1)
+#define ESP_ERR_NO_MEM      (0x101)
+#define ESP_ERR_INVALID_ARG (0x102)
+
+#define ESP_ERROR_CHECK(x) do { if ((x) != ESP_OK) { abort(); } } while (0)
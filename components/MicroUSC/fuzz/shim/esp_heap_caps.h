@@ -0,0 +1,3 @@
+#pragma once
+
+/* Included by esp_uart.c, nothing from it is used */
@@ -0,0 +1,15 @@
+#pragma once
+
+/*
+ * Just enough of FreeRTOS for the UART layer to compile on the host without ESP-IDF.
+ * The fake UART in fuzz_frame.c never blocks, so ticks carry no meaning.
+ */
+
+#include <stdint.h>
+
+typedef uint32_t TickType_t;
+typedef int BaseType_t;
+typedef unsigned int UBaseType_t;
+
+#define pdMS_TO_TICKS(ms) ((TickType_t)(ms))
+#define portMAX_DELAY     ((TickType_t)0xFFFFFFFF)
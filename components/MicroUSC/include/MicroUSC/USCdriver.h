@@ -18,6 +18,7 @@
  * - Thread-safe data transmission and event-driven design
  * - Secure password request and connectivity verification protocols
  * - Integration with ESP-IDF's UART driver, FreeRTOS queues, and MicroUSC system configuration
+ * - Typed application messages declared with USC_SCHEMA_DECLARE() (synced_driver/message_schema.h)
  *
  * Usage:
  * - Call usc_driver_install() first to configure and install the UART driver.
@@ -34,6 +35,7 @@
 #include "MicroUSC/system/manager.h"
 #include "MicroUSC/system/memory_pool.h"
 #include "MicroUSC/synced_driver/esp_uart.h"
+#include "MicroUSC/synced_driver/message_schema.h"
 #include "MicroUSC/uscUniversal.h"
 #include "esp_system.h"
 
@@ -60,6 +62,32 @@ typedef void (*usc_process_t)(void *);
 
 typedef struct usc_driver_t *uscDriverHandler;
 
+/**
+ * @brief Performance counters of one driver, see usc_driver_get_stats().
+ *
+ * Counts start at install time or at the last usc_driver_reset_stats().
+ */
+typedef struct {
+    uint32_t frames_rx;          ///< Frames received with valid delimiters
+    uint32_t frames_tx;          ///< Frames written to the UART
+    uint64_t bytes_rx;           ///< Bytes consumed from the UART, including discarded ones
+    uint64_t bytes_tx;           ///< Bytes written to the UART
+    uint32_t parse_errors;       ///< Frames with bad delimiters or a zero word
+    uint32_t resyncs;            ///< Bytes skipped to realign a slipped stream
+    uint32_t queue_high_water;   ///< Most words ever waiting in the data queue
+    uint32_t queue_drops;        ///< Words dropped because the data queue was full
+    uint32_t handshake_attempts; ///< Serial key exchanges tried
+    uint32_t lock_waits;         ///< Times the driver lock was taken
+    uint64_t lock_wait_us;       ///< Total time spent waiting for the driver lock
+    uint32_t lock_wait_max_us;   ///< Longest single wait for the driver lock
+    uint32_t wakes;              ///< Words taken by the processor task that found the queue empty before them
+    uint64_t wake_us;            ///< Total time those words waited for the processor task
+    uint32_t wake_max_us;        ///< Longest wait of such a word, the worst processor wake-up latency
+    uint32_t sleep_wakes;        ///< Automatic light sleeps after which a frame arrived, see sleep_mode_auto_light_enable()
+    uint64_t sleep_wake_us;      ///< Total time from those wake-ups to the first frame
+    uint32_t sleep_wake_max_us;  ///< Longest time from a wake-up to the first frame
+} usc_driver_stats_t;
+
 /**
  * @brief Initialize a UART-based driver for the ESP32.
  * 
@@ -74,9 +102,13 @@ typedef struct usc_driver_t *uscDriverHandler;
  * @param stack_size      Stack size for UART driver task (recommended: appropriate for expected data loads).
  * 
  * @return
- * - **ESP_OK**: Successfully initialized the driver.
- * - **ESP_ERR_INVALID_ARG**: Provided `port_config` has invalid GPIO settings or `driver_process` is NULL.
- * - **ESP_FAIL**: Invalid `uart_config` (e.g., unsupported baud rate) or failure in UART driver installation.
+ * - **ESP_OK**: Successfully initialized the driver, its reader task is running.
+ * - **ESP_ERR_INVALID_ARG**: Provided `port_config` has an invalid UART port or `driver_process` is NULL.
+ * - **ESP_ERR_INVALID_STATE**: The UART port already has a driver.
+ * - **ESP_ERR_NO_MEM**: No driver slot left.
+ * - **ESP_ERR_TIMEOUT**: The reader task did not start.
+ *
+ * On an error the partly installed driver is removed again, so the call may be retried.
  * 
  * @note
  * - The caller must verify that assigned GPIO pins do not conflict with other peripherals.
@@ -90,6 +122,61 @@ esp_err_t usc_driver_install( const char *const driver_name,
                               const stack_size_t stack_size
                             );
 
+/**
+ * @brief Find the driver installed on a UART port.
+ *
+ * The processor task receives its driver as its parameter; this gives the handle to
+ * any other task, for example right after usc_driver_install().
+ *
+ * @param port UART port the driver was installed on.
+ * @return The driver handle, or NULL if the port has no driver.
+ */
+uscDriverHandler usc_driver_get_handle(uart_port_t port);
+
+/**
+ * @brief Stop and remove an installed driver.
+ *
+ * The reader task is stopped at the end of its current loop iteration and deleted, then
+ * the processor task is deleted, the UART driver is uninstalled, and the driver's memory
+ * and index are released for the next usc_driver_install(). The driver is no longer
+ * restored by warm boot; its lifetime counters are kept (MicroUSC/system/persist.h).
+ *
+ * The processor task is deleted wherever it is, so it must not hold another driver's
+ * lock (usc_driver_lock(), microusc::DriverLock) while this may run: that lock would
+ * never be given back.
+ *
+ * @param driver Handle to the installed driver, invalid once this returns ESP_OK.
+ *
+ * @return
+ * - **ESP_OK**: Driver removed.
+ * - **ESP_ERR_INVALID_ARG**: NULL driver.
+ * - **ESP_ERR_NOT_FOUND**: The handle is not an installed driver.
+ * - **ESP_ERR_INVALID_STATE**: Called from the driver's own reader or processor task, or
+ *   while the drivers are paused (USC_SYSTEM_PAUSE).
+ * - **ESP_ERR_TIMEOUT**: The driver lock or the reader task did not come free. Nothing
+ *   was removed and the call may be retried.
+ */
+esp_err_t usc_driver_deinit(uscDriverHandler driver);
+
+/**
+ * @brief Take the driver lock, for several operations no other task may come between.
+ *
+ * While it is held, only the _locked functions may be used on the driver; the others
+ * take the lock themselves and would block. Hold it briefly: the reader task waits too.
+ * A processor task holding another driver's lock must not be removed meanwhile, see
+ * usc_driver_deinit().
+ *
+ * @param driver  Handle to the installed driver.
+ * @param timeout Ticks to wait, portMAX_DELAY to wait forever.
+ * @return ESP_OK, ESP_ERR_INVALID_ARG for a NULL driver, or ESP_ERR_TIMEOUT.
+ */
+esp_err_t usc_driver_lock(uscDriverHandler driver, TickType_t timeout);
+
+/**
+ * @brief Release the driver lock taken with usc_driver_lock().
+ */
+void usc_driver_unlock(uscDriverHandler driver);
+
 /**
  * @brief Retrieve UART data from the driver.
  * 
@@ -111,6 +198,158 @@ uint32_t usc_driver_get_data(uscDriverHandler driver);
 
 esp_err_t usc_send_data(uscDriverHandler driver, uint32_t data);
 
+/**
+ * @brief usc_driver_get_data() for a caller holding usc_driver_lock().
+ */
+uint32_t usc_driver_get_data_locked(uscDriverHandler driver);
+
+/**
+ * @brief usc_send_data() for a caller holding usc_driver_lock().
+ */
+esp_err_t usc_send_data_locked(uscDriverHandler driver, uint32_t data);
+
+/**
+ * @brief Register a handler for an incoming word or an inclusive range of words.
+ *
+ * The driver's reader task looks up every received word in a per-driver dispatch
+ * table and calls the matching handler directly, without waking the processor task.
+ * Lookup is direct-indexed for small codes and hashed for large ones, so latency does
+ * not depend on how many handlers are registered.
+ *
+ * @param driver  Handle to the installed driver.
+ * @param codes   Word(s) to match, built with USC_CODE(x) or USC_CODE_RANGE(lo, hi).
+ * @param fn      Handler, or NULL to remove the registration for exactly these codes.
+ * @param ctx     User pointer passed back to the handler.
+ *
+ * @return
+ * - **ESP_OK**: Handler registered (or removed).
+ * - **ESP_ERR_INVALID_ARG**: NULL driver or `codes.first > codes.last`.
+ * - **ESP_ERR_NO_MEM**: Hashed table or range list is full.
+ * - **ESP_ERR_TIMEOUT**: Could not acquire the driver lock.
+ *
+ * @note
+ * - Handlers run in the reader task after the driver lock is released, so they may call
+ *   usc_send_data(). They should return quickly to keep the reader responsive.
+ * - A handler returning false also places the word in the driver's queue for
+ *   usc_driver_get_data().
+ * - Words without a handler go to the default handler if one is set, otherwise to the queue.
+ */
+esp_err_t usc_register_handler(uscDriverHandler driver, usc_code_range_t codes, usc_handler_t fn, void *ctx);
+
+/**
+ * @brief Set the handler called for words that match no registered code.
+ *
+ * @param driver  Handle to the installed driver.
+ * @param fn      Default handler, or NULL to send unmatched words to the queue (default).
+ * @param ctx     User pointer passed back to the handler.
+ *
+ * @return ESP_OK, ESP_ERR_INVALID_ARG for a NULL driver, or ESP_ERR_TIMEOUT.
+ */
+esp_err_t usc_register_default_handler(uscDriverHandler driver, usc_handler_t fn, void *ctx);
+
+/**
+ * @brief Counters of one route, see usc_route_get_stats().
+ */
+typedef struct {
+    uint32_t matched;   ///< Received words in the route's code range
+    uint32_t forwarded; ///< Frames written to a destination, one per destination and word
+    uint32_t dropped;   ///< Frames not written: the destination's handshake was not done, or its TX buffer was full
+    uint64_t bytes;     ///< Bytes written to the destinations
+} usc_route_stats_t;
+
+/**
+ * @brief Forward received words from one driver to others, without a processor task.
+ *
+ * The source's reader task writes every received word in codes to each destination
+ * UART as soon as it is parsed, before dispatch. The destination drivers' locks are
+ * not taken: a frame is written with a single UART write, so it never interleaves with
+ * the destination's own frames. Frames for a destination whose handshake is not done,
+ * or whose TX buffer has no room for the whole frame, are dropped: the reader never
+ * waits on a slow destination.
+ *
+ * Routes are not restored by warm boot. A destination removed with usc_driver_deinit()
+ * is removed from every route, and a route left without destinations is removed too.
+ *
+ * @param from     Source driver.
+ * @param to       Destination drivers, one for a plain forward, more to broadcast.
+ * @param to_count Number of destinations, at most DRIVER_MAX - 1.
+ * @param codes    Words to forward, USC_CODE_ALL for all of them.
+ * @param flags    usc_route_flags_t values combined with |, USC_ROUTE_FORWARD for none.
+ * @param route    Receives the route ID, may be NULL.
+ *
+ * @return
+ * - **ESP_OK**: Route added.
+ * - **ESP_ERR_INVALID_ARG**: A NULL or repeated driver, the source among the destinations,
+ *   or an empty range.
+ * - **ESP_ERR_NOT_FOUND**: A driver is not installed.
+ * - **ESP_ERR_NO_MEM**: The source already has USC_ROUTE_MAX routes.
+ * - **ESP_ERR_TIMEOUT**: The source's driver lock could not be acquired.
+ */
+esp_err_t usc_route_add( uscDriverHandler from,
+                         const uscDriverHandler *to,
+                         size_t to_count,
+                         usc_code_range_t codes,
+                         uint32_t flags,
+                         usc_route_t *route
+                       );
+
+/**
+ * @brief Stop forwarding over a route.
+ *
+ * @return ESP_OK, ESP_ERR_INVALID_ARG for a NULL driver, ESP_ERR_NOT_FOUND for a route
+ *         that does not exist, or ESP_ERR_TIMEOUT.
+ */
+esp_err_t usc_route_remove(uscDriverHandler from, usc_route_t route);
+
+/**
+ * @brief Copy the counters of a route.
+ *
+ * @return ESP_OK, ESP_ERR_INVALID_ARG for a NULL pointer, ESP_ERR_NOT_FOUND for a route
+ *         that does not exist, or ESP_ERR_TIMEOUT.
+ */
+esp_err_t usc_route_get_stats(uscDriverHandler from, usc_route_t route, usc_route_stats_t *stats);
+
+/**
+ * @brief Supervise the driver's tasks with the MicroUSC software watchdog.
+ *
+ * The reader task feeds the watchdog on every loop iteration, so a reader stuck in a
+ * UART read or waiting on a deadlocked driver lock is reported once timeout_ms passes
+ * without progress. The report captures the task's state and runs the system error
+ * handler, see MicroUSC/system/watchdog.h.
+ *
+ * @param driver              Handle to the installed driver.
+ * @param timeout_ms          Longest allowed time between feeds, at least MICROUSC_WATCHDOG_CHECK_MS.
+ * @param supervise_processor Also supervise the processor task, which must then call
+ *                            usc_driver_feed_watchdog() in its loop.
+ *
+ * @return ESP_OK, ESP_ERR_INVALID_ARG, or ESP_ERR_NO_MEM if the watchdog table is full.
+ */
+esp_err_t usc_driver_enable_watchdog(uscDriverHandler driver, uint32_t timeout_ms, bool supervise_processor);
+
+/**
+ * @brief Heartbeat for the driver's processor task. Does nothing if it is not supervised.
+ */
+void usc_driver_feed_watchdog(uscDriverHandler driver);
+
+/**
+ * @brief Copy the driver's performance counters.
+ *
+ * Does not take the driver lock, so it is safe to call from any task at any rate.
+ * Each field is read atomically; fields may be a few updates apart from each other.
+ *
+ * @param driver Handle to the installed driver.
+ * @param stats  Receives the counters.
+ * @return ESP_OK, or ESP_ERR_INVALID_ARG if either pointer is NULL.
+ */
+esp_err_t usc_driver_get_stats(uscDriverHandler driver, usc_driver_stats_t *stats);
+
+/**
+ * @brief Zero the driver's performance counters.
+ *
+ * @return ESP_OK, or ESP_ERR_INVALID_ARG for a NULL driver.
+ */
+esp_err_t usc_driver_reset_stats(uscDriverHandler driver);
+
 #ifdef __cplusplus
 }
 #endif
\ No newline at end of file
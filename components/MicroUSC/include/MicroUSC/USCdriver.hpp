@@ -0,0 +1,288 @@
+/*
+ * SPDX-FileCopyrightText: 2025 Alejandro Ramirez
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/**
+ * @file USCdriver.hpp
+ * @brief Header-only C++17 layer over the driver API in USCdriver.h.
+ *
+ * - microusc::Driver owns an installed driver and removes it with usc_driver_deinit()
+ *   when destroyed. It is move-only.
+ * - microusc::DriverRef is a non-owning handle, for the processor task, which receives
+ *   its driver as the task parameter.
+ * - microusc::DriverLock holds the driver lock for a scope, and its send()/receive()
+ *   use the _locked C functions, so a batch of words goes out with nothing in between.
+ * - send<T>() and receive<T>() carry any trivially copyable type that fits in the one
+ *   32-bit word of a frame. A larger type fails to compile.
+ *
+ * Every member is inline and forwards to one C call, so the generated code is the same
+ * as calling the C API by hand (see cxx_benchmarks.h in the benchmarks component). No
+ * exceptions are thrown: errors are returned as esp_err_t, as in the C API.
+ *
+ * @author Alejandro Ramirez
+ * @date August 7, 2025
+ */
+
+#pragma once
+
+#include "MicroUSC/USCdriver.h"
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+#include <utility>
+
+namespace microusc {
+
+/// Payload of one frame.
+using word_t = uint32_t;
+
+/// Whether T can be sent and received with send<T>() and receive<T>().
+template <typename T>
+inline constexpr bool is_message_v = std::is_trivially_copyable_v<T> &&
+                                     std::is_trivially_default_constructible_v<T> &&
+                                     !std::is_pointer_v<T> &&
+                                     sizeof(T) <= sizeof(word_t);
+
+namespace detail {
+
+template <typename T>
+inline void check_message() noexcept
+{
+    static_assert(std::is_trivially_copyable_v<T>, "a message is copied byte for byte into a frame");
+    static_assert(std::is_trivially_default_constructible_v<T>, "a message is created from the bytes of a frame");
+    static_assert(!std::is_pointer_v<T>, "a pointer means nothing on the other end of the UART");
+    static_assert(sizeof(T) <= sizeof(word_t), "a message must fit in the 32-bit word of one frame");
+}
+
+/// Pack a message into a word, the unused high bytes zero.
+template <typename T>
+[[gnu::always_inline]] inline word_t to_word(const T &message) noexcept
+{
+    check_message<T>();
+    if constexpr (std::is_same_v<T, word_t>) {
+        return message;
+    }
+    else {
+        word_t word = 0;
+        std::memcpy(&word, &message, sizeof(T));
+        return word;
+    }
+}
+
+template <typename T>
+[[gnu::always_inline]] inline T from_word(const word_t word) noexcept
+{
+    check_message<T>();
+    if constexpr (std::is_same_v<T, word_t>) {
+        return word;
+    }
+    else {
+        T message;
+        std::memcpy(&message, &word, sizeof(T));
+        return message;
+    }
+}
+
+} // namespace detail
+
+/**
+ * @brief Driver lock held for a scope, see usc_driver_lock().
+ *
+ * Obtained from DriverRef::lock(). Check it before use: it is empty when the lock was
+ * not taken in time. While it lives, use its send()/receive(), not the driver's. Its
+ * destructor never runs in a processor task deleted by usc_driver_deinit(), so a
+ * processor must not hold another driver's lock while its own driver may be removed.
+ */
+class DriverLock {
+public:
+    DriverLock(const DriverLock &) = delete;
+    DriverLock &operator=(const DriverLock &) = delete;
+
+    DriverLock(DriverLock &&other) noexcept : handle_(std::exchange(other.handle_, nullptr)) {}
+
+    DriverLock &operator=(DriverLock &&other) noexcept
+    {
+        if (this != &other) {
+            unlock();
+            handle_ = std::exchange(other.handle_, nullptr);
+        }
+        return *this;
+    }
+
+    ~DriverLock() { unlock(); }
+
+    /// Whether the lock is held.
+    explicit operator bool() const noexcept { return handle_ != nullptr; }
+
+    /// Release the lock before the end of the scope.
+    void unlock() noexcept
+    {
+        if (handle_ != nullptr) {
+            usc_driver_unlock(std::exchange(handle_, nullptr));
+        }
+    }
+
+    /// usc_send_data_locked() of a message.
+    template <typename T>
+    esp_err_t send(const T &message) const noexcept
+    {
+        return usc_send_data_locked(handle_, detail::to_word(message));
+    }
+
+    /// usc_driver_get_data_locked() as a message, false when the queue is empty.
+    template <typename T>
+    bool receive(T &message) const noexcept
+    {
+        const word_t word = usc_driver_get_data_locked(handle_);
+        if (word == 0) {
+            return false;
+        }
+        message = detail::from_word<T>(word);
+        return true;
+    }
+
+private:
+    friend class DriverRef;
+    explicit DriverLock(uscDriverHandler handle) noexcept : handle_(handle) {}
+
+    uscDriverHandler handle_;
+};
+
+/**
+ * @brief Non-owning handle to an installed driver.
+ */
+class DriverRef {
+public:
+    constexpr DriverRef() noexcept = default;
+    constexpr explicit DriverRef(uscDriverHandler handle) noexcept : handle_(handle) {}
+
+    /// The driver a processor task was started for, from its task parameter.
+    static DriverRef from_task(void *task_parameter) noexcept
+    {
+        return DriverRef(static_cast<uscDriverHandler>(task_parameter));
+    }
+
+    /// The driver installed on a port, empty if none, see usc_driver_get_handle().
+    static DriverRef on_port(uart_port_t port) noexcept
+    {
+        return DriverRef(usc_driver_get_handle(port));
+    }
+
+    uscDriverHandler handle() const noexcept { return handle_; }
+    explicit operator bool() const noexcept { return handle_ != nullptr; }
+
+    /// usc_send_data() of a message.
+    template <typename T>
+    esp_err_t send(const T &message) const noexcept
+    {
+        return usc_send_data(handle_, detail::to_word(message));
+    }
+
+    /// usc_driver_get_data() as a message, false when the queue is empty.
+    template <typename T>
+    bool receive(T &message) const noexcept
+    {
+        const word_t word = usc_driver_get_data(handle_);
+        if (word == 0) {
+            return false;
+        }
+        message = detail::from_word<T>(word);
+        return true;
+    }
+
+    /// Take the driver lock, see usc_driver_lock(). The result is empty on a timeout.
+    [[nodiscard]] DriverLock lock(TickType_t timeout = portMAX_DELAY) const noexcept
+    {
+        return DriverLock(usc_driver_lock(handle_, timeout) == ESP_OK ? handle_ : nullptr);
+    }
+
+    esp_err_t register_handler(usc_code_range_t codes, usc_handler_t fn, void *ctx) const noexcept
+    {
+        return usc_register_handler(handle_, codes, fn, ctx);
+    }
+
+    esp_err_t register_default_handler(usc_handler_t fn, void *ctx) const noexcept
+    {
+        return usc_register_default_handler(handle_, fn, ctx);
+    }
+
+    esp_err_t enable_watchdog(uint32_t timeout_ms, bool supervise_processor) const noexcept
+    {
+        return usc_driver_enable_watchdog(handle_, timeout_ms, supervise_processor);
+    }
+
+    void feed_watchdog() const noexcept { usc_driver_feed_watchdog(handle_); }
+
+    esp_err_t get_stats(usc_driver_stats_t &stats) const noexcept { return usc_driver_get_stats(handle_, &stats); }
+    esp_err_t reset_stats() const noexcept { return usc_driver_reset_stats(handle_); }
+
+protected:
+    uscDriverHandler handle_ = nullptr;
+};
+
+/**
+ * @brief Owner of an installed driver, removed with usc_driver_deinit() on destruction.
+ *
+ * Do not destroy it from the driver's own processor task; usc_driver_deinit() refuses,
+ * and the driver would stay installed.
+ */
+class Driver : public DriverRef {
+public:
+    constexpr Driver() noexcept = default;
+
+    /// Take ownership of an installed driver.
+    constexpr explicit Driver(uscDriverHandler handle) noexcept : DriverRef(handle) {}
+
+    Driver(const Driver &) = delete;
+    Driver &operator=(const Driver &) = delete;
+
+    Driver(Driver &&other) noexcept : DriverRef(other.release()) {}
+
+    Driver &operator=(Driver &&other) noexcept
+    {
+        if (this != &other) {
+            reset();
+            handle_ = other.release();
+        }
+        return *this;
+    }
+
+    ~Driver() { reset(); }
+
+    /**
+     * @brief usc_driver_install(), then take ownership of the driver.
+     *
+     * @param driver Receives the driver on ESP_OK, untouched otherwise.
+     * @return The result of usc_driver_install().
+     */
+    static esp_err_t install(const char *name,
+                             const uart_config_t &uart_config,
+                             const uart_port_config_t &port_config,
+                             usc_process_t process,
+                             stack_size_t stack_size,
+                             Driver &driver) noexcept
+    {
+        const esp_err_t ret = usc_driver_install(name, uart_config, port_config, process, stack_size);
+        if (ret == ESP_OK) {
+            driver = Driver(usc_driver_get_handle(port_config.port));
+        }
+        return ret;
+    }
+
+    /// Remove the driver now, see usc_driver_deinit(). Empty afterwards, whatever the result.
+    esp_err_t reset() noexcept
+    {
+        return (handle_ != nullptr) ? usc_driver_deinit(release()) : ESP_OK;
+    }
+
+    /// Give up ownership without removing the driver.
+    uscDriverHandler release() noexcept { return std::exchange(handle_, nullptr); }
+};
+
+static_assert(sizeof(DriverRef) == sizeof(uscDriverHandler), "a driver object is only its handle");
+static_assert(sizeof(Driver) == sizeof(uscDriverHandler), "a driver object is only its handle");
+static_assert(sizeof(DriverLock) == sizeof(uscDriverHandler), "a lock guard is only its handle");
+
+} // namespace microusc
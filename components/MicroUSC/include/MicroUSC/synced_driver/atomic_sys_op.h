@@ -8,13 +8,13 @@
  * @file atomic_sys_op.h
  * @brief Atomic data queue operations for ESP32/ESP8266 embedded systems
  *
- * Provides thread-safe data storage queues using FreeRTOS spinlocks for atomic access.
- * Designed for interrupt-safe data sharing between tasks and ISRs in MicroUSC drivers.
+ * Provides the fixed-size data storage queues of MicroUSC drivers. The queue itself takes
+ * no lock: the driver's reader and processor tasks share it under the driver lock. The
+ * driver counters next to it are relaxed atomics and need no lock.
  *
  * Features:
- * - Atomic operations: Uses `portMUX_TYPE` spinlocks for critical sections
  * - Fixed-size queues: Preallocated buffers prevent heap fragmentation
- * - ISR-safe: Suitable for use in interrupt handlers when configured properly
+ * - A zero word marks an empty slot, so 0 cannot be stored
  *
  * Usage:
  * 1. Create queue with `createDataStorageQueue()`
@@ -31,6 +31,7 @@
 
 #include <stdint.h>
 #include <stddef.h>
+#include <stdbool.h>
 #include "string.h"
 #include <stdatomic.h>
 
@@ -59,21 +60,29 @@ SerialDataQueueHandler createDataStorageQueue(const size_t len);
 SerialDataQueueHandler createDataStorageQueueStatic(void *buffer, const size_t serial_data_size);
 
 /**
- * @brief Add data to queue (thread-safe)
+ * @brief Add data to queue
  * @param queue Initialized queue handle
  * @param data 32-bit value to store
+ * @return true if stored, false if the queue was full and the value was dropped
  *
- * @note Uses portENTER_CRITICAL for atomic access
- * @warning Blocks indefinitely if queue full - use in ISR with caution
+ * @note Not synchronized; MicroUSC calls it with the driver lock held
  */
-void dataStorageQueue_add(SerialDataQueueHandler queue, const uint32_t data);
+bool dataStorageQueue_add(SerialDataQueueHandler queue, const uint32_t data);
 
 /**
- * @brief Retrieve oldest data from queue (thread-safe)
+ * @brief Number of values currently stored
+ * @param queue Initialized queue handle
+ *
+ * @note Not synchronized, see dataStorageQueue_add()
+ */
+size_t dataStorageQueue_count(SerialDataQueueHandler queue);
+
+/**
+ * @brief Retrieve oldest data from queue
  * @param queue Initialized queue handle
  * @return uint32_t Retrieved value (0 if empty)
  *
- * @note Uses portENTER_CRITICAL for atomic access
+ * @note Not synchronized, see dataStorageQueue_add()
  */
 uint32_t dataStorageQueue_top(SerialDataQueueHandler queue);
 
@@ -43,6 +43,10 @@
 extern "C" {
 #endif
 
+#ifndef MICROUSC_UART_TX_BUFFER_SIZE
+#define MICROUSC_UART_TX_BUFFER_SIZE (256) // TX ring per port, must exceed the 128-byte hardware FIFO
+#endif
+
 /**
  * @struct uart_port_config_t
  * @brief Configuration structure for UART ports.
@@ -53,6 +57,16 @@ typedef struct {
   gpio_num_t rx;  ///< GPIO pin for UART receive.
 } uart_port_config_t;
 
+/**
+ * @brief Outcome of a frame read, used by the driver's performance counters.
+ */
+typedef enum {
+  UART_FRAME_OK = 0,     ///< Full frame with valid delimiters
+  UART_FRAME_INCOMPLETE, ///< Less than a frame buffered, nothing consumed
+  UART_FRAME_RESYNC,     ///< Bad delimiters, the stream was shifted by one byte
+  UART_FRAME_ERROR,      ///< The UART driver reported an error or the buffer is too small
+} uart_frame_status_t;
+
 /**
  * @brief Initialize a UART port with specified configurations and pins.
  * 
@@ -77,7 +91,14 @@ void uart_init( uart_port_config_t port_config,
               );
 
 
-
+/**
+ * @brief Realign a slipped stream after a rejected frame.
+ *
+ * Discards one buffered byte so the next read starts one byte later. Nothing is
+ * written to buf.
+ *
+ * @return Always NULL, a rejected frame is never handed on.
+ */
 uint8_t *uart_offset_repair( uart_port_t uart, 
                              uint8_t *buf,
                              const size_t len, 
@@ -123,6 +144,24 @@ uint8_t *uart_read( uart_port_t uart,
                     const TickType_t delay
                   );
 
+/**
+ * @brief Same as uart_read(), also reporting how the read went.
+ *
+ * Reads exactly USC_FRAME_SIZE bytes and returns buf only when they form a frame
+ * with both delimiters in place; anything else returns NULL.
+ *
+ * @param len    Capacity of buf, at least USC_FRAME_SIZE.
+ * @param status Receives the outcome, may be NULL. UART_FRAME_ERROR if len is too
+ *               small, UART_FRAME_RESYNC if the bytes were rejected and the stream
+ *               shifted with uart_offset_repair().
+ */
+uint8_t *uart_read_frame( uart_port_t uart,
+                          uint8_t *buf,
+                          const size_t len, 
+                          const TickType_t delay,
+                          uart_frame_status_t *status
+                        );
+
 /**
  * @brief Deinitialize a UART port configuration structure.
  *
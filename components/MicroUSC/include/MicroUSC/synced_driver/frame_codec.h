@@ -0,0 +1,55 @@
+/*
+ * SPDX-FileCopyrightText: 2025 Alejandro Ramirez
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/**
+ * @file frame_codec.h
+ * @brief Wire format of a MicroUSC frame, independent of the UART driver.
+ *
+ * A frame is one 32-bit word between two delimiter bytes:
+ *
+ *     [0xFF][word, 4 bytes, little endian][0xFF]
+ *
+ * Keeping the format here lets the UART layer, host tools and benchmarks share one
+ * implementation without pulling in the ESP-IDF UART driver.
+ *
+ * @author Alejandro Ramirez
+ * @date July 30, 2025
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define USC_FRAME_DELIMITER ( 0xFF )
+#define USC_FRAME_SIZE      ( sizeof( uint32_t ) + 2 )
+
+/**
+ * @brief Write a word as a complete frame.
+ *
+ * @param word  Value to send.
+ * @param frame Destination of at least USC_FRAME_SIZE bytes.
+ */
+void usc_frame_encode(uint32_t word, uint8_t *frame);
+
+/**
+ * @brief Check a received frame and extract its word.
+ *
+ * @param frame Received bytes.
+ * @param len   Number of bytes in frame.
+ * @param word  Receives the word when the frame is valid, may be NULL.
+ * @return true if len covers a whole frame and both delimiters are in place.
+ */
+bool usc_frame_decode(const uint8_t *frame, size_t len, uint32_t *word);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,206 @@
+/*
+ * SPDX-FileCopyrightText: 2025 Alejandro Ramirez
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/**
+ * @file message_schema.h
+ * @brief Declarative layout of application messages in the 32-bit word of a frame.
+ *
+ * A schema word carries a message ID in its high byte and up to 24 bits of fields
+ * below it:
+ *
+ *     [ID, 8 bits][fields, low bits first, 24 bits]
+ *
+ * IDs run from 1 to 255, so every schema word is at least 0x01000000. Word 0 (an empty
+ * queue) and the driver's handshake words (USC_PROTOCOL_*) are all below that and can
+ * never be mistaken for a message.
+ *
+ * A schema is written as two levels of X-macros, one list of messages and one list of
+ * fields per message, and USC_SCHEMA_DECLARE() generates from them:
+ *
+ *     #define SENSOR_READING_FIELDS(F) F(uint8_t, channel, 4) F(int16_t, value, 12)
+ *     #define SENSOR_SET_RATE_FIELDS(F) F(uint16_t, hz, 16)
+ *
+ *     #define SENSOR_MESSAGES(M, P) \
+ *         M(P, reading,  0x01, SENSOR_READING_FIELDS) \
+ *         M(P, set_rate, 0x02, SENSOR_SET_RATE_FIELDS)
+ *
+ *     USC_SCHEMA_DECLARE(sensor, SENSOR_MESSAGES)
+ *
+ * - sensor_id_t, with sensor_id_reading = 0x01 and sensor_id_set_rate = 0x02
+ * - sensor_reading_t { uint8_t channel; int16_t value; }, and so on
+ * - sensor_reading_pack(msg) and sensor_reading_unpack(word)
+ * - sensor_id(word)
+ * - sensor_handlers_t and sensor_dispatch(), a usc_handler_t to register for
+ *   sensor_codes() with usc_register_handler()
+ *
+ * Pack and unpack are inline and use constant shifts and masks only, no loops or
+ * branches. Dispatch is one switch on the ID. The build fails on a duplicate or
+ * out-of-range ID ("duplicate case value" in <prefix>_dispatch), on fields wider than
+ * 24 bits in total, and on a field wider than its type.
+ *
+ * Field types must be integers, bool or enums. Signed fields are sign extended when
+ * unpacked.
+ *
+ * @author Alejandro Ramirez
+ * @date August 8, 2025
+ */
+
+#pragma once
+
+#include "MicroUSC/uscUniversal.h"
+#include <assert.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+#include <type_traits>
+
+/* An enum converted from -1 is unspecified in C++, so ask its underlying type */
+template <typename T>
+constexpr bool usc_schema_signed_() noexcept
+{
+    if constexpr (std::is_enum_v<T>) {
+        return std::is_signed_v<std::underlying_type_t<T>>;
+    }
+    else {
+        return std::is_signed_v<T>;
+    }
+}
+#define USC_SCHEMA_SIGNED_(type) ( usc_schema_signed_<type>() )
+#else
+#define USC_SCHEMA_SIGNED_(type) ( (type)-1 < (type)1 )
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Words of the driver's own handshake, see USCdriver.c */
+#define USC_PROTOCOL_PING        ( 0x63 )  // ping to the other device
+#define USC_PROTOCOL_REQUEST_KEY ( 0x64 )  // request the other device's password
+#define USC_PROTOCOL_SEND_KEY    ( 1234 )  // password sent to the other device
+#define USC_PROTOCOL_SERIAL_KEY  ( 1234 )  // password expected from the other device
+
+#define USC_SCHEMA_ID_SHIFT     ( 24 )
+#define USC_SCHEMA_PAYLOAD_BITS ( 24 )
+#define USC_SCHEMA_ID_MAX       ( 0xFF )
+
+#define USC_SCHEMA_MASK(bits)        ( (uint32_t)((1UL << (bits)) - 1UL) )
+#define USC_SCHEMA_ID(word)          ( (uint8_t)((uint32_t)(word) >> USC_SCHEMA_ID_SHIFT) )
+#define USC_SCHEMA_WORD(id, payload) ( ((uint32_t)(id) << USC_SCHEMA_ID_SHIFT) | ((uint32_t)(payload) & USC_SCHEMA_MASK(USC_SCHEMA_PAYLOAD_BITS)) )
+#define USC_SCHEMA_FIRST_WORD        USC_SCHEMA_WORD(1, 0)
+
+static_assert(USC_PROTOCOL_PING < USC_SCHEMA_FIRST_WORD &&
+              USC_PROTOCOL_REQUEST_KEY < USC_SCHEMA_FIRST_WORD &&
+              USC_PROTOCOL_SEND_KEY < USC_SCHEMA_FIRST_WORD &&
+              USC_PROTOCOL_SERIAL_KEY < USC_SCHEMA_FIRST_WORD,
+              "handshake words must stay below the first schema word");
+
+/**
+ * @brief Generate the types and functions of a schema, see the top of this file.
+ *
+ * @param P        Prefix of every generated name.
+ * @param MESSAGES Message list, MESSAGES(M, P) expanding to M(P, name, id, FIELDS) per
+ *                 message, where FIELDS(F) expands to F(type, name, bits) per field.
+ */
+#define USC_SCHEMA_DECLARE(P, MESSAGES)                                                           \
+    typedef enum { MESSAGES(USC_SCHEMA_ENUM_, P) } P##_id_t;                                     \
+    MESSAGES(USC_SCHEMA_STRUCT_, P)                                                              \
+    MESSAGES(USC_SCHEMA_CHECK_, P)                                                               \
+    MESSAGES(USC_SCHEMA_PACK_, P)                                                                \
+    MESSAGES(USC_SCHEMA_UNPACK_, P)                                                              \
+                                                                                                 \
+    /** Handler per message, NULL to leave its words in the queue. ctx is passed to each. */     \
+    typedef struct {                                                                             \
+        MESSAGES(USC_SCHEMA_HANDLER_, P)                                                         \
+        void *ctx;                                                                               \
+    } P##_handlers_t;                                                                            \
+                                                                                                 \
+    static inline P##_id_t P##_id(uint32_t word)                                                 \
+    {                                                                                            \
+        return (P##_id_t)USC_SCHEMA_ID(word);                                                    \
+    }                                                                                            \
+                                                                                                 \
+    /** Every schema word, for usc_register_handler() with P##_dispatch. */                      \
+    static inline usc_code_range_t P##_codes(void)                                               \
+    {                                                                                            \
+        const usc_code_range_t codes = { USC_SCHEMA_FIRST_WORD, UINT32_MAX };                    \
+        return codes;                                                                            \
+    }                                                                                            \
+                                                                                                 \
+    /** usc_handler_t: unpack a word and call its handler. handlers is a P##_handlers_t. */     \
+    static inline bool P##_dispatch(struct usc_driver_t *driver, uint32_t word, void *handlers)  \
+    {                                                                                            \
+        const P##_handlers_t *const h = (const P##_handlers_t *)handlers;                        \
+        switch (USC_SCHEMA_ID(word)) {                                                           \
+            MESSAGES(USC_SCHEMA_DISPATCH_, P)                                                    \
+            default:                                                                             \
+                return false;                                                                    \
+        }                                                                                        \
+    }
+
+/* Expansions used by USC_SCHEMA_DECLARE(), one per message */
+
+#define USC_SCHEMA_ENUM_(P, name, id, FIELDS) P##_id_##name = (id),
+
+#define USC_SCHEMA_STRUCT_(P, name, id, FIELDS) \
+    typedef struct { FIELDS(USC_SCHEMA_MEMBER_) } P##_##name##_t;
+
+#define USC_SCHEMA_CHECK_(P, name, id, FIELDS)                                                    \
+    static_assert((id) >= 1 && (id) <= USC_SCHEMA_ID_MAX,                                        \
+                  #P "_" #name ": message IDs are 1 to 255");                                    \
+    static_assert((0 FIELDS(USC_SCHEMA_BITS_)) <= USC_SCHEMA_PAYLOAD_BITS,                       \
+                  #P "_" #name ": fields take more than 24 bits");                               \
+    FIELDS(USC_SCHEMA_CHECK_FIELD_)
+
+#define USC_SCHEMA_PACK_(P, name, id, FIELDS)                                                     \
+    static inline uint32_t P##_##name##_pack(const P##_##name##_t msg)                           \
+    {                                                                                            \
+        uint32_t word = (uint32_t)(id) << USC_SCHEMA_ID_SHIFT;                                   \
+        unsigned shift = 0;                                                                      \
+        FIELDS(USC_SCHEMA_PACK_FIELD_)                                                           \
+        (void)shift;                                                                             \
+        return word;                                                                             \
+    }
+
+#define USC_SCHEMA_UNPACK_(P, name, id, FIELDS)                                                   \
+    static inline P##_##name##_t P##_##name##_unpack(const uint32_t word)                        \
+    {                                                                                            \
+        P##_##name##_t msg;                                                                      \
+        unsigned shift = 0;                                                                      \
+        FIELDS(USC_SCHEMA_UNPACK_FIELD_)                                                         \
+        (void)shift;                                                                             \
+        return msg;                                                                              \
+    }
+
+#define USC_SCHEMA_HANDLER_(P, name, id, FIELDS) \
+    bool (*name)(struct usc_driver_t *driver, P##_##name##_t msg, void *ctx);
+
+#define USC_SCHEMA_DISPATCH_(P, name, id, FIELDS) \
+    case (id): return h->name != NULL && h->name(driver, P##_##name##_unpack(word), h->ctx);
+
+/* Expansions used by USC_SCHEMA_DECLARE(), one per field */
+
+#define USC_SCHEMA_MEMBER_(type, name, bits) type name;
+
+#define USC_SCHEMA_BITS_(type, name, bits) + (bits)
+
+#define USC_SCHEMA_CHECK_FIELD_(type, name, bits) \
+    static_assert((bits) >= 1 && (bits) <= 8 * sizeof(type), #name ": bit width does not fit its type");
+
+#define USC_SCHEMA_PACK_FIELD_(type, name, bits)                        \
+    word |= ((uint32_t)msg.name & USC_SCHEMA_MASK(bits)) << shift;     \
+    shift += (bits);
+
+#define USC_SCHEMA_UNPACK_FIELD_(type, name, bits)                                                      \
+    msg.name = USC_SCHEMA_SIGNED_(type)                                                                \
+        ? (type)((int32_t)(word << (32u - shift - (bits))) >> (32u - (bits)))  /* sign extended */     \
+        : (type)((word >> shift) & USC_SCHEMA_MASK(bits));                                             \
+    shift += (bits);
+
+#ifdef __cplusplus
+}
+#endif
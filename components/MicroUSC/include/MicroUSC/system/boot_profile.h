@@ -0,0 +1,57 @@
+/*
+ * SPDX-FileCopyrightText: 2025 Alejandro Ramirez
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/**
+ * @file boot_profile.h
+ * @brief Duration of each MicroUSC init stage.
+ *
+ * init_MicroUSC_system() and usc_driver_install() no longer sleep for a fixed time; they
+ * block on readiness signals from the system task and the driver tasks. The time every
+ * stage took is kept here, to see where a boot spends its time.
+ *
+ * @author Alejandro Ramirez
+ * @date August 4, 2025
+ */
+
+#pragma once
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Init stage durations in microseconds, 0 for a stage that has not run.
+ */
+typedef struct {
+    uint32_t memory_us;          ///< Memory pools
+    uint32_t setup_us;           ///< Crash log, RTC store, queues, GPIO events, system task creation
+    uint32_t system_task_us;     ///< Until the system task signalled it is running
+    uint32_t persist_us;         ///< Loading the flash store, see MicroUSC/system/persist.h
+    uint32_t warm_boot_us;       ///< Restoring drivers, see MicroUSC/system/warm_boot.h
+    uint32_t total_us;           ///< The whole init_MicroUSC_system()
+    uint8_t driver_count;        ///< Drivers currently installed
+    struct {
+        uint32_t uart_us;        ///< UART driver install
+        uint32_t tasks_us;       ///< Driver registration until its reader task ran
+        uint32_t total_us;       ///< The whole usc_driver_install()
+    } drivers[DRIVER_MAX];       ///< By driver index, zero for a free index
+} microusc_boot_profile_t;
+
+/**
+ * @brief Copy the init stage durations.
+ */
+void microusc_get_boot_profile(microusc_boot_profile_t *profile);
+
+/**
+ * @brief Log the init stage durations.
+ */
+void microusc_print_boot_profile(void);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,81 @@
+/*
+ * SPDX-FileCopyrightText: 2025 Alejandro Ramirez
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/**
+ * @file crash_log.h
+ * @brief Crash-persistent record of recent system activity, kept in RTC no-init memory.
+ *
+ * The MicroUSC system records every handled system event, driver status transition,
+ * error caller PC and watchdog hang in a small binary ring that survives software
+ * resets, panics and watchdog resets (but not power loss). Each record carries its own
+ * CRC, so a record torn by a crash mid-write is skipped instead of poisoning the rest.
+ *
+ * At boot the previous run's records are copied out before the ring is reused, so
+ * field resets can be diagnosed after the fact without a serial console attached.
+ *
+ * @author Alejandro Ramirez
+ * @date July 28, 2025
+ */
+
+#pragma once
+
+#include "esp_system.h"
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#ifndef MICROUSC_CRASH_LOG_SIZE
+#define MICROUSC_CRASH_LOG_SIZE (32) // records kept, must be power of 2
+#endif
+
+typedef enum {
+    MICROUSC_CRASH_BOOT = 1,      ///< code: esp_reset_reason_t of this boot
+    MICROUSC_CRASH_EVENT,         ///< code: microusc_status handled by the system task, value: merged repeats
+    MICROUSC_CRASH_ERROR,         ///< value: caller PC of the error
+    MICROUSC_CRASH_DRIVER_STATUS, ///< code: new connection usc_status_t, source: driver index
+    MICROUSC_CRASH_HANG,          ///< code: eTaskState, value: silent time in ms, source: watchdog id
+} microusc_crash_type_t;
+
+typedef struct {
+    uint32_t seq;          ///< Position in the log, orders records across boots
+    uint32_t timestamp_ms; ///< Time since boot
+    uint32_t value;        ///< Type specific, see microusc_crash_type_t
+    uint16_t boot;         ///< Boot number the record belongs to
+    uint8_t type;          ///< microusc_crash_type_t
+    uint8_t code;          ///< Type specific, see microusc_crash_type_t
+    uint8_t source;        ///< Type specific, see microusc_crash_type_t
+    uint8_t reserved[3];
+    uint32_t crc;          ///< CRC32 of the fields above
+} microusc_crash_record_t;
+
+/**
+ * @brief Copy records out of the crash log, oldest first.
+ *
+ * @param previous_boot true for the records of the run before the last reset,
+ *                      false for the records of the current run.
+ * @param records       Destination array.
+ * @param max           Capacity of records.
+ * @return Number of records written.
+ */
+size_t microusc_crash_log_read(bool previous_boot, microusc_crash_record_t *records, size_t max);
+
+/**
+ * @brief Reset reason of the current boot, which ended the previous run.
+ */
+esp_reset_reason_t microusc_crash_log_reset_reason(void);
+
+/**
+ * @brief Print the records of the previous run to the console.
+ */
+void microusc_crash_log_print(void);
+
+#ifdef __cplusplus
+}
+#endif
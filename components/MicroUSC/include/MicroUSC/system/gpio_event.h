@@ -0,0 +1,78 @@
+/*
+ * SPDX-FileCopyrightText: 2025 Alejandro Ramirez
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/**
+ * @file gpio_event.h
+ * @brief Multi-pin GPIO event multiplexer for the MicroUSC system task.
+ *
+ * Any number of pins can be mapped to a microusc_status code or to a user callback.
+ * The GPIO ISR only debounces the edge against an esp_timer timestamp, counts it and
+ * sets the pin's pending bit. The system task is woken once per batch of edges and
+ * delivers every pending pin, so a burst on several pins costs one wake-up.
+ *
+ * @author Alejandro Ramirez
+ * @date July 26, 2025
+ */
+
+#pragma once
+
+#include "MicroUSC/system/uscsystemdef.h"
+#include "driver/gpio.h"
+#include "esp_err.h"
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define MICROUSC_GPIO_DEBOUNCE_US_DEFAULT (50000) // 50 ms, suits mechanical buttons
+
+/**
+ * @brief Called on the system task for a pin with pending edges.
+ *
+ * @param pin   Pin the edges happened on.
+ * @param edges Edges accepted by the debounce filter since the last call.
+ * @param level Pin level when the callback runs.
+ * @param ctx   Value given at registration.
+ */
+typedef void (*microusc_gpio_callback_t)(gpio_num_t pin, uint32_t edges, int level, void *ctx);
+
+/**
+ * @brief What a pin does when it fires.
+ */
+typedef struct {
+    microusc_status status;            ///< Posted to the system task when callback is NULL
+    microusc_gpio_callback_t callback; ///< Optional, called on the system task instead of posting status
+    void *ctx;                         ///< Passed to callback
+    uint32_t debounce_us;              ///< Edges closer than this to the last accepted edge are ignored
+} microusc_gpio_event_t;
+
+/**
+ * @brief Configure pins and map their interrupts to a system event or callback.
+ *
+ * Every pin in io_config->pin_bit_mask gets the same mapping. A pin that is already
+ * registered is replaced.
+ *
+ * @param io_config GPIO configuration, intr_type must not be GPIO_INTR_DISABLE.
+ * @param event     Status or callback to deliver, and the debounce window.
+ * @return
+ *   - ESP_OK on success
+ *   - ESP_ERR_INVALID_ARG for an empty or invalid pin mask, or interrupts disabled
+ *   - ESP_ERR_INVALID_STATE if init_MicroUSC_system() has not run
+ *   - Errors from gpio_config() or gpio_isr_handler_add()
+ */
+esp_err_t microusc_gpio_event_register(const gpio_config_t *io_config, const microusc_gpio_event_t *event);
+
+/**
+ * @brief Remove a pin's interrupt handler and mapping. Edges not yet delivered are discarded.
+ *
+ * @return ESP_OK, or ESP_ERR_NOT_FOUND if the pin is not registered.
+ */
+esp_err_t microusc_gpio_event_unregister(gpio_num_t pin);
+
+#ifdef __cplusplus
+}
+#endif
@@ -53,6 +53,15 @@
 #include "MicroUSC/system/uscsystemdef.h"
 #include "MicroUSC/system/rtc.h"
 #include "MicroUSC/system/sleep.h"
+#include "MicroUSC/system/work_queue.h"
+#include "MicroUSC/system/gpio_event.h"
+#include "MicroUSC/system/watchdog.h"
+#include "MicroUSC/system/crash_log.h"
+#include "MicroUSC/system/trace.h"
+#include "MicroUSC/system/warm_boot.h"
+#include "MicroUSC/system/boot_profile.h"
+#include "MicroUSC/system/persist.h"
+#include "freertos/FreeRTOS.h"
 #include "driver/gpio.h"
 
 #ifdef __cplusplus
@@ -61,15 +70,23 @@ extern "C" {
 
 typedef void(*microusc_error_handler)(void *);
 
+/**
+ * @brief Per event type counters of the system event queue.
+ */
+typedef struct {
+    uint32_t coalesced; ///< Posts merged into an identical pending event
+    uint32_t dropped;   ///< Posts discarded because their lane was full (never errors)
+} microusc_event_stats_t;
+
 /**
  * @brief Configure a GPIO pin as an interrupt source for the MicroUSC system and register an ISR.
  *
- * This function determines the GPIO pin from the provided gpio_config_t's pin_bit_mask,
- * removes any existing ISR handler for that pin, configures the pin with the given settings,
- * and attaches the specified ISR handler. It also sets the status code that will be triggered
- * when the ISR is called.
+ * Every pin in the gpio_config_t's pin_bit_mask is configured and mapped to trigger_status
+ * through microusc_gpio_event_register(), with MICROUSC_GPIO_DEBOUNCE_US_DEFAULT debounce.
+ * Any existing mapping for those pins is replaced. Use microusc_gpio_event_register()
+ * directly for callbacks or a different debounce window.
  *
- * Typical usage: Call this during system initialization to set up a wakeup or event pin.
+ * Typical usage: Call this after init_MicroUSC_system() to set up a wakeup or event pin.
  *
  * @param io_config      GPIO configuration structure specifying the pin and settings.
  * @param trigger_status The MicroUSC status code to associate with this ISR event.
@@ -104,20 +121,27 @@ __attribute__((noreturn)) void microusc_system_restart(void);
  *   - Providing user feedback or diagnostics
  *
  * The handler function must match the signature defined by `microusc_error_handler`.
- * Passing a NULL pointer may disable error handling or restore default behavior,
- * depending on the system implementation.
+ * Passing a NULL pointer restores the default handler.
  *
  * @param handler  Pointer to the custom error handler function to be registered.
+ * @param var      Context copied for the handler each time an error is handled (may be NULL).
+ * @param size     Size of `var` in bytes, 0 if there is no context.
+ *
+ * @return
+ *   - ESP_OK on success
+ *   - ESP_ERR_INVALID_ARG if size is negative, or var is NULL with a non-zero size
+ *   - ESP_ERR_NO_MEM if the context buffer could not be allocated
  *
  * @note
- * - The error handler will be invoked in the context where the error occurs, which
- *   may be an interrupt, exception, or main application context.
- * - The handler should be efficient and avoid blocking operations, especially if
- *   called from an interrupt or fault context.
- * - Registering a new handler overrides any previously set handler.
+ * - The handler runs on the MicroUSC system task. It receives a copy of `var` taken
+ *   when the error is handled, so `var` must stay valid while the handler is registered.
+ * - The copy buffer is allocated here, so handling an error never allocates and works
+ *   even when the heap is exhausted. Contexts up to 32 bytes need no heap at all.
+ * - Registering a new handler overrides any previously set handler. A handler may be
+ *   registered before init_MicroUSC_system(), which then keeps it instead of the default.
  * - To restore the default error handler, use set_microusc_system_error_handler_default().
  */
-void set_microusc_system_error_handler(microusc_error_handler handler, void *var, int size);
+esp_err_t set_microusc_system_error_handler(microusc_error_handler handler, void *var, int size);
 
 /**
  * @brief Starts the MQTT service with the specified broker URL and buffers
@@ -151,12 +175,38 @@ void set_microusc_system_error_handler(microusc_error_handler handler, void *var
  *       maintain system integrity. The status code should be a valid value from the
  *       microusc_status enum or macro set.
  *
+ * @note Posting is a single lock-free ring push and is cheap enough for driver hot
+ *       paths. For errors the caller's return address is stored and resolved later
+ *       by the system task. Use send_microusc_system_status_from_isr() from an ISR.
+ *
  * @example
  *   send_microusc_system_status(USC_SYSTEM_SUCCESS);
  *   send_microusc_system_status(USC_SYSTEM_ERROR);
  */
 void send_microusc_system_status(microusc_status code);
 
+/**
+ * @brief ISR-safe version of send_microusc_system_status().
+ *
+ * @param code                       The status code to post.
+ * @param higher_priority_task_woken Set to pdTRUE if the system task was woken; pass it
+ *                                   to portYIELD_FROM_ISR() before the ISR returns.
+ */
+void send_microusc_system_status_from_isr(microusc_status code, BaseType_t *higher_priority_task_woken);
+
+/**
+ * @brief Read the coalesce and drop counters for one system event type.
+ *
+ * Events posted with send_microusc_system_status() go through a two-lane queue:
+ * errors and power events (OFF, SLEEP, PAUSE, RESUME) are always handled before
+ * LED and status requests. Identical pending requests are merged instead of
+ * occupying extra slots, and error reports are never dropped.
+ *
+ * @param code  Event type to query.
+ * @param stats Filled with the counters since system initialization.
+ */
+void microusc_system_event_stats(microusc_status code, microusc_event_stats_t *stats);
+
 /**
  * @brief Set the default system error handler for the microcontroller.
  *
@@ -0,0 +1,153 @@
+/*
+ * SPDX-FileCopyrightText: 2025 Alejandro Ramirez
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/**
+ * @file persist.h
+ * @brief Long-term driver data kept in flash, in the user_data NVS partition.
+ *
+ * Unlike the RTC store (MicroUSC/system/rtc.h), this survives power loss and firmware
+ * updates. For every driver, by name, it keeps the last configuration, the most
+ * processor stack it ever used and its counters summed over every run. For the system
+ * it keeps the boot count, the total uptime and a summary of the last crashes.
+ *
+ * Everything is loaded in one pass by init_MicroUSC_system(), before any driver is
+ * installed, so a driver starts with its learned stack size. Changes are only collected
+ * in RAM and written in one batch every MICROUSC_PERSIST_FLUSH_MS and before
+ * microusc_system_restart(), to keep flash wear low. Deep sleep writes only when the last
+ * batch is that old; otherwise the changes wait in RTC memory, and the wake-up counts
+ * itself with the next batch.
+ *
+ * @author Alejandro Ramirez
+ * @date August 6, 2025
+ */
+
+#pragma once
+
+#include "MicroUSC/system/crash_log.h"
+#include "MicroUSC/synced_driver/esp_uart.h"
+#include "esp_err.h"
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#ifndef MICROUSC_PERSIST_PARTITION
+#define MICROUSC_PERSIST_PARTITION "user_data"
+#endif
+
+#ifndef MICROUSC_PERSIST_FLUSH_MS
+#define MICROUSC_PERSIST_FLUSH_MS (10 * 60 * 1000) // batch interval of flash writes
+#endif
+
+#ifndef MICROUSC_PERSIST_DRIVERS
+#define MICROUSC_PERSIST_DRIVERS (8) // driver names remembered, the least recently installed is replaced
+#endif
+
+#ifndef MICROUSC_PERSIST_CRASHES
+#define MICROUSC_PERSIST_CRASHES (4) // crash summaries kept, the oldest is replaced
+#endif
+
+#define MICROUSC_PERSIST_CRASH_RECORDS (8)  // last crash log records kept per crash
+#define MICROUSC_PERSIST_NAME_SIZE     (20) // same as a driver name
+
+#ifndef MICROUSC_PERSIST_STACK_MARGIN
+#define MICROUSC_PERSIST_STACK_MARGIN (1024) // bytes added to the learned stack peak, 0 disables tuning
+#endif
+
+/**
+ * @brief Counters of one driver summed over every run, see usc_driver_stats_t.
+ */
+typedef struct {
+    uint64_t frames_rx;
+    uint64_t frames_tx;
+    uint64_t bytes_rx;
+    uint64_t bytes_tx;
+    uint32_t parse_errors;
+    uint32_t resyncs;
+    uint32_t queue_drops;
+    uint32_t handshake_attempts;
+} microusc_persist_counters_t;
+
+/**
+ * @brief Everything kept about one driver.
+ */
+typedef struct {
+    char name[MICROUSC_PERSIST_NAME_SIZE];
+    uart_config_t uart_config;          ///< At the last install
+    uart_port_config_t port_config;     ///< At the last install
+    uint32_t stack_size;                ///< Processor stack requested at the last install
+    uint32_t stack_peak;                ///< Most processor stack used by this firmware image, in bytes, 0 if not measured yet
+    uint32_t installs;                  ///< Number of installs, over every boot
+    uint32_t last_boot;                 ///< Boot number of the last install
+    microusc_persist_counters_t totals; ///< Counters up to the last flush
+} microusc_persist_driver_t;
+
+/**
+ * @brief System totals.
+ */
+typedef struct {
+    uint32_t boots;     ///< Number of boots, this one included
+    uint32_t crashes;   ///< Boots after a panic, a watchdog or a brownout
+    uint64_t uptime_s;  ///< Time run, up to the last flush
+    uint32_t flushes;   ///< Batches written to flash
+} microusc_persist_system_t;
+
+/**
+ * @brief Summary of one run that ended in a crash.
+ */
+typedef struct {
+    uint32_t boot;      ///< Boot number of the run that crashed
+    uint8_t reason;     ///< esp_reset_reason_t of the reset it caused
+    uint8_t count;      ///< Valid entries in records
+    uint8_t reserved[2];
+    microusc_crash_record_t records[MICROUSC_PERSIST_CRASH_RECORDS]; ///< Last crash log records of that run, oldest first
+} microusc_persist_crash_t;
+
+/**
+ * @brief Write the changes collected since the last flush now.
+ *
+ * @return ESP_OK, also when nothing changed, ESP_ERR_INVALID_STATE if the partition
+ *         could not be opened at boot, or the NVS error.
+ */
+esp_err_t microusc_persist_flush(void);
+
+/**
+ * @brief Copy what is kept about a driver.
+ *
+ * The totals include the counts of the current run up to the last flush.
+ *
+ * @return ESP_OK, ESP_ERR_INVALID_ARG, or ESP_ERR_NOT_FOUND for a name never installed.
+ */
+esp_err_t microusc_persist_get_driver(const char *name, microusc_persist_driver_t *driver);
+
+/**
+ * @brief Copy the system totals.
+ */
+void microusc_persist_get_system(microusc_persist_system_t *system);
+
+/**
+ * @brief Copy the crash summaries, oldest first.
+ *
+ * @return Number of summaries written.
+ */
+size_t microusc_persist_read_crashes(microusc_persist_crash_t *crashes, size_t max);
+
+/**
+ * @brief Forget everything, in RAM and in flash.
+ */
+esp_err_t microusc_persist_erase(void);
+
+/**
+ * @brief Log the system totals, every driver and the crash summaries.
+ */
+void microusc_persist_print(void);
+
+#ifdef __cplusplus
+}
+#endif
@@ -1,3 +1,23 @@
+/*
+ * SPDX-FileCopyrightText: 2025 Alejandro Ramirez
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/**
+ * @file rtc.h
+ * @brief Keyed variable store in RTC memory that survives resets and deep sleep.
+ *
+ * Each variable is identified by a one-character key and keeps the size it was first
+ * saved with. Lookups are direct-indexed by key, and saving an existing key overwrites
+ * its value in place. The store header and every value carry a CRC32, checked at boot:
+ * after a power-on the memory is random and the store starts empty, and a value torn by
+ * a reset in the middle of a save is dropped alone.
+ *
+ * @author Alejandro Ramirez
+ * @date August 1, 2025
+ */
+
 #pragma once
 
 #include  "esp_system.h"
@@ -6,49 +26,68 @@
 extern "C" {
 #endif
 
+#ifndef MICROUSC_RTC_STORE_SIZE
+#define MICROUSC_RTC_STORE_SIZE (512) // bytes of variable data
+#endif
+
+#ifndef MICROUSC_RTC_STORE_KEYS
+#define MICROUSC_RTC_STORE_KEYS (32)  // variables the store can hold
+#endif
+
+#define MICROUSC_RTC_KEY_RESERVED ((char)0xF0) // keys from here to 0xFF belong to MicroUSC itself
+
 /**
  * @brief Save a system variable to RTC memory.
  *
- * This function attempts to save a variable to RTC (Real-Time Clock) memory, identified by a key.
- * It performs argument validation and will return early without performing any operation if:
- *   - `var` is NULL,
- *   - `size` is 0,
- *   - `key` is 0 or the null character (`'\0'`).
+ * The first save of a key allocates `size` bytes, 4-byte aligned, for good. Later saves
+ * of the same key must pass the same size and overwrite the value in place.
  *
  * @param var   Pointer to the variable data to be saved. Must not be NULL.
  * @param size  Size in bytes of the variable to be saved. Must be greater than 0.
- * @param key   Unique identifier for the variable in RTC memory. Must not be 0 or '\0'.
+ * @param key   Unique identifier for the variable in RTC memory. Must not be '\0', and
+ *              keys from MICROUSC_RTC_KEY_RESERVED up are used by MicroUSC.
  *
- * @note
- * - If any argument is invalid, the function returns immediately and does not attempt to save the variable.
- * - It is the caller's responsibility to ensure that `var` points to valid memory of at least `size` bytes.
+ * @return
+ * - **ESP_OK**: Saved.
+ * - **ESP_ERR_INVALID_ARG**: `var` is NULL, `size` is 0 or `key` is '\0'.
+ * - **ESP_ERR_INVALID_SIZE**: The key exists with a different size.
+ * - **ESP_ERR_NO_MEM**: A new key does not fit in the data area or the key table.
  *
- * @return None.
+ * @note It is the caller's responsibility to ensure that `var` points to valid memory of at least `size` bytes.
  */
-void save_system_rtc_var(void *var, const size_t size, const char key);
+esp_err_t save_system_rtc_var(const void *var, const size_t size, const char key);
 
 /**
  * @brief Retrieve a system variable from RTC memory by key.
  *
- * This function searches for a variable previously saved to RTC (Real-Time Clock) memory
- * using the provided key. If the key matches an existing entry, a pointer to the variable's
- * data is returned. If the key does not match any stored entry, or if the key is invalid,
- * the function returns NULL.
- *
  * @param key  Unique identifier for the variable in RTC memory.
  *             Must match one of the keys used in save_system_rtc_var().
  *
  * @return
- *   - Pointer to the variable data if the key is found.
+ *   - Pointer to the variable data if the key is found, 4-byte aligned.
  *   - NULL if the key does not exist in the RTC variable store or is invalid.
  *
  * @note
- * - The returned pointer is to the internal RTC memory storage; do not free or modify it directly.
- * - The key must be a valid identifier previously used to save a variable; otherwise, NULL is returned.
- * - It is the caller's responsibility to ensure the key is valid and to handle a NULL return appropriately.
+ * - The returned pointer is to the internal RTC memory storage; do not free it.
+ * - Change the value only through save_system_rtc_var(), a value written through the
+ *   pointer no longer matches its CRC and is dropped at the next boot.
  */
 void *get_system_rtc_var(const char key);
 
+/**
+ * @brief Size a variable was saved with.
+ *
+ * @return Size in bytes, 0 if the key is not in the store.
+ */
+size_t get_system_rtc_var_size(const char key);
+
+/**
+ * @brief Remove every variable and reclaim the whole data area.
+ *
+ * Pointers returned by get_system_rtc_var() become invalid.
+ */
+void clear_system_rtc_vars(void);
+
 #ifdef __cplusplus
 }
-#endif
\ No newline at end of file
+#endif
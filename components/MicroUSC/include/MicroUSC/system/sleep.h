@@ -7,10 +7,47 @@ extern "C" {
 #include "esp_system.h"
 #include "freertos/FreeRTOS.h"
 #include "driver/gpio.h"
+#include "driver/uart.h"
 
 #define CONVERT_TO_SLEEPMODE_TIME(x) ( uint64_t ) ( pdMS_TO_TICKS(x) * portTICK_PERIOD_MS * 1000ULL )
 #define DEFAULT_LIGHTMODE_TIME CONVERT_TO_SLEEPMODE_TIME(5000) // 5 seconds
 
+#ifndef MICROUSC_SLEEP_RX_WORDS
+#define MICROUSC_SLEEP_RX_WORDS (16) // unread words kept per driver across deep sleep
+#endif
+
+#define MICROUSC_SLEEP_MIN_US       (10 * 1000ULL) // work due sooner than this runs before sleeping
+#define MICROUSC_SLEEP_QUIESCE_MS   (100)          // wait per driver for its lock and its TX to drain
+
+#define MICROUSC_LIGHT_SLEEP_UART_THRESHOLD (3)    // RX edges that wake a port, the hardware minimum
+#define MICROUSC_LIGHT_SLEEP_RX_WINDOW_MS   (1000) // a frame later than this after a wake-up did not cause it
+
+/**
+ * @brief Settings of the automatic light sleep
+ */
+typedef struct {
+    uint32_t idle_ms;      ///< Time every driver must be idle before sleeping
+    uint32_t check_ms;     ///< Period of the idle check on the system task
+    uint64_t max_sleep_us; ///< Longest single sleep, 0 to sleep until a UART or a work deadline wakes it
+} sleep_auto_light_config_t;
+
+#define SLEEP_AUTO_LIGHT_CONFIG_DEFAULT() { \
+    .idle_ms = 50, \
+    .check_ms = 20, \
+    .max_sleep_us = 0, \
+}
+
+/**
+ * @brief Counters of the automatic light sleep since it was enabled
+ */
+typedef struct {
+    uint32_t sleeps;      ///< Light sleeps entered
+    uint64_t slept_us;    ///< Total time spent in them
+    uint32_t uart_wakes;  ///< Sleeps ended by UART RX
+    uint32_t timer_wakes; ///< Sleeps ended by a work deadline or max_sleep_us
+    uint32_t busy;        ///< Idle checks that found a driver busy
+} sleep_auto_light_stats_t;
+
 /**
  * @brief Set timer duration for sleep mode wakeup in microseconds
  * @param time Duration in microseconds until wakeup
@@ -42,17 +79,101 @@ void sleep_mode_wakeup_pin_status(bool option);
 void sleep_mode_wakeup_default(void);
 
 /**
- * @brief Enter deep sleep mode if wakeup sources are configured
+ * @brief Keep unread received words across deep sleep
+ *
+ * Up to MICROUSC_SLEEP_RX_WORDS words waiting in each driver's queue are saved in RTC
+ * memory and put back in the queue of the driver installed on the same port after the
+ * wake-up. Enabled by default.
+ *
+ * @param option True to keep them, false to drop them
+ */
+void sleep_mode_persist_rx(bool option);
+
+/**
+ * @brief Wake up in time for the next scheduled work item
+ *
+ * The timer is set to the earlier of the sleep_mode_timer_wakeup() time, when the timer
+ * is enabled, and the next delayed or periodic work deadline (MicroUSC/system/work_queue.h).
+ * Disable the timer to wake only when there is work. Enabled by default.
+ *
+ * @param option True to wake for work, false to ignore work deadlines
+ */
+void sleep_mode_wake_for_work(bool option);
+
+/**
+ * @brief Timer wakeup sleep_mode() would set now
+ * @return Microseconds until the wakeup, 0 if the timer would not be used
+ */
+uint64_t sleep_mode_next_wakeup(void);
+
+/**
+ * @brief Put the drivers to rest and enter deep sleep mode if wakeup sources are configured
  * 
- * Enters deep sleep if either timer or GPIO wakeup is enabled.
+ * Enters deep sleep if the timer, work deadlines or GPIO wakeup give a way to wake up.
+ * Before that, every driver is quiesced by taking its lock, its UART TX is drained, and
+ * its unread words are saved if sleep_mode_persist_rx() is on. When work is due within
+ * MICROUSC_SLEEP_MIN_US, sleep is retried after it ran instead.
+ *
  * Wakes up on:
- * - Timer expiration (if enabled)
+ * - Timer expiration (if enabled) or the next work deadline
  * - GPIO pin trigger (if enabled)
  * 
- * @note Program restarts after wakeup
+ * @note Program restarts after wakeup. Enable warm boot (MicroUSC/system/warm_boot.h) to
+ *       get the drivers and their sessions back without installing them again.
  */
 void sleep_mode(void);
 
+/**
+ * @brief Enter light sleep by itself whenever every driver is idle
+ *
+ * A periodic check on the system task looks at every driver. A driver is idle when its
+ * queue is empty, its UART has no buffered RX and no TX in progress, and it has not
+ * received or sent a frame for idle_ms. When all are idle, light sleep is entered with
+ * UART wake-up on every driver port and a timer for the next work deadline. Execution
+ * continues after the wake-up; the drivers stay installed.
+ *
+ * The time from each wake-up to the next frame of every driver is counted in its
+ * usc_driver_stats_t (sleep_wakes, sleep_wake_us, sleep_wake_max_us).
+ *
+ * @param config Settings, NULL for SLEEP_AUTO_LIGHT_CONFIG_DEFAULT()
+ * @return ESP_OK, ESP_ERR_INVALID_ARG if check_ms is 0, or ESP_ERR_INVALID_STATE before
+ *         init_MicroUSC_system()
+ *
+ * @note The bytes that wake a port are lost, since the UART only counts their edges.
+ *       A peer should send a preamble before a frame that may arrive while asleep.
+ */
+esp_err_t sleep_mode_auto_light_enable(const sleep_auto_light_config_t *config);
+
+/**
+ * @brief Stop entering light sleep automatically
+ */
+void sleep_mode_auto_light_disable(void);
+
+/**
+ * @brief Set how many RX edges wake the system from light sleep on a port
+ *
+ * Every driver port uses MICROUSC_LIGHT_SLEEP_UART_THRESHOLD unless set here. While a
+ * driver's port cannot wake the chip (on the ESP32 only UART0 and UART1 can), light sleep
+ * is not entered, since its data would be lost. Set the threshold to 0 to sleep anyway;
+ * data arriving on that port while asleep is then lost.
+ *
+ * @param port UART port of a driver
+ * @param threshold RX edges, at least MICROUSC_LIGHT_SLEEP_UART_THRESHOLD, or 0
+ * @return ESP_OK or ESP_ERR_INVALID_ARG
+ */
+esp_err_t sleep_mode_uart_wakeup(uart_port_t port, int threshold);
+
+/**
+ * @brief Copy the automatic light sleep counters
+ */
+void sleep_mode_auto_light_stats(sleep_auto_light_stats_t *stats);
+
+/**
+ * @brief Log the automatic light sleep counters and the wake-to-first-frame latency of
+ *        every driver
+ */
+void sleep_mode_auto_light_print(void);
+
 #ifdef __cplusplus
 }
 #endif
\ No newline at end of file
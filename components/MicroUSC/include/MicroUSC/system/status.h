@@ -27,10 +27,179 @@
 
 #pragma once
 
+#include "MicroUSC/uscUniversal.h"
+#include "esp_err.h"
+#include <stddef.h>
+#include <stdint.h>
+
 #ifdef __cplusplus
 extern "C" {
 #endif
 
+#define USC_STATUS_NAME_SIZE       (20)
+#define USC_STATUS_CPU_UNAVAILABLE (UINT16_MAX) // built without CONFIG_FREERTOS_GENERATE_RUN_TIME_STATS
+
+/**
+ * @brief State and load of one driver, see usc_get_driver_status().
+ */
+typedef struct {
+    char name[USC_STATUS_NAME_SIZE];
+    const char *status;              ///< Connection state, a static string
+    int port;                        ///< UART port
+    int tx_pin;
+    int rx_pin;
+    uint32_t baud_rate;
+    uint16_t reader_cpu_permille;    ///< Share of one core used by the reader task since the previous snapshot
+    uint16_t processor_cpu_permille; ///< Same for the processor task
+    uint32_t wakes;                  ///< Wake-up latency samples, see usc_driver_stats_t
+    uint32_t wake_avg_us;            ///< Mean time from enqueue into an empty queue to the processor taking the word
+    uint32_t wake_max_us;            ///< Worst such time
+} usc_driver_status_t;
+
+/**
+ * @brief Take a snapshot of every installed driver.
+ *
+ * Each driver's lock is held only while its fields are copied. CPU shares cover the
+ * time since the previous call (since boot on the first one), so call this periodically
+ * from one place to get a steady load figure.
+ *
+ * @param status Destination array.
+ * @param max    Capacity of status.
+ * @return Number of drivers written.
+ */
+size_t usc_get_driver_status(usc_driver_status_t *status, size_t max);
+
+/* --- Binary snapshot --- */
+
+#define USC_STATUS_MAGIC   (0x5553) // "SU" in memory, little endian
+#define USC_STATUS_VERSION (1)
+
+/* Sections of a snapshot, usc_status_header_t.sections */
+#define USC_STATUS_DRIVERS (1 << 0)
+#define USC_STATUS_SYSTEM  (1 << 1)
+#define USC_STATUS_MEMORY  (1 << 2) // only set where heap statistics are available
+#define USC_STATUS_ALL     (USC_STATUS_DRIVERS | USC_STATUS_SYSTEM | USC_STATUS_MEMORY)
+
+/* usc_status_record_t.flags */
+#define USC_STATUS_LOCK_BUSY (1 << 0) // driver lock not free in time, status and CPU fields not sampled
+
+/**
+ * @brief Start of a snapshot. Multi-byte fields are little endian, as the ESP32 stores them.
+ */
+typedef struct __attribute__((packed)) {
+    uint16_t magic;          ///< USC_STATUS_MAGIC
+    uint8_t version;         ///< USC_STATUS_VERSION
+    uint8_t sections;        ///< USC_STATUS_* sections present
+    uint16_t size;           ///< Bytes in the snapshot, header included
+    uint8_t driver_count;    ///< Records following the header
+    uint8_t record_size;     ///< sizeof(usc_status_record_t) of the writer, newer fields are skipped
+    uint32_t uptime_ms;
+    uint8_t chip_model;      ///< esp_chip_model_t
+    uint8_t chip_cores;
+    uint16_t chip_revision;
+    uint32_t chip_features;  ///< CHIP_FEATURE_* bits
+    uint32_t dma_total;      ///< Heap bytes, see show_memory_usage()
+    uint32_t dma_free;
+    uint32_t internal_total;
+    uint32_t internal_free;
+} usc_status_header_t;
+
+/**
+ * @brief One driver in a snapshot.
+ */
+typedef struct __attribute__((packed)) {
+    char name[USC_STATUS_NAME_SIZE];
+    uint8_t status;                  ///< Connection state, usc_status_t
+    uint8_t flags;                   ///< USC_STATUS_LOCK_BUSY
+    uint8_t port;
+    int8_t tx_pin;
+    int8_t rx_pin;
+    uint32_t baud_rate;
+    uint16_t reader_cpu_permille;    ///< As in usc_driver_status_t
+    uint16_t processor_cpu_permille;
+    uint32_t wakes;
+    uint32_t wake_avg_us;
+    uint32_t wake_max_us;
+    uint32_t frames_rx;
+    uint32_t frames_tx;
+    uint32_t parse_errors;
+    uint32_t queue_drops;
+} usc_status_record_t;
+
+/* Largest snapshot, a buffer of this size always holds every driver */
+#define USC_STATUS_SNAPSHOT_MAX_SIZE (sizeof(usc_status_header_t) + DRIVER_MAX * sizeof(usc_status_record_t))
+
+/**
+ * @brief Copy the system state into a binary snapshot.
+ *
+ * Nothing is formatted here. Each driver's lock is held only while its fields are
+ * copied, and a driver whose lock stays busy for more than a few reader iterations is
+ * recorded with USC_STATUS_LOCK_BUSY instead of stalling the caller.
+ *
+ * @param sections USC_STATUS_* sections to capture.
+ * @param buffer   Destination, USC_STATUS_SNAPSHOT_MAX_SIZE bytes always suffice.
+ * @param size     Capacity of buffer; drivers that do not fit are left out.
+ * @return Bytes written, 0 if buffer is NULL or smaller than the header.
+ */
+size_t usc_status_capture(uint8_t sections, void *buffer, size_t size);
+
+/**
+ * @brief Format a snapshot to the console.
+ *
+ * Works on snapshots taken locally or received from a peer.
+ *
+ * @param snapshot Bytes written by usc_status_capture().
+ * @param len      Number of bytes in snapshot.
+ * @return ESP_OK, ESP_ERR_INVALID_ARG, ESP_ERR_INVALID_VERSION for an unknown magic or
+ *         version, or ESP_ERR_INVALID_SIZE if len does not cover the snapshot.
+ */
+esp_err_t usc_status_print(const void *snapshot, size_t len);
+
+/* --- Streaming over a driver link --- */
+
+/*
+ * A snapshot travels as ordinary words: a start word carrying its length, then data
+ * words of 3 bytes each. The tag in the top byte keeps every word non-zero, and the
+ * receiver claims the whole tag range with usc_register_handler(driver, USC_STATUS_STREAM_CODES, ...).
+ */
+#define USC_STATUS_STREAM_START (0xA5u) // low 24 bits: snapshot length
+#define USC_STATUS_STREAM_DATA  (0xA6u) // low 24 bits: next 3 bytes, first byte highest
+#define USC_STATUS_STREAM_CODES USC_CODE_RANGE(USC_STATUS_STREAM_START << 24, (USC_STATUS_STREAM_DATA << 24) | 0xFFFFFF)
+
+/**
+ * @brief Reassembly state of a snapshot arriving over a link.
+ */
+typedef struct {
+    uint8_t *buffer; ///< Set by the user, at least the sender's USC_STATUS_SNAPSHOT_MAX_SIZE bytes
+    size_t size;     ///< Capacity of buffer
+    size_t len;      ///< Bytes received so far
+    size_t expected; ///< Length from the start word, 0 while waiting for one
+} usc_status_stream_t;
+
+/**
+ * @brief Send a snapshot to the peer of a driver.
+ *
+ * @param driver   Installed driver.
+ * @param snapshot Bytes written by usc_status_capture().
+ * @param len      Number of bytes, below 2^24.
+ * @return ESP_OK, ESP_ERR_INVALID_ARG, or the first error of usc_send_data().
+ */
+esp_err_t usc_status_send(struct usc_driver_t *driver, const void *snapshot, size_t len);
+
+/**
+ * @brief Feed one received word into the reassembly state.
+ *
+ * A start word restarts reassembly, so a snapshot cut short by a lost word is dropped
+ * when the next one begins.
+ *
+ * @param stream Reassembly state.
+ * @param word   Word from the USC_STATUS_STREAM_CODES range.
+ * @return true when a whole snapshot is in stream->buffer, stream->len bytes long.
+ */
+bool usc_status_stream_feed(usc_status_stream_t *stream, uint32_t word);
+
+/* --- Console output --- */
+
 /**
  * @brief Print the current driver configurations to the console.
  *
@@ -39,7 +208,8 @@ extern "C" {
  * parameters are set as intended during development or troubleshooting.
  *
  * @note Use this function to review hardware interface settings, verify initialization, or log
- * configuration details during system startup or runtime.
+ * configuration details during system startup or runtime. The drivers are captured with
+ * usc_status_capture() first and printed afterwards, without holding any driver lock.
  */
 void usc_print_driver_configurations(void);
 
@@ -51,6 +221,9 @@ void usc_print_driver_configurations(void);
  * - Chip model (ESP32 or Other)
  * - Number of CPU cores
  * - Available features (WiFi/BT/BLE)
+ *
+ * @note Shorthand for usc_status_capture(USC_STATUS_SYSTEM) and usc_status_print(),
+ *       followed by the crash log of the previous reset.
  */
 void print_system_info(void);
 
@@ -70,7 +243,7 @@ void print_system_info(void);
  *          - Stack overflow damaging heap structures
  * 
  * @note Function uses local macro MEMORY_TAG for consistent logging output
- * @note All memory values are retrieved as const to prevent modification
+ * @note Shorthand for usc_status_capture(USC_STATUS_MEMORY) and usc_status_print()
  */
 void show_memory_usage(void);
 
@@ -0,0 +1,114 @@
+/*
+ * SPDX-FileCopyrightText: 2025 Alejandro Ramirez
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/**
+ * @file trace.h
+ * @brief Binary event trace for the MicroUSC data path.
+ *
+ * Formatting text to the console UART costs far more than moving a frame, so the
+ * data path records fixed-size binary records instead of logging. Each core owns a
+ * ring; a record is claimed with a single atomic add and written without locks, so
+ * tracing is safe from tasks and ISRs on either core and costs a few dozen cycles.
+ *
+ * Records are formatted later, off the hot path: on demand with microusc_trace_print(),
+ * or periodically by the low-priority system task after microusc_trace_start_drainer().
+ * When a ring wraps before it is drained the oldest records are overwritten and counted
+ * as lost.
+ *
+ * Define MICROUSC_TRACE_DISABLE to compile every MICROUSC_TRACE() call out.
+ *
+ * @author Alejandro Ramirez
+ * @date July 29, 2025
+ */
+
+#pragma once
+
+#include "esp_err.h"
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#ifndef MICROUSC_TRACE_SIZE
+#define MICROUSC_TRACE_SIZE (256) // records per core, must be power of 2
+#endif
+
+#define MICROUSC_TRACE_NO_DRIVER (0xFF)
+
+/**
+ * @brief Record identifiers. Values from MICROUSC_TRACE_USER up are free for applications.
+ */
+typedef enum {
+    MICROUSC_TRACE_FRAME_RX = 1,   ///< arg0: word received
+    MICROUSC_TRACE_FRAME_TX,       ///< arg0: word sent, arg1: esp_err_t of the write
+    MICROUSC_TRACE_RESYNC,         ///< arg0: payload bytes of the rejected frame
+    MICROUSC_TRACE_WORD_STORED,    ///< arg0: word, arg1: queue fill after storing
+    MICROUSC_TRACE_WORD_DROPPED,   ///< arg0: word lost because the queue was full
+    MICROUSC_TRACE_DISPATCH,       ///< arg0: word handed to a registered handler
+    MICROUSC_TRACE_HANDSHAKE,      ///< arg0: key read from the peer
+    MICROUSC_TRACE_SYSTEM_EVENT,   ///< arg0: microusc_status handled, arg1: merged repeats
+    MICROUSC_TRACE_ROUTE,          ///< arg0: word that matched a route, arg1: frames written to other drivers
+    MICROUSC_TRACE_USER = 0x80,
+} microusc_trace_event_t;
+
+typedef struct {
+    uint32_t timestamp_us; ///< Low 32 bits of esp_timer_get_time()
+    uint16_t seq;          ///< Low 15 bits of the position in its core's ring, top bit always set
+    uint8_t event;         ///< microusc_trace_event_t
+    uint8_t driver;        ///< Driver index, MICROUSC_TRACE_NO_DRIVER if none
+    uint32_t arg0;
+    uint32_t arg1;
+} microusc_trace_record_t;
+
+/**
+ * @brief Append a record to the calling core's ring. Safe from ISRs.
+ *
+ * Prefer the MICROUSC_TRACE() macro, which compiles out with MICROUSC_TRACE_DISABLE.
+ */
+void microusc_trace_write(uint8_t event, uint8_t driver, uint32_t arg0, uint32_t arg1);
+
+#ifndef MICROUSC_TRACE_DISABLE
+#define MICROUSC_TRACE(event, driver, arg0, arg1) \
+    microusc_trace_write((uint8_t)(event), (uint8_t)(driver), (uint32_t)(arg0), (uint32_t)(arg1))
+#else
+#define MICROUSC_TRACE(event, driver, arg0, arg1) do { } while (0)
+#endif
+
+/**
+ * @brief Move records not read yet out of the rings, oldest first within each core.
+ *
+ * Intended for a single reader, the drainer or a diagnostic command.
+ *
+ * @param records Destination array.
+ * @param cores   Optional array receiving the core of each record, may be NULL.
+ * @param max     Capacity of records (and cores).
+ * @return Number of records written.
+ */
+size_t microusc_trace_drain(microusc_trace_record_t *records, uint8_t *cores, size_t max);
+
+/**
+ * @brief Records overwritten before they could be drained, since boot.
+ */
+uint32_t microusc_trace_lost(void);
+
+/**
+ * @brief Drain the rings and format the records to the console, merged by time.
+ */
+void microusc_trace_print(void);
+
+/**
+ * @brief Print the trace periodically from the system task, at its low priority.
+ *
+ * @param period_ms Time between drains; pick it so a ring does not wrap in between.
+ * @return ESP_OK, or the error of scheduling the periodic work.
+ */
+esp_err_t microusc_trace_start_drainer(uint32_t period_ms);
+
+#ifdef __cplusplus
+}
+#endif
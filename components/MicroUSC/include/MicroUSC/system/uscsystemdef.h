@@ -46,6 +46,7 @@ typedef enum {
     USC_SYSTEM_DRIVER_STATUS,     ///< Query driver status
     USC_SYSTEM_ERROR,             ///< System error state
     USC_SYSTEM_PRINT_SUCCUSS,
+    USC_SYSTEM_STATUS_MAX,        ///< Number of status codes, not a valid status
 } microusc_status;
 
 #ifdef __cplusplus
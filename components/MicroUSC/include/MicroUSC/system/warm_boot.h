@@ -0,0 +1,69 @@
+/*
+ * SPDX-FileCopyrightText: 2025 Alejandro Ramirez
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/**
+ * @file warm_boot.h
+ * @brief Re-create the installed drivers after a software reset or deep-sleep wake.
+ *
+ * With warm boot enabled, every installed driver's configuration and the time its
+ * serial key exchange succeeded are kept in the RTC variable store (MicroUSC/system/rtc.h).
+ * On the next boot, init_MicroUSC_system() reinstalls the same drivers before returning,
+ * and a driver whose handshake is younger than the session lifetime starts with access
+ * already granted, so data flows without a new password exchange.
+ *
+ * Drivers are only restored after a software reset or a deep-sleep wake, and only by
+ * the same firmware image that saved them: the saved processor callbacks are addresses
+ * in that image. Any other reset, such as a panic or a watchdog, boots cold, and so does
+ * the software reset that follows a MicroUSC error or hang report (the default system
+ * error handler restarts the chip).
+ *
+ * The application may keep calling usc_driver_install() for its drivers after a warm
+ * boot; a call for a port restored with the same processor returns ESP_OK. If its name,
+ * UART settings or pins differ from the restored driver, that driver is removed and the
+ * port installed again with the new configuration and a fresh handshake.
+ *
+ * @author Alejandro Ramirez
+ * @date August 3, 2025
+ */
+
+#pragma once
+
+#include "esp_err.h"
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Persist the installed drivers and keep doing so for drivers installed later.
+ *
+ * The setting itself is persisted, so a warm-booted system stays enabled. Calling it
+ * again only changes the session lifetime.
+ *
+ * @param session_ttl_ms How long after a successful handshake a restored driver may
+ *                       skip the next one, 0 to always handshake again.
+ *
+ * @return
+ * - **ESP_OK**: Enabled, every installed driver saved.
+ * - **ESP_ERR_NO_MEM**: The RTC variable store is full, see MICROUSC_RTC_STORE_SIZE.
+ */
+esp_err_t usc_warm_boot_enable(uint32_t session_ttl_ms);
+
+/**
+ * @brief Stop persisting drivers; the next boot is cold.
+ */
+void usc_warm_boot_disable(void);
+
+/**
+ * @brief Drivers init_MicroUSC_system() restored on this boot.
+ */
+size_t usc_warm_boot_restored(void);
+
+#ifdef __cplusplus
+}
+#endif
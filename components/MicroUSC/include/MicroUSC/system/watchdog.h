@@ -0,0 +1,90 @@
+/*
+ * SPDX-FileCopyrightText: 2025 Alejandro Ramirez
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/**
+ * @file watchdog.h
+ * @brief Software heartbeat watchdog for MicroUSC tasks.
+ *
+ * Supervised tasks call microusc_watchdog_feed() once per loop iteration. The system
+ * task checks the heartbeat table periodically; a task that stays silent longer than
+ * its timeout is reported once: its state is captured, logged, and a USC_SYSTEM_ERROR
+ * is posted so the registered error handler runs. The error handler can read the
+ * captured state with microusc_watchdog_last_hang().
+ *
+ * Suspended tasks (for example drivers paused with USC_SYSTEM_PAUSE) are never reported.
+ * Unlike the ESP-IDF task watchdog, an expiry does not panic the chip.
+ *
+ * @author Alejandro Ramirez
+ * @date July 27, 2025
+ */
+
+#pragma once
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "esp_err.h"
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#ifndef MICROUSC_WATCHDOG_MAX
+#define MICROUSC_WATCHDOG_MAX      (2 * DRIVER_MAX + 2) // reader and processor per driver, plus user tasks
+#endif
+
+#define MICROUSC_WATCHDOG_CHECK_MS (250)                // how often the system task checks the table
+#define MICROUSC_WATCHDOG_NAME_LEN (20)
+
+/**
+ * @brief Identifies a supervised task, 0 means none and is safe to feed.
+ */
+typedef uint8_t microusc_watchdog_id_t;
+
+/**
+ * @brief State of a task captured when its heartbeat expired.
+ */
+typedef struct {
+    char name[MICROUSC_WATCHDOG_NAME_LEN]; ///< Name given at registration
+    TaskHandle_t task;
+    eTaskState state;                      ///< Usually eBlocked for a task stuck on a semaphore or UART read
+    UBaseType_t priority;
+    UBaseType_t stack_high_water;          ///< Minimum free stack seen, in words
+    uint32_t silent_ms;                    ///< Time since the last feed
+    uint32_t hang_count;                   ///< Hangs detected since boot, across all tasks
+} microusc_watchdog_hang_t;
+
+/**
+ * @brief Start supervising a task.
+ *
+ * @param task       Task to supervise, NULL for the calling task.
+ * @param name       Name used in reports (truncated to MICROUSC_WATCHDOG_NAME_LEN - 1).
+ * @param timeout_ms Longest allowed time between feeds, at least MICROUSC_WATCHDOG_CHECK_MS.
+ * @param id         Receives the id to feed.
+ * @return ESP_OK, ESP_ERR_INVALID_ARG, or ESP_ERR_NO_MEM if the table is full.
+ */
+esp_err_t microusc_watchdog_add(TaskHandle_t task, const char *name, uint32_t timeout_ms, microusc_watchdog_id_t *id);
+
+/**
+ * @brief Stop supervising a task. Removing id 0 is a no-op.
+ */
+esp_err_t microusc_watchdog_remove(microusc_watchdog_id_t id);
+
+/**
+ * @brief Record a heartbeat. Cheap enough for every loop iteration; id 0 is ignored.
+ */
+void microusc_watchdog_feed(microusc_watchdog_id_t id);
+
+/**
+ * @brief Copy the most recent hang report.
+ *
+ * @return ESP_OK, or ESP_ERR_NOT_FOUND if no hang has been detected since boot.
+ */
+esp_err_t microusc_watchdog_last_hang(microusc_watchdog_hang_t *hang);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,88 @@
+/*
+ * SPDX-FileCopyrightText: 2025 Alejandro Ramirez
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/**
+ * @file work_queue.h
+ * @brief Deferred and periodic work executed on the MicroUSC system task.
+ *
+ * Small jobs (memory reports, driver status, LED patterns, ...) can be scheduled on
+ * the system task instead of each owning a FreeRTOS task and stack. Work items come
+ * from a fixed pool and are ordered by deadline in a min-heap, so the system task
+ * sleeps exactly until the next item is due.
+ *
+ * Work functions run on the system task, one after another. They must not block for
+ * long, since system events (errors, pause, sleep, ...) wait until they return.
+ *
+ * @author Alejandro Ramirez
+ * @date July 24, 2025
+ */
+
+#pragma once
+
+#include "esp_err.h"
+#include "freertos/FreeRTOS.h"
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef void (*microusc_work_fn_t)(void *ctx);
+
+/**
+ * @brief Identifies a scheduled work item, 0 is never a valid id.
+ */
+typedef uint32_t microusc_work_id_t;
+
+/**
+ * @brief Run a function on the system task as soon as possible.
+ *
+ * Items posted with the same deadline run in the order they were posted.
+ *
+ * @param fn  Function to run.
+ * @param ctx Argument passed to fn.
+ * @return ESP_OK, ESP_ERR_INVALID_ARG if fn is NULL, ESP_ERR_NO_MEM if the pool is empty,
+ *         or ESP_ERR_INVALID_STATE if the MicroUSC system is not initialized.
+ */
+esp_err_t microusc_post_work(microusc_work_fn_t fn, void *ctx);
+
+/**
+ * @brief Run a function on the system task once, after a delay.
+ *
+ * @param fn    Function to run.
+ * @param ctx   Argument passed to fn.
+ * @param delay Delay in ticks, use pdMS_TO_TICKS() to convert from milliseconds.
+ * @param id    Optional, receives the id to pass to microusc_cancel_work().
+ * @return Same as microusc_post_work().
+ */
+esp_err_t microusc_post_delayed(microusc_work_fn_t fn, void *ctx, TickType_t delay, microusc_work_id_t *id);
+
+/**
+ * @brief Run a function on the system task every period until cancelled.
+ *
+ * The first run happens one period after posting. If a run is late, the next one is
+ * scheduled one period after it instead of catching up with back-to-back runs.
+ *
+ * @param fn     Function to run.
+ * @param ctx    Argument passed to fn.
+ * @param period Period in ticks, must not be 0.
+ * @param id     Optional, receives the id to pass to microusc_cancel_work().
+ * @return Same as microusc_post_work(), ESP_ERR_INVALID_ARG also for a period of 0.
+ */
+esp_err_t microusc_post_periodic(microusc_work_fn_t fn, void *ctx, TickType_t period, microusc_work_id_t *id);
+
+/**
+ * @brief Cancel delayed or periodic work.
+ *
+ * May be called from inside the work function itself to stop a periodic item.
+ *
+ * @return ESP_OK, or ESP_ERR_NOT_FOUND if the item already ran or was cancelled.
+ */
+esp_err_t microusc_cancel_work(microusc_work_id_t id);
+
+#ifdef __cplusplus
+}
+#endif
@@ -1,5 +1,41 @@
 #pragma once
 
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+struct usc_driver_t;
+
 typedef void (*usc_process_t)(void *);
 
-typedef size_t stack_size_t;
\ No newline at end of file
+typedef size_t stack_size_t;
+
+/**
+ * Handler invoked by the driver's reader task for a matching incoming word.
+ * Return true if the word was consumed, false to also place it in the driver's queue.
+ */
+typedef bool (*usc_handler_t)(struct usc_driver_t *driver, uint32_t data, void *ctx);
+
+/* Inclusive range of incoming words handled by a single usc_handler_t */
+typedef struct {
+    uint32_t first;
+    uint32_t last;
+} usc_code_range_t;
+
+#define USC_CODE(code)               ((usc_code_range_t){ .first = (code), .last = (code) })
+#define USC_CODE_RANGE(lo, hi)       ((usc_code_range_t){ .first = (lo), .last = (hi) })
+#define USC_CODE_ALL                 USC_CODE_RANGE(1, UINT32_MAX) // every word, 0 is never received
+
+#ifndef USC_ROUTE_MAX
+#define USC_ROUTE_MAX (4) // routes out of one driver
+#endif
+
+/* Route of one source driver, returned by usc_route_add() */
+typedef uint8_t usc_route_t;
+
+/* Options of a route, combined with | */
+typedef enum {
+    USC_ROUTE_FORWARD   = 0,        // forward, and also deliver locally to the handlers or the queue
+    USC_ROUTE_CONSUME   = (1 << 0), // forwarded words are not delivered locally
+    USC_ROUTE_ZERO_COPY = (1 << 1), // write the received frame from the source's receive buffer as is
+} usc_route_flags_t;
@@ -0,0 +1,96 @@
+/*
+ * SPDX-FileCopyrightText: 2025 Alejandro Ramirez
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/**
+ * @file dispatch.h
+ * @brief Per-driver command dispatch table for the MicroUSC reader task.
+ *
+ * Maps incoming 32-bit words to handlers registered with usc_register_handler().
+ * Lookup cost does not depend on how many handlers are registered:
+ *   - Codes below USC_DISPATCH_DIRECT_SIZE are direct-indexed.
+ *   - Larger single codes live in a small open-addressing hash table.
+ *   - Larger ranges are kept in a short, bounded list.
+ *
+ * The table is embedded in struct usc_driver_t and is protected by the driver's
+ * sync_signal. The reader performs the lookup while holding the semaphore and
+ * calls the handler after releasing it, so handlers may reply with usc_send_data().
+ *
+ * @author Alejandro Ramirez
+ * @date July 20, 2025
+ */
+
+#pragma once
+
+#include "MicroUSC/uscUniversal.h"
+#include "esp_err.h"
+#include <stdint.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define USC_DISPATCH_DIRECT_SIZE  (64) // codes [0, 64) are direct-indexed
+#define USC_DISPATCH_HASH_SIZE    (16) // must be power of 2
+#define USC_DISPATCH_HASH_BITS    (4)  // log2(USC_DISPATCH_HASH_SIZE)
+#define USC_DISPATCH_RANGE_MAX    (4)
+
+struct usc_dispatch_entry {
+    usc_handler_t fn;
+    void *ctx;
+};
+
+struct usc_dispatch_slot {
+    uint32_t code;
+    struct usc_dispatch_entry entry;
+    bool used; // slot has held a code, fn == NULL marks a removed entry
+};
+
+struct usc_dispatch_range {
+    uint32_t first;
+    uint32_t last;
+    struct usc_dispatch_entry entry;
+};
+
+struct usc_dispatch_table {
+    struct usc_dispatch_entry direct[USC_DISPATCH_DIRECT_SIZE];
+    struct usc_dispatch_slot hashed[USC_DISPATCH_HASH_SIZE];
+    struct usc_dispatch_range ranges[USC_DISPATCH_RANGE_MAX];
+    struct usc_dispatch_entry fallback; ///< Optional default sink, NULL means queue
+    uint8_t range_count;
+};
+
+/**
+ * @brief Result of a lookup, carried from the locked to the unlocked part of the reader loop.
+ */
+struct usc_dispatch_hit {
+    struct usc_dispatch_entry entry;
+    uint32_t data;
+};
+
+/**
+ * @brief Reset every slot of the table (no handlers, unmatched words go to the queue).
+ */
+void usc_dispatch_init(struct usc_dispatch_table *table);
+
+/**
+ * @brief Insert or replace the handler for a code range.
+ *
+ * @return ESP_OK, or ESP_ERR_NO_MEM if the hash table or range list is full.
+ */
+esp_err_t usc_dispatch_insert(struct usc_dispatch_table *table, usc_code_range_t codes, usc_handler_t fn, void *ctx);
+
+/**
+ * @brief Find the handler for a received word.
+ *
+ * @param hit Filled with the handler (or the fallback) and the word.
+ * @return true if a handler or fallback should be called, false if the word belongs in the queue.
+ */
+bool usc_dispatch_lookup(const struct usc_dispatch_table *table, uint32_t data, struct usc_dispatch_hit *hit);
+
+#ifdef __cplusplus
+}
+#endif
@@ -61,6 +61,7 @@ struct usc_driversHandler {
     size_t size;
     size_t max; // need to initial with size already, do not change size
     SemaphoreHandle_t lock;
+    bool paused; // between usc_drivers_pause() and usc_drivers_resume(), guarded by lock
 };
 
 struct usc_serialStorage {
@@ -81,6 +82,7 @@ void driver_isr_trigger(struct usc_driver_t *driver);
  *
  * @param driver   Pre-initialized usc_driver_t structure (UART, etc.)
  * @param priority FreeRTOS task priority (0 <= priority <= configMAX_PRIORITIES-1)
+ * @param has_access Start with the serial key exchange done, for drivers restored by warm boot
  *
  * @note Duplicate driver additions are not checked; ensure uniqueness to avoid conflicts.
  */
@@ -88,18 +90,21 @@ void addSingleDriver( const char *const driver_name,
                       const uart_config_t uart_config,
                       const uart_port_config_t port_config,
                       const usc_process_t driver_process,
-                      const stack_size_t stack_size
+                      const stack_size_t stack_size,
+                      const bool has_access
                     );
                     
 /**
  * @brief Remove a single driver from the MicroUSC system.
  *
  * Safely unlinks the driver from the active list (using list_del()) and frees
- * associated resources. Designed for use with ESP32 dynamic driver configurations.
+ * associated resources: its data queue, its processor stack, its index and the node.
+ * Designed for use with ESP32 dynamic driver configurations.
  *
  * @param item Pointer to the usc_driverList node containing the driver
  *
- * @warning Does not deinitialize hardware interfaces - call driver-specific deinit first.
+ * @warning Does not deinitialize hardware interfaces or tasks - call usc_driver_deinit() instead.
+ *          Must be called with driver_system.lock held.
  */
 void removeSingleDriver(struct usc_driverList *item);
 
@@ -154,10 +159,9 @@ esp_err_t init_hidden_driver_lists(const size_t buffer_size,  const size_t data_
 /**
  * @brief Pause all USC driver tasks
  * 
- * Suspends both processor and reader tasks for all drivers in the list.
- * Function runs from IRAM for faster execution during interrupts.
- * 
- * @warning Not thread-safe - should be called with proper synchronization
+ * Suspends both processor and reader tasks for all drivers in the list. Until
+ * usc_drivers_resume(), usc_driver_deinit() refuses to remove a driver.
+ * Takes driver_system.lock, so call it from a task that does not hold it.
  */
 void IRAM_ATTR usc_drivers_pause(void);
 
@@ -165,9 +169,7 @@ void IRAM_ATTR usc_drivers_pause(void);
  * @brief Resume all USC driver tasks
  * 
  * Resumes both processor and reader tasks for all drivers in the list.
- * Function runs from IRAM for faster execution during interrupts.
- * 
- * @warning Not thread-safe - should be called with proper synchronization
+ * Takes driver_system.lock, so call it from a task that does not hold it.
  */
 void IRAM_ATTR usc_drivers_resume(void);
 
@@ -0,0 +1,96 @@
+/*
+ * SPDX-FileCopyrightText: 2025 Alejandro Ramirez
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/**
+ * @file route.h
+ * @brief Per-driver table of the routes added with usc_route_add().
+ *
+ * A route forwards the received words in a code range to one or more other drivers.
+ * The table is embedded in struct usc_driver_t of the source driver and is protected
+ * by its sync_signal, like the dispatch table. The source's reader task matches and
+ * forwards a word while holding that semaphore, and usc_driver_deinit() removes a
+ * driver from every table under the same semaphore, so a destination stays installed
+ * for as long as the reader uses it.
+ *
+ * Route IDs are slot indexes and stay valid until the route is removed.
+ *
+ * @author Alejandro Ramirez
+ * @date August 9, 2025
+ */
+
+#pragma once
+
+#include "MicroUSC/uscUniversal.h"
+#include "esp_err.h"
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+struct usc_route_counters {
+    _Atomic uint32_t matched;
+    _Atomic uint32_t forwarded;
+    _Atomic uint32_t dropped;
+    _Atomic uint64_t bytes;
+};
+
+struct usc_route {
+    usc_code_range_t codes;
+    struct usc_driver_t *to[DRIVER_MAX];
+    uint8_t to_count;                 ///< 0 marks a free slot
+    uint8_t flags;                    ///< usc_route_flags_t
+    struct usc_route_counters stats;
+};
+
+struct usc_route_table {
+    struct usc_route routes[USC_ROUTE_MAX];
+    uint8_t active;                   ///< Routes in use, 0 keeps routing off the reader path
+};
+
+/**
+ * @brief Remove every route.
+ */
+void usc_route_init(struct usc_route_table *table);
+
+/**
+ * @brief Add a route in the first free slot, with zeroed counters.
+ *
+ * @param id Receives the route ID.
+ * @return ESP_OK, or ESP_ERR_NO_MEM when all USC_ROUTE_MAX slots are in use.
+ */
+esp_err_t usc_route_insert( struct usc_route_table *table,
+                            usc_code_range_t codes,
+                            struct usc_driver_t *const *to,
+                            uint8_t to_count,
+                            uint8_t flags,
+                            uint8_t *id
+                          );
+
+/**
+ * @brief Remove a route.
+ *
+ * @return ESP_OK, or ESP_ERR_NOT_FOUND if the slot is free.
+ */
+esp_err_t usc_route_erase(struct usc_route_table *table, uint8_t id);
+
+/**
+ * @brief Remove a driver from the destinations of every route, before it is uninstalled.
+ *
+ * A route left without destinations is removed.
+ */
+void usc_route_forget(struct usc_route_table *table, const struct usc_driver_t *to);
+
+/**
+ * @brief The route in a slot, or NULL if the slot is free or out of range.
+ */
+struct usc_route *usc_route_get(struct usc_route_table *table, uint8_t id);
+
+#ifdef __cplusplus
+}
+#endif
@@ -71,6 +71,13 @@ UBaseType_t getCurrentEmptyDriverIndex(void);
  */
 UBaseType_t getCurrentEmptyDriverIndexAndOccupy(void);
 
+/**
+ * @brief Marks a driver bit index as available again.
+ *
+ * @param index Index returned by getCurrentEmptyDriverIndexAndOccupy().
+ */
+void releaseDriverIndex(UBaseType_t index);
+
 #ifdef __cplusplus
 }
 #endif
\ No newline at end of file
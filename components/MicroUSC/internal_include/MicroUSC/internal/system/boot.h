@@ -0,0 +1,86 @@
+/*
+ * SPDX-FileCopyrightText: 2025 Alejandro Ramirez
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/**
+ * @file boot.h
+ * @brief Readiness signals between init and the tasks it starts, and the boot profile
+ *        in MicroUSC/system/boot_profile.h.
+ *
+ * Each signal is an event group bit, set once by the side that became ready, so a
+ * waiter blocks exactly until then instead of sleeping a guessed time.
+ *
+ * @author Alejandro Ramirez
+ * @date August 4, 2025
+ */
+
+#pragma once
+
+#include "MicroUSC/system/boot_profile.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/event_groups.h"
+#include "esp_err.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define MICROUSC_READY_SYSTEM_TASK  ( (EventBits_t)BIT(0) )                  // system task is running
+#define MICROUSC_READY_UART(i)      ( (EventBits_t)BIT(1 + (i)) )            // driver i is registered on an installed UART
+#define MICROUSC_READY_READER(i)    ( (EventBits_t)BIT(1 + DRIVER_MAX + (i)) ) // reader task of driver i is running
+#define MICROUSC_READY_STOPPED(i)   ( (EventBits_t)BIT(1 + 2 * DRIVER_MAX + (i)) ) // reader task of driver i left its loop
+
+#define MICROUSC_READY_SYSTEM_TIMEOUT  pdMS_TO_TICKS(500)  // the fixed wait this replaced
+#define MICROUSC_READY_DRIVER_TIMEOUT  pdMS_TO_TICKS(1000)
+
+typedef enum {
+    MICROUSC_BOOT_MEMORY,
+    MICROUSC_BOOT_SETUP,
+    MICROUSC_BOOT_SYSTEM_TASK,
+    MICROUSC_BOOT_PERSIST,
+    MICROUSC_BOOT_WARM_BOOT,
+    MICROUSC_BOOT_TOTAL,
+} microusc_boot_stage_t;
+
+/**
+ * @brief Create the readiness event group. Called first in init_MicroUSC_system().
+ */
+void microusc_ready_init(void);
+
+/**
+ * @brief Signal readiness. Does nothing before microusc_ready_init().
+ */
+void microusc_ready_set(EventBits_t bits);
+
+/**
+ * @brief Withdraw readiness, for a driver index that is freed.
+ */
+void microusc_ready_clear(EventBits_t bits);
+
+/**
+ * @brief Block until every bit in bits is set.
+ *
+ * @return ESP_OK, ESP_ERR_TIMEOUT, or ESP_ERR_INVALID_STATE before microusc_ready_init().
+ */
+esp_err_t microusc_ready_wait(EventBits_t bits, TickType_t timeout);
+
+/**
+ * @brief Record how long a system init stage took.
+ */
+void microusc_boot_profile_stage(microusc_boot_stage_t stage, uint32_t us);
+
+/**
+ * @brief Record how long installing driver index took.
+ */
+void microusc_boot_profile_driver(UBaseType_t index, uint32_t uart_us, uint32_t tasks_us, uint32_t total_us);
+
+/**
+ * @brief Drop the install times of driver index once it is removed.
+ */
+void microusc_boot_profile_driver_removed(UBaseType_t index);
+
+#ifdef __cplusplus
+}
+#endif
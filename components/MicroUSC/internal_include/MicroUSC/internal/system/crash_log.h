@@ -0,0 +1,37 @@
+/*
+ * SPDX-FileCopyrightText: 2025 Alejandro Ramirez
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/**
+ * @file crash_log.h
+ * @brief Recording side of the crash log in MicroUSC/system/crash_log.h.
+ *
+ * @author Alejandro Ramirez
+ * @date July 28, 2025
+ */
+
+#pragma once
+
+#include "MicroUSC/system/crash_log.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Validate the RTC ring, keep the previous run's records and start a new boot.
+ *
+ * Called once during system setup, before anything is recorded.
+ */
+void microusc_crash_log_init(void);
+
+/**
+ * @brief Append a record. Safe from any task, cheap enough for status transitions.
+ */
+void microusc_crash_log_record(microusc_crash_type_t type, uint8_t code, uint8_t source, uint32_t value);
+
+#ifdef __cplusplus
+}
+#endif
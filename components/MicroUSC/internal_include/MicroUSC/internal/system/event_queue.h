@@ -0,0 +1,126 @@
+/*
+ * SPDX-FileCopyrightText: 2025 Alejandro Ramirez
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/**
+ * @file event_queue.h
+ * @brief Prioritized, coalescing event queue feeding the MicroUSC system task.
+ *
+ * Posting is lock-free: an event is copied into a bounded multi-producer stage ring with
+ * one compare-and-swap, from any task or ISR on either core. The system task is only
+ * notified when it is actually waiting, so bursts of posts cost one notification.
+ *
+ * The system task moves staged events into one of two bounded lanes and always drains
+ * the high lane (errors and power events) before the low lane (LED and status requests).
+ * Lanes, coalescing and merge counters are owned by the system task and need no lock.
+ *
+ * Coalescing rules:
+ *   - Query events (memory usage, specifications, driver status) merge with any pending
+ *     copy of the same event.
+ *   - Errors merge with a pending error from the same caller PC.
+ *   - Other events merge only with an identical event at the tail of their lane, so
+ *     toggles such as PAUSE, RESUME, PAUSE keep their order.
+ *
+ * Errors are never lost: non-error events may only use part of the high lane, so when
+ * the lane is full a new error is merged into the newest pending error instead. An error
+ * that finds the stage ring full is kept as a count and re-created by the system task.
+ * Every merged or dropped event is counted per event type.
+ *
+ * @author Alejandro Ramirez
+ * @date July 22, 2025
+ */
+
+#pragma once
+
+#include "MicroUSC/internal/system/service_def.h"
+#include "MicroUSC/system/uscsystemdef.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "esp_system.h"
+#include <stdbool.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#ifndef MICROUSC_EVENT_LANE_SIZE
+#define MICROUSC_EVENT_LANE_SIZE     (8)
+#endif
+
+#ifndef MICROUSC_EVENT_STAGE_SIZE
+#define MICROUSC_EVENT_STAGE_SIZE    (16) // must be power of 2
+#endif
+
+#define MICROUSC_EVENT_ERROR_RESERVE (2) // high lane slots only errors may use
+
+/* Signals wake the consumer like an event, but carry no payload and are never dropped */
+#define MICROUSC_EVENT_SIGNAL_GPIO   (1UL << 0) // GPIO edges are waiting in the gpio_event table
+
+ESP_STATIC_ASSERT(MICROUSC_EVENT_LANE_SIZE > MICROUSC_EVENT_ERROR_RESERVE, "Event lane too small for the error reserve");
+ESP_STATIC_ASSERT((MICROUSC_EVENT_STAGE_SIZE & (MICROUSC_EVENT_STAGE_SIZE - 1)) == 0, "Stage ring size must be a power of 2");
+ESP_STATIC_ASSERT(USC_SYSTEM_STATUS_MAX <= 32, "Pending event bitmask holds 32 statuses");
+
+/**
+ * @brief Set up both lanes and the counters, with the system task as the consumer.
+ *
+ * @param consumer Task notified whenever an event is queued (may be set later with NULL first).
+ */
+void microusc_event_queue_init(TaskHandle_t consumer);
+
+/**
+ * @brief Set the task that is notified when events are queued.
+ */
+void microusc_event_queue_set_consumer(TaskHandle_t consumer);
+
+/**
+ * @brief Stage an event and wake the consumer if it is waiting. Safe from tasks and ISRs.
+ *
+ * @param higher_priority_task_woken NULL from task context; from an ISR, set to pdTRUE
+ *                                   if a context switch should be requested.
+ * @return true if the event was staged, false if the stage ring was full.
+ */
+bool microusc_event_queue_push(const MiscrouscBackTrack_t *event, BaseType_t *higher_priority_task_woken);
+
+/**
+ * @brief Raise signal bits and wake the consumer if it is waiting. Safe from tasks and ISRs.
+ *
+ * @param signals                    MICROUSC_EVENT_SIGNAL_* bits to raise.
+ * @param higher_priority_task_woken NULL from task context, see microusc_event_queue_push().
+ */
+void microusc_event_queue_signal(uint32_t signals, BaseType_t *higher_priority_task_woken);
+
+/**
+ * @brief Read and clear the raised signal bits. Must only be called from the consumer task.
+ */
+uint32_t microusc_event_queue_take_signals(void);
+
+/**
+ * @brief Block the consumer until an event is posted or the timeout expires.
+ *
+ * Must only be called from the consumer task.
+ */
+void microusc_event_queue_wait(TickType_t timeout);
+
+/**
+ * @brief Wake the consumer without posting an event, e.g. when its wait timeout changed.
+ */
+void microusc_event_queue_kick(void);
+
+/**
+ * @brief Remove the highest-priority pending event. Must only be called from the consumer task.
+ *
+ * @return true if an event was written to `event`, false if both lanes are empty.
+ */
+bool microusc_event_queue_pop(MiscrouscBackTrack_t *event);
+
+/**
+ * @brief Read the merge and drop counters of one event type.
+ */
+void microusc_event_queue_stats(microusc_status code, uint32_t *coalesced, uint32_t *dropped);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,35 @@
+/*
+ * SPDX-FileCopyrightText: 2025 Alejandro Ramirez
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/**
+ * @file gpio_event.h
+ * @brief System task side of the GPIO event multiplexer in MicroUSC/system/gpio_event.h.
+ *
+ * @author Alejandro Ramirez
+ * @date July 26, 2025
+ */
+
+#pragma once
+
+#include "MicroUSC/system/gpio_event.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Install the GPIO ISR service. Called once during system setup.
+ */
+esp_err_t microusc_gpio_event_init(void);
+
+/**
+ * @brief Deliver every pin with pending edges. Only called from the system task.
+ */
+void microusc_gpio_event_dispatch(void);
+
+#ifdef __cplusplus
+}
+#endif
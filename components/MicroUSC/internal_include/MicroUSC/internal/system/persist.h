@@ -0,0 +1,77 @@
+/*
+ * SPDX-FileCopyrightText: 2025 Alejandro Ramirez
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/**
+ * @file persist.h
+ * @brief Boot and driver side of the flash store in MicroUSC/system/persist.h.
+ *
+ * @author Alejandro Ramirez
+ * @date August 6, 2025
+ */
+
+#pragma once
+
+#include "MicroUSC/system/persist.h"
+#include "MicroUSC/internal/uscdef.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Load everything from the partition and start the periodic flush.
+ *
+ * Called once by init_MicroUSC_system(), after the crash log and the work queue, and
+ * before any driver is installed. Counts the boot and saves a summary of a crash. A
+ * deep-sleep wake-up is not written right away but with the next batch, and starts
+ * from what microusc_persist_sleep() carried over.
+ */
+void microusc_persist_init(void);
+
+/**
+ * @brief Prepare for deep sleep.
+ *
+ * Folds everything into RAM, writes it to flash only when the last write is at least
+ * MICROUSC_PERSIST_FLUSH_MS old, and keeps the rest in RTC memory for the wake-up.
+ * Called by sleep_mode() right before the chip sleeps.
+ */
+void microusc_persist_sleep(void);
+
+/**
+ * @brief Processor stack size to install a driver with.
+ *
+ * @return The learned peak plus MICROUSC_PERSIST_STACK_MARGIN when the driver ran before
+ *         on this firmware image, otherwise requested.
+ */
+stack_size_t microusc_persist_stack_size(const char *name, stack_size_t requested);
+
+/**
+ * @brief Remember a freshly installed driver's configuration.
+ *
+ * Called by usc_driver_install() with the driver lock held.
+ */
+void microusc_persist_driver_installed(const struct usc_driver_t *driver);
+
+/**
+ * @brief Zero the driver's lifetime counters and add what they held to its totals.
+ *
+ * Each counter is read and zeroed in one atomic exchange under the persist lock, so a
+ * concurrent flush cannot fold it twice and no increment is lost. Called by
+ * usc_driver_reset_stats().
+ */
+void microusc_persist_driver_reset(struct usc_driver_t *driver);
+
+/**
+ * @brief Add the driver's counters to its totals and stop following it.
+ *
+ * Called by usc_driver_deinit() with the driver lock held, before the processor task
+ * is deleted.
+ */
+void microusc_persist_driver_removed(const struct usc_driver_t *driver);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,33 @@
+/*
+ * SPDX-FileCopyrightText: 2025 Alejandro Ramirez
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/**
+ * @file rtc.h
+ * @brief Boot-time side of the RTC variable store in MicroUSC/system/rtc.h.
+ *
+ * @author Alejandro Ramirez
+ * @date August 1, 2025
+ */
+
+#pragma once
+
+#include "MicroUSC/system/rtc.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Validate the store left by the previous run and build the key index.
+ *
+ * Called once during system setup. The store also initializes itself on first use,
+ * so variables can be read before the system is set up.
+ */
+void microusc_rtc_store_init(void);
+
+#ifdef __cplusplus
+}
+#endif
@@ -10,4 +10,5 @@ typedef struct {
         char *data;
     } type;
     microusc_status status;
+    uint16_t repeat; // identical events merged into this one while it was pending
 } MiscrouscBackTrack_t;
\ No newline at end of file
@@ -0,0 +1,41 @@
+/*
+ * SPDX-FileCopyrightText: 2025 Alejandro Ramirez
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/**
+ * @file sleep.h
+ * @brief Boot and driver side of the sleep coordinator in MicroUSC/system/sleep.h.
+ *
+ * @author Alejandro Ramirez
+ * @date August 5, 2025
+ */
+
+#pragma once
+
+#include "MicroUSC/system/sleep.h"
+#include "MicroUSC/internal/uscdef.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Keep the words saved before deep sleep only if this boot is its wake-up.
+ *
+ * Called once during system setup, after the RTC store is validated.
+ */
+void microusc_sleep_init(void);
+
+/**
+ * @brief Queue the words saved before deep sleep for the driver's port, once.
+ *
+ * Called by usc_driver_install() with the driver lock held, before the reader runs,
+ * so the saved words come before anything received after the wake-up.
+ */
+void microusc_sleep_restore_rx(struct usc_driver_t *driver);
+
+#ifdef __cplusplus
+}
+#endif
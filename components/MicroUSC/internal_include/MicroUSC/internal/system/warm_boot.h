@@ -0,0 +1,79 @@
+/*
+ * SPDX-FileCopyrightText: 2025 Alejandro Ramirez
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/**
+ * @file warm_boot.h
+ * @brief Driver side of the warm boot in MicroUSC/system/warm_boot.h.
+ *
+ * @author Alejandro Ramirez
+ * @date August 3, 2025
+ */
+
+#pragma once
+
+#include "MicroUSC/system/warm_boot.h"
+#include "MicroUSC/internal/uscdef.h"
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Reinstall the drivers saved by the previous run, if it may be resumed.
+ *
+ * Called once by init_MicroUSC_system() after system setup.
+ *
+ * @return Number of drivers restored.
+ */
+size_t microusc_warm_boot_resume(void);
+
+/**
+ * @brief Save a freshly installed driver, when warm boot is enabled.
+ *
+ * Called with the driver lock held.
+ */
+void microusc_warm_boot_record(const struct usc_driver_t *driver);
+
+/**
+ * @brief Note that the driver's handshake just succeeded.
+ *
+ * Called by the reader task with the driver lock held.
+ */
+void microusc_warm_boot_session(const struct usc_driver_t *driver);
+
+/**
+ * @brief Stop saving a driver that is being removed, so the next boot does not restore it.
+ *
+ * Called by usc_driver_deinit().
+ */
+void microusc_warm_boot_forget(const struct usc_driver_t *driver);
+
+/**
+ * @brief Whether a driver on this port was restored with this processor.
+ *
+ * Lets usc_driver_install() accept the application installing it again.
+ */
+bool microusc_warm_boot_restored_port(uart_port_t port, usc_process_t process);
+
+/**
+ * @brief usc_driver_install() for a restored driver.
+ *
+ * Implemented in USCdriver.c.
+ *
+ * @param has_access Start with the handshake done, status CONNECTED.
+ */
+esp_err_t usc_driver_install_restored( const char *const driver_name,
+                                       const uart_config_t uart_config,
+                                       const uart_port_config_t port_config,
+                                       const usc_process_t driver_process,
+                                       const stack_size_t stack_size,
+                                       const bool has_access
+                                     );
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,51 @@
+/*
+ * SPDX-FileCopyrightText: 2025 Alejandro Ramirez
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/**
+ * @file work_queue.h
+ * @brief System task side of the work queue in MicroUSC/system/work_queue.h.
+ *
+ * @author Alejandro Ramirez
+ * @date July 24, 2025
+ */
+
+#pragma once
+
+#include "MicroUSC/system/work_queue.h"
+#include "freertos/FreeRTOS.h"
+#include "esp_err.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#ifndef MICROUSC_WORK_MAX
+#define MICROUSC_WORK_MAX (16) // work items that can be pending at once
+#endif
+
+/**
+ * @brief Allocate the work item pool. Called once during system setup.
+ */
+esp_err_t microusc_work_init(void);
+
+/**
+ * @brief Ticks until the next work item is due.
+ *
+ * @return 0 if an item is already due, portMAX_DELAY if nothing is scheduled.
+ */
+TickType_t microusc_work_next_timeout(void);
+
+/**
+ * @brief Run the items that are due. Only called from the system task.
+ *
+ * Runs at most MICROUSC_WORK_MAX items per call so pending system events are not
+ * starved by work that keeps re-posting itself.
+ */
+void microusc_work_run_due(void);
+
+#ifdef __cplusplus
+}
+#endif
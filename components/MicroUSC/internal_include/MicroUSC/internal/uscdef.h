@@ -37,8 +37,13 @@ extern "C" {
 #include "MicroUSC/internal/USC_driver_config.h"
 #include "MicroUSC/synced_driver/esp_uart.h"
 #include "MicroUSC/synced_driver/atomic_sys_op.h"
+#include "MicroUSC/internal/dispatch.h"
+#include "MicroUSC/internal/route.h"
+#include "MicroUSC/system/watchdog.h"
+#include "MicroUSC/uscUniversal.h"
 #include "esp_system.h"
 #include "esp_intr_alloc.h"
+#include <stdatomic.h>
 /* Forward declarations */
 
 /* Forward declarations */
@@ -86,6 +91,33 @@ typedef enum {
     TIME_OUT,              ///< General operation timeout
 } usc_status_t;
 
+/**
+ * @brief Per-driver performance counters, see usc_driver_get_stats()
+ *
+ * Updated on the hot path with relaxed atomics; readers get a consistent value per
+ * field, not a snapshot across fields.
+ */
+struct usc_driver_counters {
+    _Atomic uint32_t frames_rx;
+    _Atomic uint32_t frames_tx;
+    _Atomic uint64_t bytes_rx;
+    _Atomic uint64_t bytes_tx;
+    _Atomic uint32_t parse_errors;
+    _Atomic uint32_t resyncs;
+    _Atomic uint32_t queue_high_water;
+    _Atomic uint32_t queue_drops;
+    _Atomic uint32_t handshake_attempts;
+    _Atomic uint32_t lock_waits;
+    _Atomic uint64_t lock_wait_us;
+    _Atomic uint32_t lock_wait_max_us;
+    _Atomic uint32_t wakes;
+    _Atomic uint64_t wake_us;
+    _Atomic uint32_t wake_max_us;
+    _Atomic uint32_t sleep_wakes;
+    _Atomic uint64_t sleep_wake_us;
+    _Atomic uint32_t sleep_wake_max_us;
+};
+
 /**
  * @brief Complete driver instance definition
  * 
@@ -103,6 +135,7 @@ struct usc_driver_t {
         StaticTask_t task_buffer;
         StackType_t *stack;
         size_t stack_size;
+        usc_process_t process;               ///< Task function, kept for warm boot
         // always run
     } uart_processor;
     uart_config_t uart_config;
@@ -114,7 +147,24 @@ struct usc_driver_t {
     } buffer;
     SemaphoreHandle_t sync_signal;           ///< Thread synchronization
     SerialDataQueueHandler data;
+    struct usc_dispatch_table dispatch;      ///< Incoming word -> handler lookup
+    struct usc_route_table routes;           ///< Incoming word -> other drivers
+    struct {
+        microusc_watchdog_id_t reader;       ///< 0 when not supervised
+        microusc_watchdog_id_t processor;
+    } watchdog;
+    struct usc_driver_counters stats;        ///< Performance counters
+    uint32_t wake_pending_us;                ///< Enqueue time of the word that filled the empty queue, 0 if none
+    _Atomic uint32_t sleep_wake_pending_us;  ///< Light sleep wake-up time until the next frame, 0 if none
+#if CONFIG_FREERTOS_GENERATE_RUN_TIME_STATS
+    struct {
+        configRUN_TIME_COUNTER_TYPE reader;
+        configRUN_TIME_COUNTER_TYPE processor;
+        configRUN_TIME_COUNTER_TYPE total;
+    } cpu_sample;                            ///< Run time counters at the previous status snapshot
+#endif
     usc_status_t status;                     ///< Current state machine position
+    usc_status_t logged_status;              ///< Last status written to the crash log
     UBaseType_t priority;                    ///< Execution precedence
     bool has_access;                         ///< Security clearance flag
 };
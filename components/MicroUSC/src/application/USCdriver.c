@@ -2,22 +2,31 @@
 #include "MicroUSC/system/memory_pool.h"
 #include "MicroUSC/USCdriver.h"
 #include "MicroUSC/synced_driver/esp_uart.h"
+#include "MicroUSC/synced_driver/frame_codec.h"
 #include "MicroUSC/internal/system/bit_manip.h"
 #include "MicroUSC/internal/USC_driver_config.h"
 #include "MicroUSC/internal/driverList.h"
 #include "MicroUSC/internal/uscdef.h"
+#include "MicroUSC/internal/system/crash_log.h"
+#include "MicroUSC/internal/system/warm_boot.h"
+#include "MicroUSC/internal/system/boot.h"
+#include "MicroUSC/internal/system/sleep.h"
+#include "MicroUSC/internal/system/persist.h"
+#include "MicroUSC/system/trace.h"
 #include "debugging/speed_test.h"
 #include "string.h"
 #include "esp_system.h"
 #include "esp_log.h"
+#include "esp_timer.h"
+#include <stdatomic.h>
 
 #define TAG                "[USC DRIVER]"
 #define TASK_TAG           "[DRIVER READER]"
 
-#define REQUEST_KEY_VAL ( uint32_t ) ( 0x64 ) // send data to request for password (idle)
-#define PING_VAL        ( uint32_t ) ( 0x63 ) // ping to the other device, (NOT USED)
-#define SEND_KEY_VAL    ( uint32_t ) ( 1234 ) // send the other device's password
-#define SERIAL_KEY_VAL  ( uint32_t ) ( 1234 ) // the internal password for this device
+#define REQUEST_KEY_VAL ( uint32_t ) ( USC_PROTOCOL_REQUEST_KEY ) // send data to request for password (idle)
+#define PING_VAL        ( uint32_t ) ( USC_PROTOCOL_PING ) // ping to the other device, (NOT USED)
+#define SEND_KEY_VAL    ( uint32_t ) ( USC_PROTOCOL_SEND_KEY ) // send the other device's password
+#define SERIAL_KEY_VAL  ( uint32_t ) ( USC_PROTOCOL_SERIAL_KEY ) // the internal password for this device
 
 #define BYTE_TYPE  uint32_t
 union uint32_4_uint8_t {
@@ -40,6 +49,101 @@ SERIAL_KEY = {.value = SERIAL_KEY_VAL};
 
 #define buf_SIZE ( sizeof( uint32_t ) + 1 )
 
+#define STAT_ADD(driver, field, n) atomic_fetch_add_explicit(&(driver)->stats.field, (n), memory_order_relaxed)
+#define ROUTE_STAT_ADD(route, field, n) atomic_fetch_add_explicit(&(route)->stats.field, (n), memory_order_relaxed)
+
+/**
+ * @brief Raise a high-water counter to value if it is below it.
+ */
+static __always_inline void stat_max(_Atomic uint32_t *counter, const uint32_t value)
+{
+    uint32_t current = atomic_load_explicit(counter, memory_order_relaxed);
+    while (current < value &&
+           !atomic_compare_exchange_weak_explicit(counter, &current, value, memory_order_relaxed, memory_order_relaxed)) {
+    }
+}
+
+/**
+ * @brief Take the driver lock, accounting the time spent waiting for it.
+ */
+static __always_inline BaseType_t driver_lock_take(struct usc_driver_t *driver, const TickType_t timeout)
+{
+    const int64_t start = esp_timer_get_time();
+    const BaseType_t taken = xSemaphoreTake(driver->sync_signal, timeout);
+    const uint32_t waited = (uint32_t)(esp_timer_get_time() - start);
+
+    STAT_ADD(driver, lock_waits, 1);
+    STAT_ADD(driver, lock_wait_us, waited);
+    stat_max(&driver->stats.lock_wait_max_us, waited);
+    return taken;
+}
+
+/**
+ * @brief Account the time from a light sleep wake-up to the first frame after it.
+ *
+ * Frames arriving later than MICROUSC_LIGHT_SLEEP_RX_WINDOW_MS after the wake-up were
+ * not what woke the system and are not counted.
+ */
+static void count_sleep_wake(struct usc_driver_t *driver)
+{
+    const uint32_t woke = atomic_exchange_explicit(&driver->sleep_wake_pending_us, 0, memory_order_relaxed);
+    const uint32_t latency = (uint32_t)esp_timer_get_time() - woke;
+    if (woke != 0 && latency <= MICROUSC_LIGHT_SLEEP_RX_WINDOW_MS * 1000U) {
+        STAT_ADD(driver, sleep_wakes, 1);
+        STAT_ADD(driver, sleep_wake_us, latency);
+        stat_max(&driver->stats.sleep_wake_max_us, latency);
+    }
+}
+
+/**
+ * @brief Account a frame read by the reader task.
+ */
+static __always_inline void count_frame(struct usc_driver_t *driver, const uart_frame_status_t status)
+{
+    switch (status) {
+        case UART_FRAME_OK:
+            STAT_ADD(driver, frames_rx, 1);
+            STAT_ADD(driver, bytes_rx, driver->buffer.size);
+            if (atomic_load_explicit(&driver->sleep_wake_pending_us, memory_order_relaxed) != 0) {
+                count_sleep_wake(driver);
+            }
+            break;
+        case UART_FRAME_RESYNC: {
+            uint32_t rejected;
+            memcpy(&rejected, driver->buffer.memory + 1, sizeof(rejected));
+            MICROUSC_TRACE(MICROUSC_TRACE_RESYNC, driver->priority, rejected, 0);
+        }
+            STAT_ADD(driver, parse_errors, 1);
+            STAT_ADD(driver, resyncs, 1);
+            STAT_ADD(driver, bytes_rx, driver->buffer.size + 1); /* frame plus the skipped byte */
+            break;
+        default:
+            break; /* nothing consumed */
+    }
+}
+
+/**
+ * @brief Store a word in the driver's queue, counting drops and the fill level.
+ *
+ * A word landing in an empty queue starts a wake-up measurement, see take_word().
+ * Must be called with the driver lock held.
+ */
+static __always_inline void queue_word(struct usc_driver_t *driver, const uint32_t data)
+{
+    if (dataStorageQueue_add(driver->data, data)) {
+        const uint32_t fill = (uint32_t)dataStorageQueue_count(driver->data);
+        MICROUSC_TRACE(MICROUSC_TRACE_WORD_STORED, driver->priority, data, fill);
+        stat_max(&driver->stats.queue_high_water, fill);
+        if (fill == 1) {
+            driver->wake_pending_us = (uint32_t)esp_timer_get_time() | 1; /* 0 means no measurement */
+        }
+    }
+    else {
+        MICROUSC_TRACE(MICROUSC_TRACE_WORD_DROPPED, driver->priority, data, 0);
+        STAT_ADD(driver, queue_drops, 1);
+    }
+}
+
 /**
  * @brief Validates UART configuration and initializes UART hardware.
  *
@@ -48,9 +152,11 @@ SERIAL_KEY = {.value = SERIAL_KEY_VAL};
  *
  * @param uart_config Pointer to UART configuration structure.
  * @param port_config Pointer to UART port configuration structure.
+ * @return ESP_OK once the UART is installed, ESP_ERR_NO_MEM when no driver slot is
+ *         left, or ESP_ERR_INVALID_ARG for a bad port.
  */
-static void check_valid_uart_config( const uart_config_t *uart_config,    
-                                     const uart_port_config_t *port_config
+static esp_err_t check_valid_uart_config( const uart_config_t *uart_config,    
+                                          const uart_port_config_t *port_config
 ) {
     xSemaphoreTake(driver_system.lock, portMAX_DELAY);
     bool v = ( ( driver_system.size + 1 ) >= DRIVER_MAX );
@@ -59,19 +165,18 @@ static void check_valid_uart_config( const uart_config_t *uart_config,
     if (v) {
         ESP_LOGE(TAG, "Invalid driver index");
         send_microusc_system_status(USC_SYSTEM_ERROR);
-        return;
+        return ESP_ERR_NO_MEM;
     }
 
     if (OUTSIDE_SCOPE(port_config->port, UART_NUM_MAX)) {
         ESP_LOGE(TAG, "Invalid UART port");
         send_microusc_system_status(USC_SYSTEM_ERROR);
-        return;
+        return ESP_ERR_INVALID_ARG;
     }
 
-    vTaskDelay(LOOP_DELAY_MS); /* 10ms delay */
-
-    /* Initialize UART hardware */
+    /* Initialize UART hardware, aborts on failure */
     uart_init(*port_config, *uart_config);
+    return ESP_OK;
 }
 
 /**
@@ -84,11 +189,88 @@ struct usc_driver_t *getLastDriver(void) {
     return (node != NULL) ? &node->driver : NULL;
 }
 
+/**
+ * @brief Whether a driver already owns the UART port.
+ */
+static bool port_in_use(const uart_port_t port)
+{
+    bool found = false;
+    struct usc_driverList *item, *tmp;
+    xSemaphoreTake(driver_system.lock, portMAX_DELAY);
+    list_for_each_entry_safe(item, tmp, &driver_system.driver_list.list, list) {
+        if (item->driver.port_config.port == port) {
+            found = true;
+            break;
+        }
+    }
+    xSemaphoreGive(driver_system.lock);
+    return found;
+}
+
+/**
+ * @brief Whether a driver restored by warm boot runs with the configuration asked for.
+ *
+ * A NULL or empty name matches, since the restored driver kept the default name given
+ * when it was first installed.
+ */
+static bool restored_matches( const struct usc_driver_t *driver,
+                              const char *const driver_name,
+                              const uart_config_t *uart_config,
+                              const uart_port_config_t *port_config
+) {
+    const uart_config_t *c = &driver->uart_config;
+    const bool same_name = driver_name == NULL || driver_name[0] == '\0' ||
+                           strncmp(driver->driver_name, driver_name, DRIVER_NAME_SIZE - 1) == 0;
+    return same_name &&
+           c->baud_rate == uart_config->baud_rate && c->data_bits == uart_config->data_bits &&
+           c->parity == uart_config->parity && c->stop_bits == uart_config->stop_bits &&
+           c->flow_ctrl == uart_config->flow_ctrl && c->rx_flow_ctrl_thresh == uart_config->rx_flow_ctrl_thresh &&
+           c->source_clk == uart_config->source_clk &&
+           driver->port_config.tx == port_config->tx && driver->port_config.rx == port_config->rx;
+}
+
+/**
+ * @brief Remove a driver whose installation failed after it was linked, so the port
+ * can be installed again.
+ */
+static void install_undo(struct usc_driver_t *driver)
+{
+    microusc_ready_set(MICROUSC_READY_UART(driver->priority)); /* lets a waiting reader run into its stop */
+    const esp_err_t ret = usc_driver_deinit(driver);
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "Could not undo installing %s: %s", driver->driver_name, esp_err_to_name(ret));
+    }
+}
+
 esp_err_t usc_driver_install( const char *const driver_name,
                               const uart_config_t uart_config,
                               const uart_port_config_t port_config,
                               const usc_process_t driver_process,
                               const stack_size_t stack_size
+) {
+    if (microusc_warm_boot_restored_port(port_config.port, driver_process)) {
+        uscDriverHandler restored = usc_driver_get_handle(port_config.port);
+        if (restored != NULL && restored_matches(restored, driver_name, &uart_config, &port_config)) {
+            ESP_LOGI(TAG, "UART%d already restored by warm boot", (int)port_config.port);
+            return ESP_OK;
+        }
+        if (restored != NULL) {
+            ESP_LOGW(TAG, "UART%d was restored with another configuration, reinstalling", (int)port_config.port);
+            const esp_err_t ret = usc_driver_deinit(restored);
+            if (ret != ESP_OK) {
+                return ret;
+            }
+        }
+    }
+    return usc_driver_install_restored(driver_name, uart_config, port_config, driver_process, stack_size, false);
+}
+
+esp_err_t usc_driver_install_restored( const char *const driver_name,
+                                       const uart_config_t uart_config,
+                                       const uart_port_config_t port_config,
+                                       const usc_process_t driver_process,
+                                       const stack_size_t stack_size,
+                                       const bool has_access
 ) {
     if (driver_process == NULL) {
         ESP_LOGE(TAG, "driver_process cannot be NULL");
@@ -96,30 +278,59 @@ esp_err_t usc_driver_install( const char *const driver_name,
         return ESP_ERR_INVALID_ARG;
     }
 
+    if (port_in_use(port_config.port)) {
+        ESP_LOGE(TAG, "UART%d already has a driver", (int)port_config.port);
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    const int64_t start = esp_timer_get_time();
+
     /* Validate UART configuration and add driver */
-    check_valid_uart_config(&uart_config, &port_config);
-    addSingleDriver(driver_name, uart_config, port_config, driver_process, stack_size);
+    esp_err_t ret = check_valid_uart_config(&uart_config, &port_config);
+    if (ret != ESP_OK) {
+        return ret;
+    }
+    const int64_t uart_done = esp_timer_get_time();
+    addSingleDriver(driver_name, uart_config, port_config, driver_process,
+                    microusc_persist_stack_size(driver_name, stack_size), has_access);
 
     SemaphoreHandle_t system_lock = driver_system.lock;
     xSemaphoreTake(system_lock, portMAX_DELAY); /* Acquire system lock */
     struct usc_driver_t *current_driver = getLastDriver(); /* check if it was succesfully linked to the sub system */
-    if (current_driver == NULL) {
+    if (current_driver == NULL || current_driver->port_config.port != port_config.port) {
         ESP_LOGE(TAG, "Failed to get the last driver in the system driver manager");
         xSemaphoreGive(system_lock);
+        uart_driver_delete(port_config.port); /* nothing else was linked */
         send_microusc_system_status(USC_SYSTEM_ERROR);
         return ESP_ERR_NO_MEM;
     }
 
     /* Acquire driver's sync semaphore */
-    if (!xSemaphoreTake(current_driver->sync_signal, SEMAPHORE_WAIT_TIME)) {
+    if (driver_lock_take(current_driver, SEMAPHORE_WAIT_TIME) != pdTRUE) {
         ESP_LOGE(TAG, "Failed to take semaphore");
         xSemaphoreGive(system_lock);
+        install_undo(current_driver);
         send_microusc_system_status(USC_SYSTEM_ERROR);
         return ESP_ERR_INVALID_STATE;
     }
 
     xSemaphoreGive(system_lock); /* Release system lock */
+    microusc_warm_boot_record(current_driver);
+    microusc_sleep_restore_rx(current_driver);
+    microusc_persist_driver_installed(current_driver);
     xSemaphoreGive(current_driver->sync_signal); /* Release driver's sync semaphore */
+
+    /* The reader waits for its UART; this returns once the reader has started */
+    const UBaseType_t index = current_driver->priority;
+    microusc_ready_set(MICROUSC_READY_UART(index));
+    if (microusc_ready_wait(MICROUSC_READY_READER(index), MICROUSC_READY_DRIVER_TIMEOUT) != ESP_OK) {
+        ESP_LOGE(TAG, "Reader task of %s did not start", current_driver->driver_name);
+        install_undo(current_driver);
+        send_microusc_system_status(USC_SYSTEM_ERROR);
+        return ESP_ERR_TIMEOUT;
+    }
+    const int64_t end = esp_timer_get_time();
+    microusc_boot_profile_driver(index, (uint32_t)(uart_done - start), (uint32_t)(end - uart_done), (uint32_t)(end - start));
     
     #ifdef MICROUSC_DEBUG_MEMORY_USAGE
     send_microusc_system_status(USC_SYSTEM_MEMORY_USAGE);
@@ -128,6 +339,144 @@ esp_err_t usc_driver_install( const char *const driver_name,
     return ESP_OK;
 }
 
+uscDriverHandler usc_driver_get_handle(uart_port_t port)
+{
+    struct usc_driver_t *found = NULL;
+    xSemaphoreTake(driver_system.lock, portMAX_DELAY);
+    struct usc_driverList *item, *tmp;
+    list_for_each_entry_safe(item, tmp, &driver_system.driver_list.list, list) {
+        if (item->driver.port_config.port == port) {
+            found = &item->driver;
+            break;
+        }
+    }
+    xSemaphoreGive(driver_system.lock);
+    return found;
+}
+
+/**
+ * @brief The list node of an installed driver, NULL if the handle is not one.
+ *
+ * Must be called with driver_system.lock held.
+ */
+static struct usc_driverList *find_node(const struct usc_driver_t *driver)
+{
+    struct usc_driverList *item, *tmp;
+    list_for_each_entry_safe(item, tmp, &driver_system.driver_list.list, list) {
+        if (&item->driver == driver) {
+            return item;
+        }
+    }
+    return NULL;
+}
+
+/**
+ * @brief Wait until a stopped reader task is suspended, so deleting it frees nothing in use.
+ */
+static esp_err_t reader_wait_stopped(struct usc_driver_t *driver)
+{
+    const UBaseType_t index = driver->priority;
+    if (driver->uart_reader.task == NULL ||
+        microusc_ready_wait(MICROUSC_READY_STOPPED(index), MICROUSC_READY_DRIVER_TIMEOUT) != ESP_OK) {
+        return ESP_ERR_TIMEOUT;
+    }
+    while (eTaskGetState(driver->uart_reader.task) != eSuspended) {
+        vTaskDelay(1); /* between signalling and suspending itself */
+    }
+    return ESP_OK;
+}
+
+esp_err_t usc_driver_deinit(uscDriverHandler driver)
+{
+    if (driver == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    const TaskHandle_t self = xTaskGetCurrentTaskHandle();
+    if (self == driver->uart_reader.task || self == driver->uart_processor.task) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    xSemaphoreTake(driver_system.lock, portMAX_DELAY);
+    struct usc_driverList *node = find_node(driver);
+    if (node == NULL) {
+        xSemaphoreGive(driver_system.lock);
+        return ESP_ERR_NOT_FOUND;
+    }
+    if (driver_system.paused) {
+        xSemaphoreGive(driver_system.lock); /* a suspended reader never stops */
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    /* Stop the reader first: until it has stopped nothing is torn down, so a failure can be undone */
+    if (driver_lock_take(driver, SEMAPHORE_WAIT_TIME) != pdTRUE) {
+        xSemaphoreGive(driver_system.lock);
+        return ESP_ERR_TIMEOUT;
+    }
+    driver->uart_reader.active = false;
+    xSemaphoreGive(driver->sync_signal);
+
+    const UBaseType_t index = driver->priority;
+    esp_err_t ret = reader_wait_stopped(driver);
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "Reader task of %s did not stop", driver->driver_name);
+        /* A reader that had already left its loop stops anyway, and a retry finds it stopped */
+        driver_lock_take(driver, portMAX_DELAY);
+        driver->uart_reader.active = true;
+        xSemaphoreGive(driver->sync_signal);
+        xSemaphoreGive(driver_system.lock);
+        return ret;
+    }
+    vTaskDelete(driver->uart_reader.task);
+    driver->uart_reader.task = NULL;
+
+    /*
+     * Removal can no longer fail. With the lock held, the processor is not inside a call
+     * on this driver and may be deleted. A lock it holds on another driver is not
+     * released, see the header.
+     */
+    driver_lock_take(driver, portMAX_DELAY);
+    microusc_persist_driver_removed(driver); /* measures the processor stack, so before the delete */
+    microusc_watchdog_remove(driver->watchdog.processor);
+    driver->watchdog.processor = 0;
+    if (driver->uart_processor.task != NULL) {
+        vTaskDelete(driver->uart_processor.task);
+        driver->uart_processor.task = NULL;
+    }
+    xSemaphoreGive(driver->sync_signal);
+
+    /* No reader may forward to the driver once its UART is gone */
+    struct usc_driverList *item, *tmp;
+    list_for_each_entry_safe(item, tmp, &driver_system.driver_list.list, list) {
+        if (item != node && item->driver.routes.active != 0) {
+            driver_lock_take(&item->driver, portMAX_DELAY);
+            usc_route_forget(&item->driver.routes, driver);
+            xSemaphoreGive(item->driver.sync_signal);
+        }
+    }
+
+    microusc_ready_clear(MICROUSC_READY_UART(index) | MICROUSC_READY_READER(index) | MICROUSC_READY_STOPPED(index));
+    uart_driver_delete(driver->port_config.port);
+    microusc_warm_boot_forget(driver);
+    microusc_boot_profile_driver_removed(index);
+    ESP_LOGI(TAG, "%s removed", driver->driver_name);
+    removeSingleDriver(node);
+    xSemaphoreGive(driver_system.lock);
+    return ESP_OK;
+}
+
+esp_err_t usc_driver_lock(uscDriverHandler driver, TickType_t timeout)
+{
+    if (driver == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    return (driver_lock_take(driver, timeout) == pdTRUE) ? ESP_OK : ESP_ERR_TIMEOUT;
+}
+
+void usc_driver_unlock(uscDriverHandler driver)
+{
+    xSemaphoreGive(driver->sync_signal);
+}
+
 /**
  * @brief Writes data to the UART port associated with the driver.
  *
@@ -154,14 +503,19 @@ static esp_err_t usc_driver_write( const struct usc_driver_t *driver,
  * @param len Number of bytes to send.
  * @return ESP_OK on success, ESP_FAIL on failure.
  */
-static __always_inline esp_err_t usc_driver_send_helper( const struct usc_driver_t *driver,
+static __always_inline esp_err_t usc_driver_send_helper( struct usc_driver_t *driver,
                                                          const char *data,
                                                          const size_t len
 ) {
     /* Copy data into driver's buffer at offset 1 */
     memcpy((driver->buffer.memory + 1), data, len);
     /* Write the entire buffer to UART */
-    return usc_driver_write(driver, (const char *)driver->buffer.memory, driver->buffer.size);
+    const esp_err_t err = usc_driver_write(driver, (const char *)driver->buffer.memory, driver->buffer.size);
+    if (err == ESP_OK) {
+        STAT_ADD(driver, frames_tx, 1);
+        STAT_ADD(driver, bytes_tx, driver->buffer.size);
+    }
+    return err;
 }
 
 /**
@@ -197,13 +551,20 @@ static __always_inline esp_err_t usc_driver_send_password(struct usc_driver_t *d
     return usc_driver_send_helper(driver, (const char *)SEND_KEY.bytes, sizeof(SEND_KEY));
 }
 
-__always_inline esp_err_t usc_send_data(uscDriverHandler driver, uint32_t data)
+__always_inline esp_err_t usc_send_data_locked(uscDriverHandler driver, uint32_t data)
 {
     union uint32_4_uint8_t bytes_4; // for safety
     bytes_4.value = data;
 
-    xSemaphoreTake(driver->sync_signal, portMAX_DELAY);
     esp_err_t c = usc_driver_send_helper(driver, (const char *)bytes_4.bytes, sizeof(bytes_4));
+    MICROUSC_TRACE(MICROUSC_TRACE_FRAME_TX, driver->priority, data, c);
+    return c;
+}
+
+__always_inline esp_err_t usc_send_data(uscDriverHandler driver, uint32_t data)
+{
+    driver_lock_take(driver, portMAX_DELAY);
+    esp_err_t c = usc_send_data_locked(driver, data);
     xSemaphoreGive(driver->sync_signal);
     return c;
 }
@@ -226,6 +587,7 @@ static __always_inline uint32_t parse_data(const uint8_t *const data)
 // needs to be changed to use the queue
 usc_status_t handle_serial_key(struct usc_driver_t *driver, const UBaseType_t i)
 {
+    STAT_ADD(driver, handshake_attempts, 1);
     if (usc_driver_request_password(driver) != ESP_OK) {
         ESP_LOGE(TAG, "Failed to send serial");
         return DATA_SEND_ERROR;
@@ -234,15 +596,18 @@ usc_status_t handle_serial_key(struct usc_driver_t *driver, const UBaseType_t i)
     SERIAL_RECIEVE_DELAY();
 
     /* Read the serial key from UART */
-    uint8_t *key = uart_read( driver->port_config.port, 
-                              driver->buffer.memory, 
-                              driver->buffer.size, 
-                              PASSWORD_PING_DELAY
-                            );
+    uart_frame_status_t frame_status;
+    uint8_t *key = uart_read_frame( driver->port_config.port, 
+                                    driver->buffer.memory, 
+                                    driver->buffer.size, 
+                                    PASSWORD_PING_DELAY,
+                                    &frame_status
+                                  );
+    count_frame(driver, frame_status);
     if (key != NULL) {
-        ESP_LOGI(TAG, "Serial key: %u %u %u %u", key[1], key[2], key[3], key[4]);
+        ESP_LOGD(TAG, "Serial key: %u %u %u %u", key[1], key[2], key[3], key[4]);
         uint32_t parsed_data = parse_data(key);
-        ESP_LOGI(TAG, "Parsed value: %lu", parsed_data);
+        MICROUSC_TRACE(MICROUSC_TRACE_HANDSHAKE, driver->priority, parsed_data, 0);
 
         switch (parsed_data) {
             case SERIAL_KEY_VAL:
@@ -273,33 +638,166 @@ static __always_inline void maintain_connection(struct usc_driver_t *driver)
     SERIAL_RECIEVE_DELAY();
 }
 
+/**
+ * @brief Write a routed frame only if the destination's TX buffer has room for all of it.
+ *
+ * Never waits on a full destination, so a slow link cannot stall the source's reader.
+ * Another writer may take the room between the check and the write; the write then
+ * waits only until that writer's bytes have drained into the UART FIFO.
+ */
+static bool route_write(const struct usc_driver_t *to, const uint8_t *out, const size_t len)
+{
+    size_t room = 0;
+    if (uart_get_tx_buffer_free_size(to->port_config.port, &room) != ESP_OK || room < len) {
+        return false;
+    }
+    return uart_write_bytes(to->port_config.port, (const char *)out, len) == (int)len;
+}
+
+/**
+ * @brief Forward a received word over every route of the driver that matches it.
+ *
+ * Called by the reader with the driver lock held, which keeps every destination
+ * installed (see usc_route_forget()). Destination locks are not taken: each frame is
+ * one UART write, which the UART driver does not interleave with other writes.
+ *
+ * @param frame The received frame, still in the driver's buffer.
+ * @return true if a matching route consumes the word.
+ */
+static bool route_word(struct usc_driver_t *driver, const uint32_t data, const uint8_t *frame)
+{
+    uint8_t encoded[USC_FRAME_SIZE];
+    bool encode = true;
+    bool consumed = false;
+    uint32_t matched = 0;
+    uint32_t written = 0;
+
+    for (int i = 0; i < USC_ROUTE_MAX; i++) {
+        struct usc_route *route = &driver->routes.routes[i];
+        if (route->to_count == 0 || data < route->codes.first || data > route->codes.last) {
+            continue;
+        }
+        ROUTE_STAT_ADD(route, matched, 1);
+        matched++;
+
+        const uint8_t *out = frame;
+        size_t len = driver->buffer.size;
+        if (!(route->flags & USC_ROUTE_ZERO_COPY)) {
+            if (encode) {
+                usc_frame_encode(data, encoded);
+                encode = false;
+            }
+            out = encoded;
+            len = sizeof(encoded);
+        }
+
+        for (int j = 0; j < route->to_count; j++) {
+            struct usc_driver_t *to = route->to[j];
+            if (to->has_access && route_write(to, out, len)) {
+                STAT_ADD(to, frames_tx, 1);
+                STAT_ADD(to, bytes_tx, len);
+                ROUTE_STAT_ADD(route, forwarded, 1);
+                ROUTE_STAT_ADD(route, bytes, len);
+                written++;
+            }
+            else {
+                ROUTE_STAT_ADD(route, dropped, 1); /* handshake not done, or no room in the TX buffer */
+            }
+        }
+        consumed |= (route->flags & USC_ROUTE_CONSUME) != 0;
+    }
+
+    if (matched != 0) {
+        MICROUSC_TRACE(MICROUSC_TRACE_ROUTE, driver->priority, data, written);
+    }
+    return consumed;
+}
+
 /**
  * @brief Reads and processes incoming data from the driver.
  *
- * Reads data from UART, parses it, and stores it in the driver's data queue if valid.
+ * Reads data from UART, parses it, and looks it up in the driver's dispatch table.
+ * Words without a handler are stored in the driver's data queue; words with a
+ * handler are returned through `hit` so the caller can run it without the lock.
  *
  * @param driver Pointer to the driver structure.
  * @param i Index of the driver (unused).
+ * @param hit Set to the handler to run once the driver lock is released (fn is NULL if none).
  * @return Status code indicating if data was received.
  */
-static usc_status_t process_data(struct usc_driver_t *driver, const UBaseType_t i)
+static usc_status_t process_data(struct usc_driver_t *driver, const UBaseType_t i, struct usc_dispatch_hit *hit)
 {
-    uint8_t *temp_data = uart_read( driver->port_config.port, 
-                                    driver->buffer.memory, 
-                                    driver->buffer.size, 
-                                    SERIAL_INPUT_DELAY
-                                  );
+    hit->entry.fn = NULL;
+    uart_frame_status_t frame_status;
+    uint8_t *temp_data = uart_read_frame( driver->port_config.port, 
+                                          driver->buffer.memory, 
+                                          driver->buffer.size, 
+                                          SERIAL_INPUT_DELAY,
+                                          &frame_status
+                                        );
+    count_frame(driver, frame_status);
     if (temp_data != NULL) {
         uint32_t data = parse_data(temp_data);
         if (data != 0) {
-            dataStorageQueue_add(driver->data, data); // Add the data to the queue
-            ESP_LOGI(TAG, "Stored: %lu", data);
+            MICROUSC_TRACE(MICROUSC_TRACE_FRAME_RX, i, data, 0);
+            if (driver->routes.active != 0 && route_word(driver, data, temp_data)) {
+                return DATA_RECEIVED; /* consumed by a route, not delivered here */
+            }
+            if (usc_dispatch_lookup(&driver->dispatch, data, hit)) {
+                MICROUSC_TRACE(MICROUSC_TRACE_DISPATCH, i, data, 0);
+            }
+            else {
+                queue_word(driver, data); // Add the data to the queue
+                ESP_LOGD(TAG, "Stored: %lu", data);
+            }
             return DATA_RECEIVED;
         }
+        if (frame_status == UART_FRAME_OK) {
+            STAT_ADD(driver, parse_errors, 1); /* 0 is reserved for an empty queue slot */
+        }
     }
     return DATA_RECEIVE_ERROR; // doesn't need system interface
 }
 
+/**
+ * @brief Runs a handler found by process_data() outside of the driver lock.
+ *
+ * If the handler does not consume the word, it is placed in the driver's queue.
+ *
+ * @param driver Pointer to the driver structure.
+ * @param hit Handler and word returned by process_data().
+ */
+static void run_dispatch_handler(struct usc_driver_t *driver, const struct usc_dispatch_hit *hit)
+{
+    if (hit->entry.fn(driver, hit->data, hit->entry.ctx)) {
+        return; /* consumed by the handler */
+    }
+
+    if (driver_lock_take(driver, SEMAPHORE_WAIT_TIME) == pdTRUE) {
+        queue_word(driver, hit->data);
+        xSemaphoreGive(driver->sync_signal);
+    }
+}
+
+/* Connection and handshake states, the only ones worth a crash log record */
+#define CRASH_LOGGED_STATUSES ( (1UL << CONNECTED) | (1UL << NOT_CONNECTED) | (1UL << TIME_OUT) | (1UL << ERROR) )
+
+/**
+ * @brief Update the driver status. Only connection changes are logged: per-frame states
+ * (DATA_RECEIVED, DATA_RECEIVE_ERROR) and handshake retries ending the same way as the
+ * last logged one would push real faults out of the crash log within a few frames.
+ */
+static __always_inline void set_driver_status(struct usc_driver_t *driver, const UBaseType_t i, const usc_status_t status)
+{
+    if (driver->status != status) {
+        driver->status = status;
+        if (((1UL << status) & CRASH_LOGGED_STATUSES) && driver->logged_status != status) {
+            driver->logged_status = status;
+            microusc_crash_log_record(MICROUSC_CRASH_DRIVER_STATUS, (uint8_t)status, (uint8_t)i, 0);
+        }
+    }
+}
+
 void usc_driver_read_task(void *pvParameters)
 {
     const UBaseType_t index = uxTaskPriorityGet(NULL) - TASK_PRIORITY_START; /* gets priority ID of the task, more temportary */
@@ -310,18 +808,21 @@ void usc_driver_read_task(void *pvParameters)
 
     ESP_LOGI(TASK_TAG, "Priority %u\n", (index + TASK_PRIORITY_START));
     ESP_LOGI(TASK_TAG, "Task status: %d\n", *active);
-    vTaskDelay(LOOP_DELAY_MS);
+    microusc_ready_set(MICROUSC_READY_READER(driver->priority));
+    microusc_ready_wait(MICROUSC_READY_UART(driver->priority), portMAX_DELAY); /* registered on an installed UART */
     
     while (1) {
-        if (xSemaphoreTake(sync_signal, portMAX_DELAY) == pdTRUE) {
+        microusc_watchdog_feed(driver->watchdog.reader);
+        if (driver_lock_take(driver, portMAX_DELAY) == pdTRUE) {
             bool needs_check = *active && !(*hasAccess);
             if (needs_check) {
-                driver->status = handle_serial_key(driver, index); /* Check if the serial key is valid */
+                set_driver_status(driver, index, handle_serial_key(driver, index)); /* Check if the serial key is valid */
                 if (driver->status != CONNECTED) {
                     ESP_LOGW(TASK_TAG, "Serial key check failed, retrying...");
                 }
                 else {
                     driver->has_access = true;
+                    microusc_warm_boot_session(driver);
                 }
             }
 
@@ -338,12 +839,17 @@ void usc_driver_read_task(void *pvParameters)
 
 
     /* Main data processing loop */
+   struct usc_dispatch_hit hit;
    while (1) {
-        if (xSemaphoreTake(sync_signal, portMAX_DELAY) == pdTRUE) {
-            driver->status = process_data(driver, index);
-            ESP_LOGI(TASK_TAG, "Task %d is running", index);
+        microusc_watchdog_feed(driver->watchdog.reader);
+        if (driver_lock_take(driver, portMAX_DELAY) == pdTRUE) {
+            set_driver_status(driver, index, process_data(driver, index, &hit));
+            ESP_LOGV(TASK_TAG, "Task %d is running", index);
             bool should_exit = (*active == false);
             driver_isr_trigger(driver);
+            if (hit.entry.fn != NULL) {
+                run_dispatch_handler(driver, &hit); /* lock released, handler may send */
+            }
             taskYIELD(); /* Yield to allow other tasks to run */
             // xSemaphoreGive(sync_signal);
             if (should_exit) break;
@@ -352,18 +858,230 @@ void usc_driver_read_task(void *pvParameters)
     }
 
     ESP_LOGI(TASK_TAG, "Task %s is terminating...\n", driver->driver_name);
-    vTaskDelay(LOOP_DELAY_MS);
-    vTaskDelete(NULL); /* Delete the task */
+    microusc_watchdog_remove(driver->watchdog.reader);
+    driver->watchdog.reader = 0;
+    /* usc_driver_deinit() deletes the task once it is suspended, before freeing its stack */
+    microusc_ready_set(MICROUSC_READY_STOPPED(driver->priority));
+    vTaskSuspend(NULL);
+}
+
+/**
+ * @brief Take the oldest word from the driver's queue for the processor task.
+ *
+ * When the word had arrived in an empty queue, the time it waited is the processor's
+ * wake-up latency: the reader had nothing else queued, so the wait is scheduling and
+ * polling delay rather than backlog. Must be called with the driver lock held.
+ */
+static __always_inline uint32_t take_word(struct usc_driver_t *driver)
+{
+    const uint32_t data = dataStorageQueue_top(driver->data);
+    if (data != 0 && driver->wake_pending_us != 0) {
+        const uint32_t waited = (uint32_t)esp_timer_get_time() - driver->wake_pending_us;
+        driver->wake_pending_us = 0;
+        STAT_ADD(driver, wakes, 1);
+        STAT_ADD(driver, wake_us, waited);
+        stat_max(&driver->stats.wake_max_us, waited);
+    }
+    return data;
+}
+
+uint32_t usc_driver_get_data_locked(uscDriverHandler driver)
+{
+    return driver->has_access ? take_word(driver) : 0;
 }
 
 uint32_t usc_driver_get_data(uscDriverHandler driver)
 {
     uint32_t data = 0;
-    if (xSemaphoreTake(driver->sync_signal, portMAX_DELAY) == pdTRUE) {
-        if (driver->has_access) {
-            data = dataStorageQueue_top(driver->data);
-        }
+    if (driver_lock_take(driver, portMAX_DELAY) == pdTRUE) {
+        data = usc_driver_get_data_locked(driver);
         xSemaphoreGive(driver->sync_signal);
     }
     return data;
-}
\ No newline at end of file
+}
+
+esp_err_t usc_register_handler(uscDriverHandler driver, usc_code_range_t codes, usc_handler_t fn, void *ctx)
+{
+    if (driver == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    if (driver_lock_take(driver, SEMAPHORE_WAIT_TIME) != pdTRUE) {
+        ESP_LOGE(TAG, "Failed to take semaphore");
+        return ESP_ERR_TIMEOUT;
+    }
+    esp_err_t err = usc_dispatch_insert(&driver->dispatch, codes, fn, ctx);
+    xSemaphoreGive(driver->sync_signal);
+    return err;
+}
+
+esp_err_t usc_register_default_handler(uscDriverHandler driver, usc_handler_t fn, void *ctx)
+{
+    if (driver == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    if (driver_lock_take(driver, SEMAPHORE_WAIT_TIME) != pdTRUE) {
+        ESP_LOGE(TAG, "Failed to take semaphore");
+        return ESP_ERR_TIMEOUT;
+    }
+    driver->dispatch.fallback.fn = fn;
+    driver->dispatch.fallback.ctx = ctx;
+    xSemaphoreGive(driver->sync_signal);
+    return ESP_OK;
+}
+
+esp_err_t usc_route_add( uscDriverHandler from,
+                         const uscDriverHandler *to,
+                         const size_t to_count,
+                         const usc_code_range_t codes,
+                         const uint32_t flags,
+                         usc_route_t *route
+) {
+    if (from == NULL || to == NULL || to_count == 0 || to_count >= DRIVER_MAX || codes.first > codes.last) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    for (size_t i = 0; i < to_count; i++) {
+        if (to[i] == NULL || to[i] == from) {
+            return ESP_ERR_INVALID_ARG;
+        }
+        for (size_t j = 0; j < i; j++) {
+            if (to[j] == to[i]) {
+                return ESP_ERR_INVALID_ARG;
+            }
+        }
+    }
+
+    /* Installed now, and usc_driver_deinit() cannot run until the route is in place */
+    xSemaphoreTake(driver_system.lock, portMAX_DELAY);
+    esp_err_t err = (find_node(from) != NULL) ? ESP_OK : ESP_ERR_NOT_FOUND;
+    for (size_t i = 0; i < to_count && err == ESP_OK; i++) {
+        if (find_node(to[i]) == NULL) {
+            err = ESP_ERR_NOT_FOUND;
+        }
+    }
+    if (err == ESP_OK) {
+        if (driver_lock_take(from, SEMAPHORE_WAIT_TIME) == pdTRUE) {
+            usc_route_t id;
+            err = usc_route_insert(&from->routes, codes, to, (uint8_t)to_count, (uint8_t)flags, &id);
+            xSemaphoreGive(from->sync_signal);
+            if (err == ESP_OK && route != NULL) {
+                *route = id;
+            }
+        }
+        else {
+            err = ESP_ERR_TIMEOUT;
+        }
+    }
+    xSemaphoreGive(driver_system.lock);
+    return err;
+}
+
+esp_err_t usc_route_remove(uscDriverHandler from, usc_route_t route)
+{
+    if (from == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    if (driver_lock_take(from, SEMAPHORE_WAIT_TIME) != pdTRUE) {
+        ESP_LOGE(TAG, "Failed to take semaphore");
+        return ESP_ERR_TIMEOUT;
+    }
+    const esp_err_t err = usc_route_erase(&from->routes, route);
+    xSemaphoreGive(from->sync_signal);
+    return err;
+}
+
+esp_err_t usc_route_get_stats(uscDriverHandler from, usc_route_t route, usc_route_stats_t *stats)
+{
+    if (from == NULL || stats == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    if (driver_lock_take(from, SEMAPHORE_WAIT_TIME) != pdTRUE) {
+        ESP_LOGE(TAG, "Failed to take semaphore");
+        return ESP_ERR_TIMEOUT;
+    }
+    const struct usc_route *r = usc_route_get(&from->routes, route);
+    if (r != NULL) {
+        stats->matched = atomic_load_explicit(&r->stats.matched, memory_order_relaxed);
+        stats->forwarded = atomic_load_explicit(&r->stats.forwarded, memory_order_relaxed);
+        stats->dropped = atomic_load_explicit(&r->stats.dropped, memory_order_relaxed);
+        stats->bytes = atomic_load_explicit(&r->stats.bytes, memory_order_relaxed);
+    }
+    xSemaphoreGive(from->sync_signal);
+    return (r != NULL) ? ESP_OK : ESP_ERR_NOT_FOUND;
+}
+
+esp_err_t usc_driver_enable_watchdog(uscDriverHandler driver, uint32_t timeout_ms, bool supervise_processor)
+{
+    if (driver == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    esp_err_t ret = ESP_OK;
+    if (driver->watchdog.reader == 0) {
+        ret = microusc_watchdog_add(driver->uart_reader.task, driver->driver_name, timeout_ms, &driver->watchdog.reader);
+    }
+    if (ret == ESP_OK && supervise_processor && driver->watchdog.processor == 0) {
+        ret = microusc_watchdog_add(driver->uart_processor.task, driver->driver_name, timeout_ms, &driver->watchdog.processor);
+    }
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "Could not supervise driver %s: %s", driver->driver_name, esp_err_to_name(ret));
+    }
+    return ret;
+}
+
+void usc_driver_feed_watchdog(uscDriverHandler driver)
+{
+    microusc_watchdog_feed(driver->watchdog.processor);
+}
+
+esp_err_t usc_driver_get_stats(uscDriverHandler driver, usc_driver_stats_t *stats)
+{
+    if (driver == NULL || stats == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    const struct usc_driver_counters *c = &driver->stats;
+    stats->frames_rx          = atomic_load_explicit(&c->frames_rx, memory_order_relaxed);
+    stats->frames_tx          = atomic_load_explicit(&c->frames_tx, memory_order_relaxed);
+    stats->bytes_rx           = atomic_load_explicit(&c->bytes_rx, memory_order_relaxed);
+    stats->bytes_tx           = atomic_load_explicit(&c->bytes_tx, memory_order_relaxed);
+    stats->parse_errors       = atomic_load_explicit(&c->parse_errors, memory_order_relaxed);
+    stats->resyncs            = atomic_load_explicit(&c->resyncs, memory_order_relaxed);
+    stats->queue_high_water   = atomic_load_explicit(&c->queue_high_water, memory_order_relaxed);
+    stats->queue_drops        = atomic_load_explicit(&c->queue_drops, memory_order_relaxed);
+    stats->handshake_attempts = atomic_load_explicit(&c->handshake_attempts, memory_order_relaxed);
+    stats->lock_waits         = atomic_load_explicit(&c->lock_waits, memory_order_relaxed);
+    stats->lock_wait_us       = atomic_load_explicit(&c->lock_wait_us, memory_order_relaxed);
+    stats->lock_wait_max_us   = atomic_load_explicit(&c->lock_wait_max_us, memory_order_relaxed);
+    stats->wakes              = atomic_load_explicit(&c->wakes, memory_order_relaxed);
+    stats->wake_us            = atomic_load_explicit(&c->wake_us, memory_order_relaxed);
+    stats->wake_max_us        = atomic_load_explicit(&c->wake_max_us, memory_order_relaxed);
+    stats->sleep_wakes        = atomic_load_explicit(&c->sleep_wakes, memory_order_relaxed);
+    stats->sleep_wake_us      = atomic_load_explicit(&c->sleep_wake_us, memory_order_relaxed);
+    stats->sleep_wake_max_us  = atomic_load_explicit(&c->sleep_wake_max_us, memory_order_relaxed);
+    return ESP_OK;
+}
+
+esp_err_t usc_driver_reset_stats(uscDriverHandler driver)
+{
+    if (driver == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    microusc_persist_driver_reset(driver); /* zeroes the lifetime counters, the totals keep them */
+    struct usc_driver_counters *c = &driver->stats;
+    atomic_store_explicit(&c->queue_high_water, 0, memory_order_relaxed);
+    atomic_store_explicit(&c->lock_waits, 0, memory_order_relaxed);
+    atomic_store_explicit(&c->lock_wait_us, 0, memory_order_relaxed);
+    atomic_store_explicit(&c->lock_wait_max_us, 0, memory_order_relaxed);
+    atomic_store_explicit(&c->wakes, 0, memory_order_relaxed);
+    atomic_store_explicit(&c->wake_us, 0, memory_order_relaxed);
+    atomic_store_explicit(&c->wake_max_us, 0, memory_order_relaxed);
+    atomic_store_explicit(&c->sleep_wakes, 0, memory_order_relaxed);
+    atomic_store_explicit(&c->sleep_wake_us, 0, memory_order_relaxed);
+    atomic_store_explicit(&c->sleep_wake_max_us, 0, memory_order_relaxed);
+    return ESP_OK;
+}
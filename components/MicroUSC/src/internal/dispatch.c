@@ -0,0 +1,173 @@
+#include "MicroUSC/internal/dispatch.h"
+#include "esp_log.h"
+#include <string.h>
+
+#define TAG "[DISPATCH]"
+
+#define FIBONACCI_HASH_MULT ( 2654435769u )
+
+/**
+ * @brief Multiplicative (Fibonacci) hash of a code into the hashed slot range.
+ */
+static __always_inline uint32_t dispatch_hash(const uint32_t code)
+{
+    return (code * FIBONACCI_HASH_MULT) >> (32 - USC_DISPATCH_HASH_BITS);
+}
+
+void usc_dispatch_init(struct usc_dispatch_table *table)
+{
+    memset(table, 0, sizeof(struct usc_dispatch_table));
+}
+
+/**
+ * @brief Insert or replace a single code in the hashed table using linear probing.
+ *
+ * Removed entries stay marked as used so probing chains stay intact. A new code takes
+ * the first removed entry on its probing path, once the rest of the chain shows it is
+ * not already present.
+ */
+static esp_err_t dispatch_hash_insert( struct usc_dispatch_table *table,
+                                       const uint32_t code,
+                                       const struct usc_dispatch_entry entry
+) {
+    uint32_t index = dispatch_hash(code);
+    struct usc_dispatch_slot *free_slot = NULL;
+
+    for (int probe = 0; probe < USC_DISPATCH_HASH_SIZE; probe++) {
+        struct usc_dispatch_slot *slot = &table->hashed[index];
+        if (!slot->used) {
+            if (free_slot == NULL) {
+                free_slot = slot;
+            }
+            break; /* end of the probing chain */
+        }
+        if (slot->code == code) {
+            slot->entry = entry; /* replace (or remove when fn is NULL) */
+            return ESP_OK;
+        }
+        if (slot->entry.fn == NULL && free_slot == NULL) {
+            free_slot = slot; /* first removed entry, reused if the code is not found */
+        }
+        index = (index + 1) & (USC_DISPATCH_HASH_SIZE - 1);
+    }
+
+    if (entry.fn == NULL) {
+        return ESP_OK; /* nothing to remove */
+    }
+    if (free_slot == NULL) {
+        ESP_LOGE(TAG, "Hashed dispatch table is full");
+        return ESP_ERR_NO_MEM;
+    }
+
+    free_slot->code = code;
+    free_slot->entry = entry;
+    free_slot->used = true;
+    return ESP_OK;
+}
+
+/**
+ * @brief Insert, replace or remove a range that does not fit the direct table.
+ */
+static esp_err_t dispatch_range_insert( struct usc_dispatch_table *table,
+                                        const usc_code_range_t codes,
+                                        const struct usc_dispatch_entry entry
+) {
+    for (uint8_t i = 0; i < table->range_count; i++) {
+        struct usc_dispatch_range *range = &table->ranges[i];
+        if (range->first == codes.first && range->last == codes.last) {
+            if (entry.fn != NULL) {
+                range->entry = entry;
+            }
+            else {
+                /* Keep the list packed so the lookup loop stays short */
+                table->range_count--;
+                *range = table->ranges[table->range_count];
+            }
+            return ESP_OK;
+        }
+    }
+
+    if (entry.fn == NULL) {
+        return ESP_OK;
+    }
+    if (table->range_count >= USC_DISPATCH_RANGE_MAX) {
+        ESP_LOGE(TAG, "Range dispatch list is full");
+        return ESP_ERR_NO_MEM;
+    }
+
+    table->ranges[table->range_count++] = (struct usc_dispatch_range) {
+        .first = codes.first,
+        .last = codes.last,
+        .entry = entry,
+    };
+    return ESP_OK;
+}
+
+esp_err_t usc_dispatch_insert(struct usc_dispatch_table *table, usc_code_range_t codes, usc_handler_t fn, void *ctx)
+{
+    if (codes.first > codes.last) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    const struct usc_dispatch_entry entry = { .fn = fn, .ctx = (fn != NULL) ? ctx : NULL };
+
+    if (codes.last < USC_DISPATCH_DIRECT_SIZE) {
+        for (uint32_t code = codes.first; code <= codes.last; code++) {
+            table->direct[code] = entry;
+        }
+        return ESP_OK;
+    }
+
+    if (codes.first == codes.last) {
+        return dispatch_hash_insert(table, codes.first, entry);
+    }
+
+    return dispatch_range_insert(table, codes, entry);
+}
+
+static __always_inline bool dispatch_hit(const struct usc_dispatch_entry *entry, uint32_t data, struct usc_dispatch_hit *hit)
+{
+    hit->entry = *entry;
+    hit->data = data;
+    return true;
+}
+
+bool usc_dispatch_lookup(const struct usc_dispatch_table *table, uint32_t data, struct usc_dispatch_hit *hit)
+{
+    if (data < USC_DISPATCH_DIRECT_SIZE) {
+        if (table->direct[data].fn != NULL) {
+            return dispatch_hit(&table->direct[data], data, hit);
+        }
+    }
+    else {
+        uint32_t index = dispatch_hash(data);
+        for (int probe = 0; probe < USC_DISPATCH_HASH_SIZE; probe++) {
+            const struct usc_dispatch_slot *slot = &table->hashed[index];
+            if (!slot->used) {
+                break;
+            }
+            if (slot->code == data) {
+                if (slot->entry.fn != NULL) {
+                    return dispatch_hit(&slot->entry, data, hit);
+                }
+                break;
+            }
+            index = (index + 1) & (USC_DISPATCH_HASH_SIZE - 1);
+        }
+    }
+
+    /* Bounded by USC_DISPATCH_RANGE_MAX, ranges may straddle the direct table */
+    for (uint8_t i = 0; i < table->range_count; i++) {
+        const struct usc_dispatch_range *range = &table->ranges[i];
+        if (range->first <= data && data <= range->last) {
+            return dispatch_hit(&range->entry, data, hit);
+        }
+    }
+
+    if (table->fallback.fn != NULL) {
+        return dispatch_hit(&table->fallback, data, hit);
+    }
+
+    hit->entry.fn = NULL;
+    return false;
+}
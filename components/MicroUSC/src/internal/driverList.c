@@ -172,7 +172,8 @@ void addSingleDriver( const char *const driver_name,
                       const uart_config_t uart_config,
                       const uart_port_config_t port_config,
                       const usc_process_t driver_process,
-                      const stack_size_t stack_size
+                      const stack_size_t stack_size,
+                      const bool has_access
 ) {
     /* Allocate a new driver list node from the memory pool. */
     struct usc_driverList *new = (struct usc_driverList *)memory_pool_alloc(mem_block_driver_nodes);
@@ -197,10 +198,11 @@ void addSingleDriver( const char *const driver_name,
         driver->uart_processor.stack = (StackType_t *)memory_pool_alloc(mem_block_task_processor);
         driver->uart_processor.stack_size = mem_block_task_processor->block_size;
     }
+    driver->uart_processor.process = driver_process;
 
     /* Store configuration and initialize driver fields. */
     driver->uart_config = uart_config;
-    if (strncmp(driver->driver_name, "", DRIVER_NAME_SIZE - 1) != 0) {
+    if (driver_name != NULL && driver_name[0] != '\0') {
         strncpy(driver->driver_name, driver_name, sizeof(driver_name_t) - 1);
     } else {
         static int no_name = 1;
@@ -210,10 +212,21 @@ void addSingleDriver( const char *const driver_name,
     driver->driver_name[DRIVER_NAME_SIZE - 1] = '\0'; /* NULL terminator for the c string */
     driver->port_config = port_config; /* the port and the rx and tx pins */
     driver->buffer.size = stored_sizes.buffer_size; /* the buffer size of the driver (4 bytes) */
-    driver->status = NOT_CONNECTED; /* by default the driver is seene as not connected */
+    driver->status = has_access ? CONNECTED : NOT_CONNECTED; /* by default the driver is seene as not connected */
+    driver->logged_status = driver->status;
 
     driver->priority = getCurrentEmptyDriverIndexAndOccupy(); /* retrieve the first empty bit */
-    driver->has_access = false; /* by default all devices do not have access */
+    driver->has_access = has_access; /* by default all devices do not have access, unless a warm boot kept the session */
+    usc_dispatch_init(&driver->dispatch); /* no handlers, every word goes to the queue */
+    usc_route_init(&driver->routes);      /* nothing is forwarded */
+    driver->watchdog.reader = 0;          /* supervision is opt-in, see usc_driver_enable_watchdog() */
+    driver->watchdog.processor = 0;
+    memset(&driver->stats, 0, sizeof(driver->stats));
+    driver->wake_pending_us = 0;
+    atomic_store_explicit(&driver->sleep_wake_pending_us, 0, memory_order_relaxed);
+#if CONFIG_FREERTOS_GENERATE_RUN_TIME_STATS
+    memset(&driver->cpu_sample, 0, sizeof(driver->cpu_sample));
+#endif
 
     /* sets up all the varaibles that use dynamic memory inside the driver */
     setUpMemDriver(new, driver_process, driver->priority);
@@ -228,12 +241,23 @@ void addSingleDriver( const char *const driver_name,
 
 void removeSingleDriver(struct usc_driverList *item) 
 {
-    if (driver_system.size != 0) {
-        /* Remove the node from the list and decrement the size. */
-        list_del(&item->list);
-        item = NULL;
-        driver_system.size--;
+    if (driver_system.size == 0) {
+        return;
+    }
+    /* Remove the node from the list and decrement the size. */
+    list_del(&item->list);
+    driver_system.size--;
+
+    /* Release what addSingleDriver() allocated; the tasks must already be deleted */
+    struct usc_driver_t *driver = &item->driver;
+    heap_caps_free(driver->data); /* the queue lives at the start of its buffer */
+    if (mem_block_task_processor == NULL) {
+        heap_caps_free(driver->uart_processor.stack);
+    } else {
+        memory_pool_free(mem_block_task_processor, driver->uart_processor.stack);
     }
+    releaseDriverIndex(driver->priority);
+    memory_pool_free(mem_block_driver_nodes, item);
 }
 
 void freeDriverList(void) 
@@ -299,19 +323,33 @@ __always_inline esp_err_t init_hidden_driver_lists(const size_t buffer_size, con
 void IRAM_ATTR usc_drivers_pause(void)
 {
     struct usc_driverList *current, *tmp;
-    list_for_each_entry_safe(current, tmp, &driver_system.driver_list.list, list) { // might be unsafe
+    xSemaphoreTake(driver_system.lock, portMAX_DELAY); /* usc_driver_deinit() frees nodes */
+    list_for_each_entry_safe(current, tmp, &driver_system.driver_list.list, list) {
         struct usc_driver_t *driver = &current->driver;
-        vTaskSuspend(driver->uart_processor.task);
-        vTaskSuspend(driver->uart_reader.task);
+        if (driver->uart_processor.task != NULL) {
+            vTaskSuspend(driver->uart_processor.task); /* NULL would suspend the caller */
+        }
+        if (driver->uart_reader.task != NULL) {
+            vTaskSuspend(driver->uart_reader.task);
+        }
     }
+    driver_system.paused = true;
+    xSemaphoreGive(driver_system.lock);
 }
 
 void IRAM_ATTR usc_drivers_resume(void)
 {
     struct usc_driverList *current, *tmp;
-    list_for_each_entry_safe(current, tmp, &driver_system.driver_list.list, list) { // might be unsafe
+    xSemaphoreTake(driver_system.lock, portMAX_DELAY);
+    list_for_each_entry_safe(current, tmp, &driver_system.driver_list.list, list) {
         struct usc_driver_t *driver = &current->driver;
-        vTaskResume(driver->uart_processor.task);
-        vTaskResume(driver->uart_reader.task);
+        if (driver->uart_processor.task != NULL) {
+            vTaskResume(driver->uart_processor.task);
+        }
+        if (driver->uart_reader.task != NULL) {
+            vTaskResume(driver->uart_reader.task);
+        }
     }
+    driver_system.paused = false;
+    xSemaphoreGive(driver_system.lock);
 }
\ No newline at end of file
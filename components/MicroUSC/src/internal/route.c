@@ -0,0 +1,75 @@
+#include "MicroUSC/internal/route.h"
+#include "esp_log.h"
+#include <string.h>
+
+#define TAG "[ROUTE]"
+
+void usc_route_init(struct usc_route_table *table)
+{
+    memset(table, 0, sizeof(struct usc_route_table));
+}
+
+esp_err_t usc_route_insert( struct usc_route_table *table,
+                            const usc_code_range_t codes,
+                            struct usc_driver_t *const *to,
+                            const uint8_t to_count,
+                            const uint8_t flags,
+                            uint8_t *id
+) {
+    for (uint8_t i = 0; i < USC_ROUTE_MAX; i++) {
+        struct usc_route *route = &table->routes[i];
+        if (route->to_count != 0) {
+            continue;
+        }
+        memset(route, 0, sizeof(struct usc_route));
+        route->codes = codes;
+        memcpy(route->to, to, to_count * sizeof(to[0]));
+        route->flags = flags;
+        route->to_count = to_count; /* last, a non-zero count marks the slot as used */
+        table->active++;
+        *id = i;
+        return ESP_OK;
+    }
+    ESP_LOGE(TAG, "Route table is full");
+    return ESP_ERR_NO_MEM;
+}
+
+esp_err_t usc_route_erase(struct usc_route_table *table, const uint8_t id)
+{
+    struct usc_route *route = usc_route_get(table, id);
+    if (route == NULL) {
+        return ESP_ERR_NOT_FOUND;
+    }
+    route->to_count = 0;
+    table->active--;
+    return ESP_OK;
+}
+
+void usc_route_forget(struct usc_route_table *table, const struct usc_driver_t *to)
+{
+    for (uint8_t i = 0; i < USC_ROUTE_MAX; i++) {
+        struct usc_route *route = &table->routes[i];
+        uint8_t kept = 0;
+        for (uint8_t j = 0; j < route->to_count; j++) {
+            if (route->to[j] != to) {
+                route->to[kept++] = route->to[j];
+            }
+        }
+        if (kept != route->to_count) {
+            if (kept == 0) {
+                usc_route_erase(table, i);
+            }
+            else {
+                route->to_count = kept;
+            }
+        }
+    }
+}
+
+struct usc_route *usc_route_get(struct usc_route_table *table, const uint8_t id)
+{
+    if (id >= USC_ROUTE_MAX || table->routes[id].to_count == 0) {
+        return NULL;
+    }
+    return &table->routes[id];
+}
@@ -79,4 +79,16 @@ UBaseType_t getCurrentEmptyDriverIndexAndOccupy(void)
         ESP_LOGI(TAG, "Bit is now: %u", occupied_bits);
     }
     return v;
-}
\ No newline at end of file
+}
+
+void releaseDriverIndex(UBaseType_t index)
+{
+    if (index >= DRIVER_MAX) {
+        return;
+    }
+    portENTER_CRITICAL(&priority_storage.critical_lock);
+    {
+        priority_storage.active_driver_bits &= ~BIT(index); /* Mark bit as available */
+    }
+    portEXIT_CRITICAL(&priority_storage.critical_lock);
+}
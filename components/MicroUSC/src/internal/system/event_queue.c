@@ -0,0 +1,373 @@
+#include "MicroUSC/internal/system/event_queue.h"
+#include "esp_attr.h"
+#include "esp_log.h"
+#include <stdatomic.h>
+#include <string.h>
+
+#define TAG "[MICROUSC EVENTS]"
+
+typedef enum {
+    EVENT_LANE_HIGH = 0, // errors and power events
+    EVENT_LANE_LOW,      // LED and status requests
+    EVENT_LANE_MAX,
+} event_lane_t;
+
+struct event_lane {
+    MiscrouscBackTrack_t events[MICROUSC_EVENT_LANE_SIZE];
+    uint8_t head;
+    uint8_t count;
+    uint32_t pending; // bit per status of the query events currently queued
+};
+
+/* Bounded multi-producer ring, a cell is ready for the consumer when seq == position + 1 */
+struct stage_cell {
+    _Atomic uint32_t seq;
+    MiscrouscBackTrack_t event;
+};
+
+static struct {
+    struct stage_cell stage[MICROUSC_EVENT_STAGE_SIZE]; // written by posters
+    _Atomic uint32_t stage_tail;
+    uint32_t stage_head;                                // system task only
+    _Atomic uint32_t lost_errors;                       // errors that found the stage ring full
+    _Atomic uint32_t lost_error_pc;
+    _Atomic uint32_t signals;                           // MICROUSC_EVENT_SIGNAL_* bits raised since the last take
+    _Atomic bool consumer_waiting;
+    struct event_lane lanes[EVENT_LANE_MAX];            // system task only
+    uint32_t coalesced[USC_SYSTEM_STATUS_MAX];
+    _Atomic uint32_t dropped[USC_SYSTEM_STATUS_MAX];
+    TaskHandle_t consumer;
+} event_queue;
+
+#define STATUS_BIT(status) ( 1UL << (uint32_t)(status) )
+
+/* Events that only report state, so one pending copy answers every request */
+#define QUERY_EVENTS ( STATUS_BIT(USC_SYSTEM_MEMORY_USAGE) | \
+                       STATUS_BIT(USC_SYSTEM_SPECIFICATIONS) | \
+                       STATUS_BIT(USC_SYSTEM_DRIVER_STATUS) )
+
+/* Events that preempt everything in the low lane */
+#define HIGH_LANE_EVENTS ( STATUS_BIT(USC_SYSTEM_ERROR) | \
+                           STATUS_BIT(USC_SYSTEM_OFF) | \
+                           STATUS_BIT(USC_SYSTEM_SLEEP) | \
+                           STATUS_BIT(USC_SYSTEM_PAUSE) | \
+                           STATUS_BIT(USC_SYSTEM_RESUME) )
+
+static __always_inline event_lane_t event_lane_of(const microusc_status status)
+{
+    return (STATUS_BIT(status) & HIGH_LANE_EVENTS) ? EVENT_LANE_HIGH : EVENT_LANE_LOW;
+}
+
+static __always_inline MiscrouscBackTrack_t *lane_at(struct event_lane *lane, const uint8_t i)
+{
+    return &lane->events[(lane->head + i) % MICROUSC_EVENT_LANE_SIZE];
+}
+
+static __always_inline bool same_event(const MiscrouscBackTrack_t *a, const MiscrouscBackTrack_t *b)
+{
+    if (a->status != b->status) {
+        return false;
+    }
+    /* Only these two carry a caller PC worth telling apart */
+    if (a->status == USC_SYSTEM_ERROR || a->status == USC_SYSTEM_PRINT_SUCCUSS) {
+        return a->type.caller_pc == b->type.caller_pc;
+    }
+    return true;
+}
+
+/**
+ * @brief Find a pending event that the new event can be merged into.
+ *
+ * @return The pending event, or NULL if the new event needs its own slot.
+ */
+static MiscrouscBackTrack_t *find_coalesce_target(struct event_lane *lane, const MiscrouscBackTrack_t *event)
+{
+    if (lane->count == 0) {
+        return NULL;
+    }
+
+    const uint32_t bit = STATUS_BIT(event->status);
+    if (bit & QUERY_EVENTS) {
+        if ((lane->pending & bit) == 0) {
+            return NULL;
+        }
+        for (uint8_t i = 0; i < lane->count; i++) {
+            MiscrouscBackTrack_t *pending = lane_at(lane, i);
+            if (pending->status == event->status) {
+                return pending;
+            }
+        }
+        return NULL;
+    }
+
+    if (event->status == USC_SYSTEM_ERROR) {
+        for (uint8_t i = 0; i < lane->count; i++) {
+            MiscrouscBackTrack_t *pending = lane_at(lane, i);
+            if (same_event(pending, event)) {
+                return pending;
+            }
+        }
+        return NULL;
+    }
+
+    /* Order-sensitive events only merge with an identical tail */
+    MiscrouscBackTrack_t *tail = lane_at(lane, lane->count - 1);
+    return same_event(tail, event) ? tail : NULL;
+}
+
+/**
+ * @brief Newest pending error in the lane, used when the lane is full.
+ */
+static MiscrouscBackTrack_t *newest_error(struct event_lane *lane)
+{
+    for (int i = (int)lane->count - 1; i >= 0; i--) {
+        MiscrouscBackTrack_t *pending = lane_at(lane, (uint8_t)i);
+        if (pending->status == USC_SYSTEM_ERROR) {
+            return pending;
+        }
+    }
+    return NULL;
+}
+
+/**
+ * @brief Place an event in its lane. Only called from the system task.
+ *
+ * @return true if queued or merged, false if dropped.
+ */
+static bool event_lane_insert(const MiscrouscBackTrack_t *event)
+{
+    const microusc_status status = event->status;
+    const event_lane_t lane_id = event_lane_of(status);
+    struct event_lane *lane = &event_queue.lanes[lane_id];
+
+    MiscrouscBackTrack_t *target = find_coalesce_target(lane, event);
+    if (target == NULL) {
+        /* Non-error events leave room so an error always has a slot or a merge target */
+        size_t limit = MICROUSC_EVENT_LANE_SIZE;
+        if (lane_id == EVENT_LANE_HIGH && status != USC_SYSTEM_ERROR) {
+            limit -= MICROUSC_EVENT_ERROR_RESERVE;
+        }
+
+        if (lane->count < limit) {
+            MiscrouscBackTrack_t *slot = lane_at(lane, lane->count);
+            *slot = *event;
+            lane->count++;
+            lane->pending |= (STATUS_BIT(status) & QUERY_EVENTS);
+            return true;
+        }
+
+        if (status != USC_SYSTEM_ERROR || (target = newest_error(lane)) == NULL) {
+            atomic_fetch_add_explicit(&event_queue.dropped[status], 1, memory_order_relaxed);
+            return false;
+        }
+    }
+
+    const uint32_t merged = (uint32_t)target->repeat + 1 + event->repeat;
+    target->repeat = (merged > UINT16_MAX) ? UINT16_MAX : (uint16_t)merged;
+    event_queue.coalesced[status] += 1 + event->repeat;
+    return true;
+}
+
+/**
+ * @brief Claim a stage cell and publish the event, lock-free.
+ *
+ * One compare-and-swap on the ring tail in the uncontended case, safe from tasks
+ * and ISRs on either core.
+ *
+ * @return false if the stage ring is full.
+ */
+static __always_inline bool IRAM_ATTR stage_push(const MiscrouscBackTrack_t *event)
+{
+    uint32_t pos = atomic_load_explicit(&event_queue.stage_tail, memory_order_relaxed);
+    struct stage_cell *cell;
+
+    while (1) {
+        cell = &event_queue.stage[pos & (MICROUSC_EVENT_STAGE_SIZE - 1)];
+        const uint32_t seq = atomic_load_explicit(&cell->seq, memory_order_acquire);
+        const int32_t diff = (int32_t)(seq - pos);
+        if (diff == 0) {
+            if (atomic_compare_exchange_weak_explicit(&event_queue.stage_tail, &pos, pos + 1,
+                                                      memory_order_relaxed, memory_order_relaxed)) {
+                break;
+            }
+        }
+        else if (diff < 0) {
+            return false; /* the system task has not drained this cell yet */
+        }
+        else {
+            pos = atomic_load_explicit(&event_queue.stage_tail, memory_order_relaxed);
+        }
+    }
+
+    cell->event = *event;
+    atomic_store_explicit(&cell->seq, pos + 1, memory_order_release);
+    return true;
+}
+
+/**
+ * @brief Take the next published stage cell. Only called from the system task.
+ */
+static bool stage_pop(MiscrouscBackTrack_t *event)
+{
+    const uint32_t pos = event_queue.stage_head;
+    struct stage_cell *cell = &event_queue.stage[pos & (MICROUSC_EVENT_STAGE_SIZE - 1)];
+
+    if (atomic_load_explicit(&cell->seq, memory_order_acquire) != pos + 1) {
+        return false; /* empty, or the poster has not finished writing */
+    }
+
+    *event = cell->event;
+    atomic_store_explicit(&cell->seq, pos + MICROUSC_EVENT_STAGE_SIZE, memory_order_release);
+    event_queue.stage_head = pos + 1;
+    return true;
+}
+
+/**
+ * @brief Handle a full stage ring: drop and count, except errors which are kept as a count.
+ */
+static __always_inline void IRAM_ATTR stage_overflow(const MiscrouscBackTrack_t *event)
+{
+    if (event->status == USC_SYSTEM_ERROR) {
+        atomic_store_explicit(&event_queue.lost_error_pc, event->type.caller_pc, memory_order_relaxed);
+        atomic_fetch_add_explicit(&event_queue.lost_errors, 1, memory_order_release);
+    }
+    else {
+        atomic_fetch_add_explicit(&event_queue.dropped[event->status], 1, memory_order_relaxed);
+    }
+}
+
+/**
+ * @brief Move everything posted since the last call into the priority lanes.
+ */
+static void stage_drain(void)
+{
+    MiscrouscBackTrack_t event;
+    while (stage_pop(&event)) {
+        event_lane_insert(&event);
+    }
+
+    const uint32_t lost = atomic_exchange_explicit(&event_queue.lost_errors, 0, memory_order_acquire);
+    if (lost != 0) {
+        /* Re-create the errors from the overflow count so none goes unreported */
+        event.status = USC_SYSTEM_ERROR;
+        event.type.caller_pc = atomic_load_explicit(&event_queue.lost_error_pc, memory_order_relaxed);
+        event.repeat = (lost - 1 > UINT16_MAX) ? UINT16_MAX : (uint16_t)(lost - 1);
+        event_lane_insert(&event);
+    }
+}
+
+void microusc_event_queue_init(TaskHandle_t consumer)
+{
+    memset(&event_queue, 0, sizeof(event_queue));
+    for (uint32_t i = 0; i < MICROUSC_EVENT_STAGE_SIZE; i++) {
+        atomic_init(&event_queue.stage[i].seq, i);
+    }
+    event_queue.consumer = consumer;
+}
+
+void microusc_event_queue_set_consumer(TaskHandle_t consumer)
+{
+    event_queue.consumer = consumer;
+}
+
+/**
+ * @brief Notify the consumer if it is waiting. Only the poster that finds it asleep pays for this.
+ */
+static __always_inline void IRAM_ATTR wake_consumer(BaseType_t *higher_priority_task_woken)
+{
+    if (atomic_exchange(&event_queue.consumer_waiting, false)) {
+        TaskHandle_t consumer = event_queue.consumer;
+        if (consumer != NULL) {
+            if (higher_priority_task_woken != NULL) {
+                vTaskNotifyGiveFromISR(consumer, higher_priority_task_woken);
+            }
+            else {
+                xTaskNotifyGive(consumer);
+            }
+        }
+    }
+}
+
+bool IRAM_ATTR microusc_event_queue_push(const MiscrouscBackTrack_t *event, BaseType_t *higher_priority_task_woken)
+{
+    if ((uint32_t)event->status >= USC_SYSTEM_STATUS_MAX) {
+        return false;
+    }
+
+    const bool queued = stage_push(event);
+    if (!queued) {
+        stage_overflow(event);
+    }
+
+    wake_consumer(higher_priority_task_woken);
+    return queued;
+}
+
+void IRAM_ATTR microusc_event_queue_signal(uint32_t signals, BaseType_t *higher_priority_task_woken)
+{
+    atomic_fetch_or_explicit(&event_queue.signals, signals, memory_order_release);
+    wake_consumer(higher_priority_task_woken);
+}
+
+uint32_t microusc_event_queue_take_signals(void)
+{
+    return atomic_exchange_explicit(&event_queue.signals, 0, memory_order_acquire);
+}
+
+void microusc_event_queue_wait(TickType_t timeout)
+{
+    atomic_store(&event_queue.consumer_waiting, true);
+
+    /* A post published before the flag was set would not notify, so look once more */
+    const uint32_t pos = event_queue.stage_head;
+    const struct stage_cell *cell = &event_queue.stage[pos & (MICROUSC_EVENT_STAGE_SIZE - 1)];
+    const bool pending = (atomic_load(&cell->seq) == pos + 1) ||
+                         (atomic_load(&event_queue.lost_errors) != 0) ||
+                         (atomic_load(&event_queue.signals) != 0);
+
+    if (!pending) {
+        ulTaskNotifyTake(pdTRUE, timeout);
+    }
+    atomic_store(&event_queue.consumer_waiting, false);
+}
+
+void microusc_event_queue_kick(void)
+{
+    /* A pending notification is kept until the next wait, so this is never lost */
+    TaskHandle_t consumer = event_queue.consumer;
+    if (consumer != NULL) {
+        xTaskNotifyGive(consumer);
+    }
+}
+
+bool microusc_event_queue_pop(MiscrouscBackTrack_t *event)
+{
+    stage_drain();
+
+    for (int i = 0; i < EVENT_LANE_MAX; i++) {
+        struct event_lane *lane = &event_queue.lanes[i];
+        if (lane->count != 0) {
+            *event = lane->events[lane->head];
+            lane->head = (lane->head + 1) % MICROUSC_EVENT_LANE_SIZE;
+            lane->count--;
+            lane->pending &= ~STATUS_BIT(event->status);
+            return true;
+        }
+    }
+    return false;
+}
+
+void microusc_event_queue_stats(microusc_status code, uint32_t *coalesced, uint32_t *dropped)
+{
+    uint32_t c = 0, d = 0;
+    if ((uint32_t)code < USC_SYSTEM_STATUS_MAX) {
+        c = event_queue.coalesced[code]; /* single 32-bit word, written by the system task only */
+        d = atomic_load_explicit(&event_queue.dropped[code], memory_order_relaxed);
+    }
+    if (coalesced != NULL) {
+        *coalesced = c;
+    }
+    if (dropped != NULL) {
+        *dropped = d;
+    }
+}
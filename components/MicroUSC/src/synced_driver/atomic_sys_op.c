@@ -65,14 +65,26 @@ static __always_inline size_t moveNext(const size_t current, const size_t size)
     return  ( -( ( current + 1 ) < size ) ) & ( current + 1 );
 }
 
-void dataStorageQueue_add(SerialDataQueueHandler queue, const uint32_t data)
+bool dataStorageQueue_add(SerialDataQueueHandler queue, const uint32_t data)
 {
     const size_t tail = queue->tail; // get the current index
 
     if (queue->serial_data[tail] == 0) {
         queue->serial_data[tail] = data; // store the data in the atomic variable
         queue->tail = moveNext(tail, queue->size); // increment the current index
+        return true;
     }
+    return false; // full, the word is dropped
+}
+
+size_t dataStorageQueue_count(SerialDataQueueHandler queue)
+{
+    const size_t head = queue->head;
+    const size_t tail = queue->tail;
+    if (head == tail) {
+        return (queue->serial_data[head] != 0) ? queue->size : 0; // full or empty
+    }
+    return (tail > head) ? tail - head : queue->size - head + tail;
 }
 
 uint32_t dataStorageQueue_top(SerialDataQueueHandler queue)
@@ -1,4 +1,5 @@
 #include "MicroUSC/synced_driver/esp_uart.h"
+#include "MicroUSC/synced_driver/frame_codec.h"
 #include "esp_heap_caps.h"
 #include <string.h>
 
@@ -16,7 +17,8 @@ void uart_init( uart_port_config_t port_config,
 ) {
     ESP_ERROR_CHECK(uart_param_config(port_config.port, &uart_config));
     ESP_ERROR_CHECK(uart_set_pin(port_config.port, port_config.tx, port_config.rx, UART_PIN_NO_CHANGE, UART_PIN_NO_CHANGE));
-    ESP_ERROR_CHECK(uart_driver_install(port_config.port, BUFFER_SIZE, 0, 0, NULL, 0));
+    /* A TX ring lets routes check for room instead of blocking on a busy port */
+    ESP_ERROR_CHECK(uart_driver_install(port_config.port, BUFFER_SIZE, MICROUSC_UART_TX_BUFFER_SIZE, 0, NULL, 0));
 }
 
 uint8_t *uart_offset_repair( uart_port_t uart, 
@@ -24,41 +26,65 @@ uint8_t *uart_offset_repair( uart_port_t uart,
                                 const size_t len, 
                                 const TickType_t delay
 ) {
+    /* Shift the stream by one byte so the next read starts at a different offset */
     size_t size_of_rx_buffer;
     esp_err_t err = uart_get_buffered_data_len(uart, &size_of_rx_buffer);
-    if (err == ESP_OK || size_of_rx_buffer != 0) {
-        uart_read_bytes(uart, buf, 1, delay); // one byte offset each time
+    if (err == ESP_OK && size_of_rx_buffer != 0) {
+        uint8_t skipped;
+        uart_read_bytes(uart, &skipped, 1, delay);
     }
-    buf[0] = 0xFF;
-    buf[1 + sizeof(uint32_t)] = 0xFF;
-    return buf;
+    return NULL; /* the rejected bytes never reach the caller as a frame */
 }
 
-uint8_t *uart_read( uart_port_t uart, 
-                    uint8_t *buf,
-                    const size_t len, 
-                    const TickType_t delay
+uint8_t *uart_read_frame( uart_port_t uart, 
+                          uint8_t *buf,
+                          const size_t len, 
+                          const TickType_t delay,
+                          uart_frame_status_t *status
 ) {
+    uart_frame_status_t ignored;
+    if (status == NULL) {
+        status = &ignored;
+    }
+
+    if (buf == NULL || len < USC_FRAME_SIZE) {
+        *status = UART_FRAME_ERROR;
+        return NULL;
+    }
+
     size_t size_of_rx_buffer;
     esp_err_t err = uart_get_buffered_data_len(uart, &size_of_rx_buffer);
     if (err != ESP_OK) {
         ESP_LOGE(TAG, "Returning null...");
+        *status = UART_FRAME_ERROR;
         return NULL;
     }
 
-    if (size_of_rx_buffer < len) {
-        ESP_LOGE(TAG, "Returning less than len: %u", size_of_rx_buffer);
+    if (size_of_rx_buffer < USC_FRAME_SIZE) {
+        ESP_LOGV(TAG, "Returning less than len: %zu", size_of_rx_buffer); /* every empty poll */
+        *status = UART_FRAME_INCOMPLETE;
         return NULL;
     }
 
-    uart_read_bytes(uart, buf, len, delay);
-    if (buf[0] != 0xFF || buf[1 + sizeof(uint32_t)] != 0xFF) {
-        ESP_LOGE(TAG, "Recieved: %u %u %u %u %u %u", buf[0], buf[1], buf[2], buf[3], buf[4], buf[5]);
+    /* Exactly one frame, so bytes of the next one stay in the UART buffer */
+    const int read = uart_read_bytes(uart, buf, USC_FRAME_SIZE, delay);
+    if (read < 0 || !usc_frame_decode(buf, (size_t)read, NULL)) {
+        ESP_LOGD(TAG, "Rejected %d byte(s)", read);
+        *status = UART_FRAME_RESYNC;
         return uart_offset_repair(uart, buf, len, delay);
     }
+    *status = UART_FRAME_OK;
     return buf;
 }
 
+uint8_t *uart_read( uart_port_t uart, 
+                    uint8_t *buf,
+                    const size_t len, 
+                    const TickType_t delay
+) {
+    return uart_read_frame(uart, buf, len, delay, NULL);
+}
+
 void uart_port_config_deinit(uart_port_config_t *uart_config) 
 {
     uart_config->port = UART_NUM_MAX; // Not a real PORT
@@ -0,0 +1,21 @@
+#include "MicroUSC/synced_driver/frame_codec.h"
+#include <string.h>
+
+void usc_frame_encode(uint32_t word, uint8_t *frame)
+{
+    frame[0] = USC_FRAME_DELIMITER;
+    memcpy(frame + 1, &word, sizeof(word));
+    frame[1 + sizeof(word)] = USC_FRAME_DELIMITER;
+}
+
+bool usc_frame_decode(const uint8_t *frame, size_t len, uint32_t *word)
+{
+    if (len < USC_FRAME_SIZE ||
+        frame[0] != USC_FRAME_DELIMITER || frame[1 + sizeof(uint32_t)] != USC_FRAME_DELIMITER) {
+        return false;
+    }
+    if (word != NULL) {
+        memcpy(word, frame + 1, sizeof(*word));
+    }
+    return true;
+}
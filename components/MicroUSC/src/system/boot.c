@@ -0,0 +1,121 @@
+#include "MicroUSC/internal/system/boot.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/event_groups.h"
+#include "esp_log.h"
+#include <inttypes.h>
+#include <string.h>
+
+#define TAG "[MICROUSC BOOT]"
+
+_Static_assert(1 + 3 * DRIVER_MAX <= 24, "readiness bits must fit in an event group");
+
+static struct {
+    EventGroupHandle_t group;
+    StaticEventGroup_t group_buffer;
+    microusc_boot_profile_t profile;
+    uint32_t installed; // bit per driver index with an install in profile
+    portMUX_TYPE lock;
+} boot = {
+    .lock = portMUX_INITIALIZER_UNLOCKED,
+};
+
+void microusc_ready_init(void)
+{
+    if (boot.group == NULL) {
+        boot.group = xEventGroupCreateStatic(&boot.group_buffer);
+    }
+}
+
+void microusc_ready_set(EventBits_t bits)
+{
+    if (boot.group != NULL) {
+        xEventGroupSetBits(boot.group, bits);
+    }
+}
+
+void microusc_ready_clear(EventBits_t bits)
+{
+    if (boot.group != NULL) {
+        xEventGroupClearBits(boot.group, bits);
+    }
+}
+
+esp_err_t microusc_ready_wait(EventBits_t bits, TickType_t timeout)
+{
+    if (boot.group == NULL) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    const EventBits_t set = xEventGroupWaitBits(boot.group, bits, pdFALSE, pdTRUE, timeout);
+    return ((set & bits) == bits) ? ESP_OK : ESP_ERR_TIMEOUT;
+}
+
+void microusc_boot_profile_stage(microusc_boot_stage_t stage, uint32_t us)
+{
+    microusc_boot_profile_t *p = &boot.profile;
+    portENTER_CRITICAL(&boot.lock);
+    switch (stage) {
+        case MICROUSC_BOOT_MEMORY:      p->memory_us = us;      break;
+        case MICROUSC_BOOT_SETUP:       p->setup_us = us;       break;
+        case MICROUSC_BOOT_SYSTEM_TASK: p->system_task_us = us; break;
+        case MICROUSC_BOOT_PERSIST:     p->persist_us = us;     break;
+        case MICROUSC_BOOT_WARM_BOOT:   p->warm_boot_us = us;   break;
+        case MICROUSC_BOOT_TOTAL:       p->total_us = us;       break;
+    }
+    portEXIT_CRITICAL(&boot.lock);
+}
+
+void microusc_boot_profile_driver(UBaseType_t index, uint32_t uart_us, uint32_t tasks_us, uint32_t total_us)
+{
+    if (index >= DRIVER_MAX) {
+        return;
+    }
+    portENTER_CRITICAL(&boot.lock);
+    boot.profile.drivers[index].uart_us = uart_us;
+    boot.profile.drivers[index].tasks_us = tasks_us;
+    boot.profile.drivers[index].total_us = total_us;
+    if (!(boot.installed & (1UL << index))) {
+        boot.installed |= 1UL << index;
+        boot.profile.driver_count++;
+    }
+    portEXIT_CRITICAL(&boot.lock);
+}
+
+void microusc_boot_profile_driver_removed(UBaseType_t index)
+{
+    if (index >= DRIVER_MAX) {
+        return;
+    }
+    portENTER_CRITICAL(&boot.lock);
+    if (boot.installed & (1UL << index)) {
+        boot.installed &= ~(1UL << index);
+        boot.profile.driver_count--;
+    }
+    memset(&boot.profile.drivers[index], 0, sizeof(boot.profile.drivers[index]));
+    portEXIT_CRITICAL(&boot.lock);
+}
+
+void microusc_get_boot_profile(microusc_boot_profile_t *profile)
+{
+    if (profile == NULL) {
+        return;
+    }
+    portENTER_CRITICAL(&boot.lock);
+    *profile = boot.profile;
+    portEXIT_CRITICAL(&boot.lock);
+}
+
+void microusc_print_boot_profile(void)
+{
+    microusc_boot_profile_t p;
+    microusc_get_boot_profile(&p);
+
+    ESP_LOGI(TAG, "init %" PRIu32 " us: memory %" PRIu32 ", setup %" PRIu32 ", system task %" PRIu32 ", persist %" PRIu32 ", warm boot %" PRIu32,
+             p.total_us, p.memory_us, p.setup_us, p.system_task_us, p.persist_us, p.warm_boot_us);
+    for (UBaseType_t i = 0; i < DRIVER_MAX; i++) {
+        if (p.drivers[i].total_us == 0) {
+            continue;
+        }
+        ESP_LOGI(TAG, "driver %u install %" PRIu32 " us: uart %" PRIu32 ", tasks %" PRIu32,
+                 (unsigned)i, p.drivers[i].total_us, p.drivers[i].uart_us, p.drivers[i].tasks_us);
+    }
+}
@@ -0,0 +1,200 @@
+#include "MicroUSC/internal/system/crash_log.h"
+#include "freertos/FreeRTOS.h"
+#include "esp_attr.h"
+#include "esp_log.h"
+#include "esp_rom_crc.h"
+#include "esp_timer.h"
+#include <inttypes.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <string.h>
+
+#define TAG "[CRASH LOG]"
+
+#define CRASH_LOG_MAGIC ( 0x55534331 ) // "USC1"
+
+_Static_assert((MICROUSC_CRASH_LOG_SIZE & (MICROUSC_CRASH_LOG_SIZE - 1)) == 0, "Crash log size must be a power of 2");
+
+/* Lives across resets; every field is validated before use since power-on leaves it random */
+typedef struct {
+    uint32_t magic;
+    uint16_t boot;
+    uint16_t reserved;
+    uint32_t crc; // CRC32 of the fields above
+    microusc_crash_record_t records[MICROUSC_CRASH_LOG_SIZE];
+} crash_ring_t;
+
+RTC_NOINIT_ATTR static crash_ring_t crash_ring;
+
+static struct {
+    microusc_crash_record_t previous[MICROUSC_CRASH_LOG_SIZE]; // previous run, oldest first
+    size_t previous_count;
+    uint32_t next_seq;
+    esp_reset_reason_t reset_reason;
+    bool initialized;
+    portMUX_TYPE lock;
+} crash_log = {
+    .lock = portMUX_INITIALIZER_UNLOCKED,
+};
+
+static __always_inline uint32_t record_crc(const microusc_crash_record_t *record)
+{
+    return esp_rom_crc32_le(0, (const uint8_t *)record, offsetof(microusc_crash_record_t, crc));
+}
+
+static __always_inline uint32_t header_crc(const crash_ring_t *ring)
+{
+    return esp_rom_crc32_le(0, (const uint8_t *)ring, offsetof(crash_ring_t, crc));
+}
+
+static __always_inline bool record_valid(const microusc_crash_record_t *record)
+{
+    return record->type != 0 && record->crc == record_crc(record);
+}
+
+/**
+ * @brief Copy the valid records of the last run out of the ring, ordered by sequence.
+ *
+ * Records are validated one by one instead of trusting a stored write position, so a
+ * crash in the middle of a write costs at most that one record.
+ */
+static void crash_log_collect_previous(void)
+{
+    uint32_t max_seq = 0;
+    bool any = false;
+
+    for (int i = 0; i < MICROUSC_CRASH_LOG_SIZE; i++) {
+        const microusc_crash_record_t *record = &crash_ring.records[i];
+        if (!record_valid(record)) {
+            continue;
+        }
+        if (!any || (int32_t)(record->seq - max_seq) > 0) {
+            max_seq = record->seq;
+        }
+        any = true;
+
+        if (record->boot != crash_ring.boot) {
+            continue; /* older run, already reported last boot */
+        }
+
+        /* Insertion sort, the log is tiny */
+        size_t pos = crash_log.previous_count++;
+        while (pos > 0 && (int32_t)(crash_log.previous[pos - 1].seq - record->seq) > 0) {
+            crash_log.previous[pos] = crash_log.previous[pos - 1];
+            pos--;
+        }
+        crash_log.previous[pos] = *record;
+    }
+
+    crash_log.next_seq = any ? max_seq + 1 : 0;
+}
+
+void microusc_crash_log_init(void)
+{
+    if (crash_log.initialized) {
+        return;
+    }
+    crash_log.reset_reason = esp_reset_reason();
+    crash_log.previous_count = 0;
+
+    if (crash_ring.magic == CRASH_LOG_MAGIC && crash_ring.crc == header_crc(&crash_ring)) {
+        crash_log_collect_previous();
+        crash_ring.boot++;
+    }
+    else {
+        memset(&crash_ring, 0, sizeof(crash_ring)); /* power-on or corrupted, start over */
+        crash_ring.magic = CRASH_LOG_MAGIC;
+        crash_log.next_seq = 0;
+    }
+    crash_ring.crc = header_crc(&crash_ring);
+    crash_log.initialized = true;
+
+    microusc_crash_log_record(MICROUSC_CRASH_BOOT, (uint8_t)crash_log.reset_reason, 0, 0);
+
+    /* Anything but a clean power-on or wake-up is worth a look */
+    if (crash_log.previous_count != 0 &&
+        crash_log.reset_reason != ESP_RST_POWERON && crash_log.reset_reason != ESP_RST_DEEPSLEEP) {
+        microusc_crash_log_print();
+    }
+}
+
+void microusc_crash_log_record(microusc_crash_type_t type, uint8_t code, uint8_t source, uint32_t value)
+{
+    if (!crash_log.initialized) {
+        return;
+    }
+
+    microusc_crash_record_t record = {
+        .timestamp_ms = (uint32_t)(esp_timer_get_time() / 1000),
+        .value = value,
+        .boot = crash_ring.boot,
+        .type = (uint8_t)type,
+        .code = code,
+        .source = source,
+    };
+
+    portENTER_CRITICAL(&crash_log.lock);
+    record.seq = crash_log.next_seq++;
+    record.crc = record_crc(&record);
+    crash_ring.records[record.seq & (MICROUSC_CRASH_LOG_SIZE - 1)] = record;
+    portEXIT_CRITICAL(&crash_log.lock);
+}
+
+size_t microusc_crash_log_read(bool previous_boot, microusc_crash_record_t *records, size_t max)
+{
+    if (records == NULL || max == 0) {
+        return 0;
+    }
+
+    if (previous_boot) {
+        const size_t count = (crash_log.previous_count < max) ? crash_log.previous_count : max;
+        memcpy(records, crash_log.previous, count * sizeof(microusc_crash_record_t));
+        return count;
+    }
+
+    size_t count = 0;
+    portENTER_CRITICAL(&crash_log.lock);
+    {
+        /* Walk from the oldest slot so the output is already in order */
+        const uint32_t end = crash_log.next_seq;
+        const uint32_t start = (end > MICROUSC_CRASH_LOG_SIZE) ? end - MICROUSC_CRASH_LOG_SIZE : 0;
+        for (uint32_t seq = start; seq != end && count < max; seq++) {
+            const microusc_crash_record_t *record = &crash_ring.records[seq & (MICROUSC_CRASH_LOG_SIZE - 1)];
+            if (record->seq == seq && record->boot == crash_ring.boot && record_valid(record)) {
+                records[count++] = *record;
+            }
+        }
+    }
+    portEXIT_CRITICAL(&crash_log.lock);
+    return count;
+}
+
+esp_reset_reason_t microusc_crash_log_reset_reason(void)
+{
+    return crash_log.reset_reason;
+}
+
+static const char *crash_type_str(uint8_t type)
+{
+    switch (type) {
+        case MICROUSC_CRASH_BOOT:          return "BOOT";
+        case MICROUSC_CRASH_EVENT:         return "EVENT";
+        case MICROUSC_CRASH_ERROR:         return "ERROR";
+        case MICROUSC_CRASH_DRIVER_STATUS: return "DRIVER_STATUS";
+        case MICROUSC_CRASH_HANG:          return "HANG";
+        default:                           return "UNKNOWN";
+    }
+}
+
+void microusc_crash_log_print(void)
+{
+    ESP_LOGW(TAG, "Reset reason %d, %u record(s) from the previous run",
+             (int)crash_log.reset_reason, (unsigned)crash_log.previous_count);
+
+    for (size_t i = 0; i < crash_log.previous_count; i++) {
+        const microusc_crash_record_t *record = &crash_log.previous[i];
+        printf("  %8" PRIu32 " ms  %-13s code %3u  source %3u  value 0x%08" PRIx32 "\n",
+               record->timestamp_ms, crash_type_str(record->type),
+               record->code, record->source, record->value);
+    }
+}
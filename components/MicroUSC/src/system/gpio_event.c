@@ -0,0 +1,173 @@
+#include "MicroUSC/internal/system/gpio_event.h"
+#include "MicroUSC/internal/system/event_queue.h"
+#include "MicroUSC/system/manager.h"
+#include "freertos/FreeRTOS.h"
+#include "esp_timer.h"
+#include "esp_attr.h"
+#include "esp_log.h"
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <string.h>
+
+#define TAG "[MICROUSC GPIO]"
+
+#define PENDING_WORDS ( (GPIO_NUM_MAX + 31) / 32 )
+
+struct gpio_event_entry {
+    microusc_gpio_event_t event;
+    int64_t last_edge_us;    // ISR only
+    _Atomic uint32_t edges;  // accepted edges not yet delivered
+    bool used;
+};
+
+static struct {
+    struct gpio_event_entry table[GPIO_NUM_MAX]; // indexed by pin number
+    _Atomic uint32_t pending[PENDING_WORDS];     // bit per pin with undelivered edges
+    bool initialized;
+    portMUX_TYPE lock;                           // guards the mappings against the system task
+} gpio_events = {
+    .lock = portMUX_INITIALIZER_UNLOCKED,
+};
+
+static void IRAM_ATTR gpio_event_isr(void *arg)
+{
+    const uint32_t pin = (uint32_t)(uintptr_t)arg;
+    struct gpio_event_entry *entry = &gpio_events.table[pin];
+
+    const int64_t now = esp_timer_get_time();
+    if (now - entry->last_edge_us < (int64_t)entry->event.debounce_us) {
+        return; /* bounce */
+    }
+    entry->last_edge_us = now;
+    atomic_fetch_add_explicit(&entry->edges, 1, memory_order_relaxed);
+
+    /* Only the first edge of a batch wakes the system task */
+    const uint32_t bit = 1UL << (pin & 31);
+    const uint32_t before = atomic_fetch_or_explicit(&gpio_events.pending[pin >> 5], bit, memory_order_release);
+    if (before & bit) {
+        return;
+    }
+
+    BaseType_t higher_priority_task_woken = pdFALSE;
+    microusc_event_queue_signal(MICROUSC_EVENT_SIGNAL_GPIO, &higher_priority_task_woken);
+    portYIELD_FROM_ISR(higher_priority_task_woken);
+}
+
+esp_err_t microusc_gpio_event_init(void)
+{
+    const esp_err_t ret = gpio_install_isr_service(0);
+    if (ret != ESP_OK && ret != ESP_ERR_INVALID_STATE) { /* INVALID_STATE: already installed by the application */
+        ESP_LOGE(TAG, "Could not install the GPIO ISR service: %s", esp_err_to_name(ret));
+        return ret;
+    }
+    gpio_events.initialized = true;
+    return ESP_OK;
+}
+
+/**
+ * @brief Detach a pin's handler and forget its mapping. Safe to call for unregistered pins.
+ */
+static void gpio_event_detach(gpio_num_t pin)
+{
+    struct gpio_event_entry *entry = &gpio_events.table[pin];
+    if (entry->used) {
+        gpio_isr_handler_remove(pin); /* no ISR for this pin runs after this returns */
+    }
+
+    portENTER_CRITICAL(&gpio_events.lock);
+    entry->used = false;
+    atomic_store_explicit(&entry->edges, 0, memory_order_relaxed);
+    portEXIT_CRITICAL(&gpio_events.lock);
+}
+
+esp_err_t microusc_gpio_event_register(const gpio_config_t *io_config, const microusc_gpio_event_t *event)
+{
+    if (io_config == NULL || event == NULL || io_config->pin_bit_mask == 0 ||
+        io_config->intr_type == GPIO_INTR_DISABLE ||
+        (event->callback == NULL && (uint32_t)event->status >= USC_SYSTEM_STATUS_MAX)) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if ((io_config->pin_bit_mask >> GPIO_NUM_MAX) != 0) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (!gpio_events.initialized) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    for (int pin = 0; pin < GPIO_NUM_MAX; pin++) {
+        if (io_config->pin_bit_mask & (1ULL << pin)) {
+            gpio_event_detach((gpio_num_t)pin);
+        }
+    }
+
+    esp_err_t ret = gpio_config(io_config);
+    if (ret != ESP_OK) {
+        return ret;
+    }
+
+    for (int pin = 0; pin < GPIO_NUM_MAX; pin++) {
+        if ((io_config->pin_bit_mask & (1ULL << pin)) == 0) {
+            continue;
+        }
+
+        struct gpio_event_entry *entry = &gpio_events.table[pin];
+        portENTER_CRITICAL(&gpio_events.lock);
+        entry->event = *event;
+        entry->last_edge_us = INT64_MIN / 2; /* the first edge is never filtered */
+        entry->used = true;
+        portEXIT_CRITICAL(&gpio_events.lock);
+
+        /* The pin number itself is the ISR argument, nothing on the caller's stack */
+        ret = gpio_isr_handler_add((gpio_num_t)pin, gpio_event_isr, (void *)(uintptr_t)pin);
+        if (ret != ESP_OK) {
+            ESP_LOGE(TAG, "Could not attach GPIO %d: %s", pin, esp_err_to_name(ret));
+            portENTER_CRITICAL(&gpio_events.lock);
+            entry->used = false;
+            portEXIT_CRITICAL(&gpio_events.lock);
+            return ret;
+        }
+    }
+    return ESP_OK;
+}
+
+esp_err_t microusc_gpio_event_unregister(gpio_num_t pin)
+{
+    if (!GPIO_IS_VALID_GPIO(pin) || !gpio_events.table[pin].used) {
+        return ESP_ERR_NOT_FOUND;
+    }
+    gpio_event_detach(pin);
+    return ESP_OK;
+}
+
+void microusc_gpio_event_dispatch(void)
+{
+    for (int word = 0; word < PENDING_WORDS; word++) {
+        uint32_t bits = atomic_exchange_explicit(&gpio_events.pending[word], 0, memory_order_acquire);
+
+        while (bits != 0) {
+            const int pin = word * 32 + __builtin_ctz(bits);
+            bits &= bits - 1;
+
+            struct gpio_event_entry *entry = &gpio_events.table[pin];
+            microusc_gpio_event_t event;
+            bool used;
+
+            portENTER_CRITICAL(&gpio_events.lock);
+            used = entry->used;
+            event = entry->event;
+            portEXIT_CRITICAL(&gpio_events.lock);
+
+            const uint32_t edges = atomic_exchange_explicit(&entry->edges, 0, memory_order_relaxed);
+            if (!used || edges == 0) {
+                continue;
+            }
+
+            if (event.callback != NULL) {
+                event.callback((gpio_num_t)pin, edges, gpio_get_level((gpio_num_t)pin), event.ctx);
+            }
+            else {
+                send_microusc_system_status(event.status); /* handled later in this same drain */
+            }
+        }
+    }
+}
@@ -1,14 +1,23 @@
 #include "MicroUSC/internal/system/init.h"
 #include "MicroUSC/internal/system/service_def.h"
+#include "MicroUSC/internal/system/event_queue.h"
+#include "MicroUSC/internal/system/work_queue.h"
+#include "MicroUSC/internal/system/gpio_event.h"
+#include "MicroUSC/internal/system/crash_log.h"
+#include "MicroUSC/internal/system/rtc.h"
+#include "MicroUSC/internal/system/warm_boot.h"
+#include "MicroUSC/internal/system/boot.h"
+#include "MicroUSC/internal/system/sleep.h"
+#include "MicroUSC/internal/system/persist.h"
 #include "MicroUSC/internal/USC_driver_config.h"
 #include "MicroUSC/internal/driverList.h"
 #include "MicroUSC/chip_specific/system_attr.h"
 #include "MicroUSC/system/manager.h"
 #include "MicroUSC/system/status.h"
 #include "MicroUSC/USCdriver.h"
-#include "esp_debug_helpers.h"
 #include "esp_system.h"
-#include <esp_task_wdt.h>
+#include "esp_timer.h"
+#include "freertos/semphr.h"
 #include "esp_intr_alloc.h"
 #include "esp_attr.h"
 #include "stdint.h"
@@ -30,9 +39,7 @@
 
 #define INTERNAL_TASK_STACK_SIZE (4096) // Stack size for the system task, increase the size in the future for development
 
-#define WDT_TIMER_WAIT 3
-
-#define WDT_TIMER_DELAY pdMS_TO_TICKS(1)
+#define ERROR_CONTEXT_INLINE_SIZE (32) // error handler contexts up to this size need no heap
 
 #define microusc_system_operation(topic, status, func, key, data) do { \
     send_to_mqtt_service_single(topic, key, data); \
@@ -47,7 +54,6 @@
 
 #define microusc_pause_drivers() usc_drivers_pause()
 #define microusc_resume_drivers() usc_drivers_resume()
-#define microusc_queue_flush() xQueueReset(microusc_system.queue_system.queue_handler);
 
 #define microusc_system_mqtt_main(topic, status, func, key, data) microusc_system_operation(topic, status, func, key, data)
 
@@ -59,14 +65,16 @@ struct {
         StaticTask_t taskBuffer;
         TaskHandle_t main_task;
     } task;
-    struct {
-        QueueHandle_t queue_handler;
-        size_t count;
-    } queue_system;
     struct {
         microusc_error_handler operation;
         void *stored_var;
-        int size;
+        size_t size;
+        uint8_t *scratch;          // size bytes, handed to the handler; allocated at registration
+        uint8_t *retired;          // scratch replaced from inside the handler, freed after it returns
+        bool running;
+        uint8_t inline_scratch[ERROR_CONTEXT_INLINE_SIZE];
+        SemaphoreHandle_t lock;    // recursive, so the handler may register a new handler
+        StaticSemaphore_t lock_buffer;
     } error_handler;
     portMUX_TYPE critical_lock;
 } microusc_system;
@@ -77,13 +85,6 @@ struct {
     portEXIT_CRITICAL(&microusc_system.critical_lock); \
 } while(0)
 
-void IRAM_ATTR microusc_software_isr_handler(void *arg)
-{
-    MiscrouscBackTrack_t current;
-    current.status = *(microusc_status *)arg;
-    xQueueSendFromISR(microusc_system.queue_system.queue_handler, &current, NULL);
-}
-
 /* Add on the next version */
 __deprecated void microusc_system_isr_trigger(void) 
 {
@@ -92,24 +93,15 @@ __deprecated void microusc_system_isr_trigger(void)
 
 void microusc_system_isr_pin(gpio_config_t io_config, microusc_status trigger_status)
 {
-    int bit_mask = io_config.pin_bit_mask;
-    int gpio_pin = 1;
-
-    /* Determine the GPIO pin number from the bit mask */
-    if (bit_mask == 0) return;
-    while (bit_mask > 1) {
-        bit_mask >>= 1;
-        gpio_pin++;
+    const microusc_gpio_event_t event = {
+        .status = trigger_status,
+        .debounce_us = MICROUSC_GPIO_DEBOUNCE_US_DEFAULT,
+    };
+
+    const esp_err_t ret = microusc_gpio_event_register(&io_config, &event);
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "Could not map GPIO interrupt to status %d: %s", trigger_status, esp_err_to_name(ret));
     }
-
-    /* Remove any existing ISR handler for this pin */
-    gpio_isr_handler_remove((gpio_num_t)gpio_pin);
-
-    /* Configure the GPIO pin with the provided settings */
-    gpio_config(&io_config);
-
-    /* Add the new ISR handler for this pin */
-    gpio_isr_handler_add((gpio_num_t)gpio_pin, microusc_software_isr_handler, &gpio_pin);
 }
 
 /*
@@ -126,21 +118,29 @@ MqttMaintainerHandler microusc_system_start_mqtt_service(esp_mqtt_client_config_
 */
 __attribute__((noreturn)) void microusc_system_restart(void)
 {
+    microusc_persist_flush();
     esp_restart();
 }
 
-static void getBackPCprevious(MiscrouscBackTrack_t *backtrack, const size_t amount) 
+/**
+ * @brief Turn a raw return address into the address of the call instruction.
+ *
+ * Runs on the system task so posting only has to store __builtin_return_address(0).
+ * On Xtensa the top two bits of a return address hold the caller's window size.
+ */
+static uint32_t microusc_decode_caller_pc(uint32_t pc)
 {
-    esp_backtrace_frame_t frame;
-    
-    // Get the starting frame
-    esp_backtrace_get_start(&frame.pc, &frame.sp, &frame.next_pc);
-    // get the one that called this function
-    for (int i = 0; i < amount && frame.next_pc != 0; i++) {
-        esp_backtrace_get_next_frame(&frame);
+    if (pc == 0) {
+        return 0;
     }
-
-    backtrack->type.caller_pc = (uint32_t)frame.pc;
+#ifdef __XTENSA__
+    if (pc & 0x80000000) {
+        pc = (pc & 0x3fffffff) | 0x40000000;
+    }
+    return pc - 3; /* size of a CALLx instruction */
+#else
+    return pc - 4;
+#endif
 }
 
 static void microusc_system_error_handler_default(void *var)
@@ -154,16 +154,57 @@ static void microusc_system_error_handler_default(void *var)
     microusc_system_restart();
 }
 
-void set_microusc_system_error_handler(microusc_error_handler handler, void *var, int size)
+/* Created on first use, so a handler may be registered before init_MicroUSC_system() */
+static SemaphoreHandle_t error_handler_lock(void)
 {
-    #ifdef MICROUSC_DEBUG
+    if (microusc_system.error_handler.lock == NULL) {
+        error_handler_lock();
+    }
+    return microusc_system.error_handler.lock;
+}
+
+esp_err_t set_microusc_system_error_handler(microusc_error_handler handler, void *var, int size)
+{
+    if (size < 0 || (size > 0 && var == NULL)) {
+        return ESP_ERR_INVALID_ARG;
+    }
     if (handler == NULL) {
-        send_microusc_system_status(USC_SYSTEM_ERROR);
+        ESP_LOGW(TAG, "No error handler given, using the default one");
+        handler = microusc_system_error_handler_default;
+        size = 0;
     }
-    #endif
-    microusc_system.error_handler.operation = handler;
-    microusc_system.error_handler.stored_var = var;
-    microusc_system.error_handler.size = size;
+
+    /* Allocate now, while the heap is healthy, so the error path never has to */
+    uint8_t *scratch = microusc_system.error_handler.inline_scratch;
+    if (size > ERROR_CONTEXT_INLINE_SIZE) {
+        scratch = heap_caps_malloc(size, MALLOC_CAP_8BIT);
+        if (scratch == NULL) {
+            ESP_LOGE(TAG, "Could not allocate %d bytes for the error handler context", size);
+            return ESP_ERR_NO_MEM;
+        }
+    }
+
+    uint8_t *old = NULL;
+    xSemaphoreTakeRecursive(error_handler_lock(), portMAX_DELAY);
+    {
+        if (microusc_system.error_handler.scratch != microusc_system.error_handler.inline_scratch) {
+            old = microusc_system.error_handler.scratch;
+        }
+        if (microusc_system.error_handler.running && old != NULL) {
+            /* Called from the handler itself, which still uses the old buffer */
+            heap_caps_free(microusc_system.error_handler.retired);
+            microusc_system.error_handler.retired = old;
+            old = NULL;
+        }
+        microusc_system.error_handler.operation = handler;
+        microusc_system.error_handler.stored_var = var;
+        microusc_system.error_handler.size = (size_t)size;
+        microusc_system.error_handler.scratch = scratch;
+    }
+    xSemaphoreGiveRecursive(microusc_system.error_handler.lock);
+
+    heap_caps_free(old);
+    return ESP_OK;
 }
 
 void set_microusc_system_error_handler_default(void)
@@ -171,120 +212,144 @@ void set_microusc_system_error_handler_default(void)
     set_microusc_system_error_handler(microusc_system_error_handler_default, NULL, 0);
 }
 
-void send_microusc_system_status(microusc_status code)
+/* Every post is a single lock-free push; the PC is decoded later by the system task */
+static __always_inline void IRAM_ATTR microusc_post_status(microusc_status code, uint32_t caller_pc, BaseType_t *higher_priority_task_woken)
 {
-    /* this only runs if the task is not suspended due to flushing the queue at the meantime */
-    if (eTaskGetState(microusc_system.task.main_task) != eSuspended) {
-        MiscrouscBackTrack_t data;
-        data.status = code;
+    MiscrouscBackTrack_t data;
+    data.status = code;
+    data.type.caller_pc = (code == USC_SYSTEM_ERROR || code == USC_SYSTEM_PRINT_SUCCUSS) ? caller_pc : 0;
+    data.repeat = 0;
 
-        if (code == USC_SYSTEM_ERROR || code == USC_SYSTEM_PRINT_SUCCUSS) {
-            getBackPCprevious(&data, 1);
-        }
+    /* Errors and power events go ahead of LED and status requests, duplicates are merged */
+    microusc_event_queue_push(&data, higher_priority_task_woken);
+}
 
-        if (uxQueueSpacesAvailable(microusc_system.queue_system.queue_handler) != 0) {
-            taskENTER_CRITICAL(&microusc_system.critical_lock);
-            {
-                microusc_system.queue_system.count = 0;
-            }
-            taskEXIT_CRITICAL(&microusc_system.critical_lock);
-            xQueueSend(microusc_system.queue_system.queue_handler, &data, 0);
-        }
-        else {
-            ESP_LOGW(TAG, "MicroUSC system queuehandler has overflowed");
-            taskENTER_CRITICAL(&microusc_system.critical_lock);
-            {
-                microusc_system.queue_system.count++;
-                if (microusc_system.queue_system.count == 3) {
-                    microusc_queue_flush();
-                }
-            }
-            taskEXIT_CRITICAL(&microusc_system.critical_lock);
-        }
-    }
+__attribute__((noinline)) void IRAM_ATTR send_microusc_system_status(microusc_status code)
+{
+    microusc_post_status(code, (uint32_t)(uintptr_t)__builtin_return_address(0), NULL);
+}
+
+__attribute__((noinline)) void IRAM_ATTR send_microusc_system_status_from_isr(microusc_status code, BaseType_t *higher_priority_task_woken)
+{
+    microusc_post_status(code, (uint32_t)(uintptr_t)__builtin_return_address(0), higher_priority_task_woken);
+}
+
+void microusc_system_event_stats(microusc_status code, microusc_event_stats_t *stats)
+{
+    microusc_event_queue_stats(code, &stats->coalesced, &stats->dropped);
 }
 
 static void call_usc_error_handler(uint32_t pc)
 {
-    microusc_error_handler func;
-    void *tmp = 0;
-    ESP_LOGE(TAG, "Called from two levels back: 0x%08" PRIx32, pc);
-    portENTER_CRITICAL(&microusc_system.critical_lock); 
+    ESP_LOGE(TAG, "Error posted from: 0x%08" PRIx32, pc);
+
+    /*
+     * No allocation and interrupts stay enabled. The handler runs with the lock held, so
+     * a registration from another task waits until it returns; the handler itself may
+     * register, the lock is recursive.
+     */
+    xSemaphoreTakeRecursive(microusc_system.error_handler.lock, portMAX_DELAY);
     {
-        const int var_size = microusc_system.error_handler.size;
-        func = microusc_system.error_handler.operation;
-
+        void *ctx = NULL;
+        const size_t var_size = microusc_system.error_handler.size;
         if (var_size != 0) {
-            tmp = heap_caps_malloc(var_size, MALLOC_CAP_8BIT | MALLOC_CAP_DMA);
-            memcpy(tmp, microusc_system.error_handler.stored_var, var_size);
+            ctx = microusc_system.error_handler.scratch;
+            memcpy(ctx, microusc_system.error_handler.stored_var, var_size);
         }
+
+        microusc_system.error_handler.running = true;
+        microusc_system.error_handler.operation(ctx);
+        microusc_system.error_handler.running = false;
+
+        heap_caps_free(microusc_system.error_handler.retired);
+        microusc_system.error_handler.retired = NULL;
     }
-    portEXIT_CRITICAL(&microusc_system.critical_lock);
-    func(tmp);
+    xSemaphoreGiveRecursive(microusc_system.error_handler.lock);
+}
 
-    if (tmp != NULL) {
-        heap_caps_free(tmp);
+/**
+ * @brief Carry out one system event on the system task.
+ *
+ * @param sys_data Event taken from the system event queue.
+ */
+static void microusc_system_handle_event(const MiscrouscBackTrack_t *sys_data)
+{
+    MICROUSC_TRACE(MICROUSC_TRACE_SYSTEM_EVENT, MICROUSC_TRACE_NO_DRIVER, sys_data->status, sys_data->repeat);
+    microusc_crash_log_record(MICROUSC_CRASH_EVENT, (uint8_t)sys_data->status, 0, sys_data->repeat);
+    switch(sys_data->status) {
+        case USC_SYSTEM_OFF:
+            microusc_system_restart();
+            break;
+        case USC_SYSTEM_SLEEP:
+            builtin_led_system(USC_SYSTEM_SLEEP);
+            sleep_mode();
+            break;
+        case USC_SYSTEM_PAUSE:
+            builtin_led_system(USC_SYSTEM_PAUSE);
+            microusc_pause_drivers();
+            //microusc_system_mqtt_main(CONNECTION_MQTT_SEND_INFO, sys_data->status, microusc_pause_drivers(), "status", "pause");
+            break;
+        case USC_SYSTEM_RESUME:
+            builtin_led_system(USC_SYSTEM_RESUME);
+            microusc_resume_drivers();
+            //microusc_system_mqtt_main(CONNECTION_MQTT_SEND_INFO, sys_data->status, microusc_resume_drivers(), "status", "normal");
+            break;
+        case USC_SYSTEM_WIFI_CONNECT:
+            builtin_led_system(USC_SYSTEM_WIFI_CONNECT);
+            // conflicting feature
+            break;
+        case USC_SYSTEM_BLUETOOTH_CONNECT:
+            builtin_led_system(USC_SYSTEM_BLUETOOTH_CONNECT);
+            // conflicting feature
+            break;
+        case USC_SYSTEM_LED_ON:
+            ESP_LOGI(TAG, "Turning on led...");
+            builtin_led_system(USC_SYSTEM_LED_ON);
+            break;
+        case USC_SYSTEM_LED_OFF:
+            ESP_LOGI(TAG, "Turning off led...");
+            builtin_led_system(USC_SYSTEM_LED_OFF);
+            break;
+        case USC_SYSTEM_MEMORY_USAGE:
+            show_memory_usage();
+            break;
+        case USC_SYSTEM_SPECIFICATIONS:
+            print_system_info();
+            break;
+        case USC_SYSTEM_DRIVER_STATUS:
+            usc_print_driver_configurations();
+            break;
+        case USC_SYSTEM_ERROR:
+            builtin_led_system(USC_SYSTEM_ERROR);
+            if (sys_data->repeat != 0) {
+                ESP_LOGW(TAG, "%u more error report(s) merged into this one", (unsigned)sys_data->repeat);
+            }
+            {
+                const uint32_t pc = microusc_decode_caller_pc(sys_data->type.caller_pc);
+                microusc_crash_log_record(MICROUSC_CRASH_ERROR, (uint8_t)sys_data->status, 0, pc); /* kept across the reboot */
+                call_usc_error_handler(pc);
+            }
+            //microusc_system_mqtt_main_fast(CONNECTION_MQTT_SEND_INFO, call_usc_error_handler(sys_data->type.caller_pc), "status", "error");
+            break;
+        default:
+            break;
     }
 }
 
 static void microusc_system_task(void *p)
 {
     MiscrouscBackTrack_t sys_data;
+    microusc_ready_set(MICROUSC_READY_SYSTEM_TASK);
     while (1) {
-        if (xQueueReceive(microusc_system.queue_system.queue_handler, &sys_data, portMAX_DELAY) == pdPASS) {
-            printf("Called microUSC system\n");
-            switch(sys_data.status) {
-                case USC_SYSTEM_OFF:
-                    microusc_system_restart();
-                    break;
-                case USC_SYSTEM_SLEEP:
-                    builtin_led_system(USC_SYSTEM_SLEEP);
-                    sleep_mode();
-                    break;
-                case USC_SYSTEM_PAUSE:
-                    builtin_led_system(USC_SYSTEM_PAUSE);
-                    microusc_pause_drivers();
-                    //microusc_system_mqtt_main(CONNECTION_MQTT_SEND_INFO, sys_data.status, microusc_pause_drivers(), "status", "pause");
-                    break;
-                case USC_SYSTEM_RESUME:
-                    builtin_led_system(USC_SYSTEM_RESUME);
-                    microusc_resume_drivers();
-                    //microusc_system_mqtt_main(CONNECTION_MQTT_SEND_INFO, sys_data.status, microusc_resume_drivers(), "status", "normal");
-                    break;
-                case USC_SYSTEM_WIFI_CONNECT:
-                    builtin_led_system(USC_SYSTEM_WIFI_CONNECT);
-                    // conflicting feature
-                    break;
-                case USC_SYSTEM_BLUETOOTH_CONNECT:
-                    builtin_led_system(USC_SYSTEM_BLUETOOTH_CONNECT);
-                    // conflicting feature
-                    break;
-                case USC_SYSTEM_LED_ON:
-                    ESP_LOGI(TAG, "Turning on led...");
-                    builtin_led_system(USC_SYSTEM_LED_ON);
-                    break;
-                case USC_SYSTEM_LED_OFF:
-                    ESP_LOGI(TAG, "Turning off led...");
-                    builtin_led_system(USC_SYSTEM_LED_OFF);
-                    break;
-                case USC_SYSTEM_MEMORY_USAGE:
-                    show_memory_usage();
-                    break;
-                case USC_SYSTEM_SPECIFICATIONS:
-                    print_system_info();
-                    break;
-                case USC_SYSTEM_DRIVER_STATUS:
-                    usc_print_driver_configurations();
-                    break;
-                case USC_SYSTEM_ERROR:
-                    builtin_led_system(USC_SYSTEM_ERROR);
-                    call_usc_error_handler(sys_data.type.caller_pc);
-                    //microusc_system_mqtt_main_fast(CONNECTION_MQTT_SEND_INFO, call_usc_error_handler(sys_data.type.caller_pc), "status", "error");
-                    break;
-                default:
-                    break;
-            }
+        /* Sleep until an event is posted or the next work item is due */
+        microusc_event_queue_wait(microusc_work_next_timeout());
+        if (microusc_event_queue_take_signals() & MICROUSC_EVENT_SIGNAL_GPIO) {
+            microusc_gpio_event_dispatch(); /* may post statuses, drained just below */
+        }
+        while (microusc_event_queue_pop(&sys_data)) {
+            microusc_system_handle_event(&sys_data);
         }
+        microusc_work_run_due();
     }
 }
 
@@ -297,14 +362,21 @@ __attribute__((noreturn)) void microusc_infloop(void)
 
 static esp_err_t microusc_system_setup(void)
 {
-    gpio_install_isr_service(0);
     microusc_system.critical_lock = (portMUX_TYPE)portMUX_INITIALIZER_UNLOCKED;
-
-    microusc_system.queue_system.queue_handler = xQueueCreate(MICROUSC_QUEUEHANDLE_SIZE, sizeof(MiscrouscBackTrack_t));
-    if (microusc_system.queue_system.queue_handler == NULL) {
-        return ESP_ERR_NO_MEM;
+    microusc_system.error_handler.lock = xSemaphoreCreateRecursiveMutexStatic(&microusc_system.error_handler.lock_buffer);
+
+    microusc_crash_log_init(); /* first, so the previous run's records are saved before anything is logged */
+    microusc_rtc_store_init();
+    microusc_sleep_init();
+    microusc_event_queue_init(NULL); /* consumer is set once the system task exists */
+    esp_err_t ret = microusc_work_init();
+    if (ret != ESP_OK) {
+        return ret;
+    }
+    ret = microusc_gpio_event_init();
+    if (ret != ESP_OK) {
+        return ret;
     }
-    microusc_system.queue_system.count = 0;
 
     #ifdef BUILTIN_LED_ASSEMBLY
     init_builtin_led();
@@ -313,7 +385,9 @@ static esp_err_t microusc_system_setup(void)
     set_rtc_cycle();
 
     sleep_mode_wakeup_default();
-    set_microusc_system_error_handler_default(); /* Set the default error handler */
+    if (microusc_system.error_handler.operation == NULL) {
+        set_microusc_system_error_handler_default(); /* unless one was registered before init */
+    }
 
     xTaskCreatePinnedToCore(
         microusc_system_task,
@@ -324,13 +398,43 @@ static esp_err_t microusc_system_setup(void)
         &microusc_system.task.main_task,
         MICROUSC_CORE
     );
+    if (microusc_system.task.main_task == NULL) {
+        return ESP_ERR_NO_MEM;
+    }
+    microusc_event_queue_set_consumer(microusc_system.task.main_task);
 
     return ESP_OK;
 }
 
 void init_MicroUSC_system(void) 
 {
+    const int64_t start = esp_timer_get_time();
+    int64_t t = start;
+    microusc_ready_init();
+
     ESP_ERROR_CHECK(init_system_memory_space()); /* Initialize memory pools for the system */
+    microusc_boot_profile_stage(MICROUSC_BOOT_MEMORY, (uint32_t)(esp_timer_get_time() - t));
+
+    t = esp_timer_get_time();
     ESP_ERROR_CHECK(microusc_system_setup()); /* system task will run on core 0, mandatory */
-    vTaskDelay(500 / portTICK_PERIOD_MS); /* Wait for the system to be ready (500 milliseconds) */
+    microusc_boot_profile_stage(MICROUSC_BOOT_SETUP, (uint32_t)(esp_timer_get_time() - t));
+
+    t = esp_timer_get_time();
+    if (microusc_ready_wait(MICROUSC_READY_SYSTEM_TASK, MICROUSC_READY_SYSTEM_TIMEOUT) != ESP_OK) {
+        ESP_LOGW(TAG, "System task has not started yet");
+    }
+    microusc_boot_profile_stage(MICROUSC_BOOT_SYSTEM_TASK, (uint32_t)(esp_timer_get_time() - t));
+
+    t = esp_timer_get_time();
+    microusc_persist_init(); /* before any driver, so they are installed with their learned stack */
+    microusc_boot_profile_stage(MICROUSC_BOOT_PERSIST, (uint32_t)(esp_timer_get_time() - t));
+
+    t = esp_timer_get_time();
+    microusc_warm_boot_resume();
+    microusc_boot_profile_stage(MICROUSC_BOOT_WARM_BOOT, (uint32_t)(esp_timer_get_time() - t));
+
+    microusc_boot_profile_stage(MICROUSC_BOOT_TOTAL, (uint32_t)(esp_timer_get_time() - start));
+    #ifdef MICROUSC_DEBUG
+    microusc_print_boot_profile();
+    #endif
 }
\ No newline at end of file
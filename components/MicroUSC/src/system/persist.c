@@ -0,0 +1,649 @@
+#include "MicroUSC/internal/system/persist.h"
+#include "MicroUSC/internal/system/work_queue.h"
+#include "MicroUSC/internal/driverList.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include "nvs_flash.h"
+#include "nvs.h"
+#include "esp_app_desc.h"
+#include "esp_attr.h"
+#include "esp_rom_crc.h"
+#include "esp_timer.h"
+#include "esp_log.h"
+#include <inttypes.h>
+#include <stddef.h>
+#include <string.h>
+#include <sys/time.h>
+
+#define TAG "[PERSIST]"
+
+#define PERSIST_NAMESPACE   "microusc"
+#define PERSIST_SYSTEM_KEY  "system"
+#define PERSIST_DRIVERS_KEY "drivers"
+#define PERSIST_CRASHES_KEY "crashes"
+#define PERSIST_IMAGE_KEY   "image"
+#define PERSIST_IMAGE_SIZE  ( 8 ) // bytes of the app ELF SHA-256 the stack peaks were measured on
+#define PERSIST_NO_SLOT     ( -1 )
+#define PERSIST_LOCK_WAIT   pdMS_TO_TICKS(1000)
+#define PERSIST_CARRY_MAGIC ( 0x50435259 ) // "PCRY"
+
+_Static_assert(MICROUSC_PERSIST_NAME_SIZE == DRIVER_NAME_SIZE, "persisted names are driver names");
+
+/* Blobs are loaded only when their size matches, so a layout change starts them over */
+typedef struct {
+    uint32_t count;
+    microusc_persist_crash_t crashes[MICROUSC_PERSIST_CRASHES]; // oldest first
+} crash_blob_t;
+
+static struct {
+    nvs_handle_t nvs;
+    bool open;
+    bool system_dirty;
+    bool drivers_dirty;
+    microusc_persist_system_t system;
+    microusc_persist_driver_t drivers[MICROUSC_PERSIST_DRIVERS]; // unused while name[0] is 0
+    crash_blob_t crashes;
+    struct {
+        int slot;                         // in drivers[], PERSIST_NO_SLOT if not installed
+        microusc_persist_counters_t base; // live counters already added to the totals
+    } live[DRIVER_MAX];
+    int64_t uptime_mark_us;               // esp_timer time already added to uptime_s
+    uint64_t written_us;                  // wall-clock time flash was last brought up to date
+    SemaphoreHandle_t lock;               // after driver_system.lock when both are taken
+    StaticSemaphore_t lock_buffer;
+} persist;
+
+/*
+ * The RAM image while a deep sleep skips the flash write, so a duty-cycled device
+ * writes flash once per MICROUSC_PERSIST_FLUSH_MS instead of on every wake-up.
+ * Only trusted on a deep-sleep wake.
+ */
+typedef struct {
+    uint32_t magic;
+    uint8_t drivers_dirty;     // the system blob is always due after a wake-up
+    uint8_t reserved[3];
+    uint32_t uptime_rest_us;   // run time not yet in uptime_s
+    uint64_t written_us;
+    microusc_persist_system_t system;
+    microusc_persist_driver_t drivers[MICROUSC_PERSIST_DRIVERS];
+    uint32_t crc;              // CRC32 of the fields above
+} persist_carry_t;
+
+RTC_NOINIT_ATTR static persist_carry_t carry;
+
+static __always_inline uint32_t carry_crc(void)
+{
+    return esp_rom_crc32_le(0, (const uint8_t *)&carry, offsetof(persist_carry_t, crc));
+}
+
+/* Survives software resets and deep sleep, unlike esp_timer_get_time() */
+static uint64_t now_us(void)
+{
+    struct timeval tv;
+    gettimeofday(&tv, NULL);
+    return (uint64_t)tv.tv_sec * 1000000ULL + (uint64_t)tv.tv_usec;
+}
+
+static bool load_blob(const char *key, void *blob, size_t size)
+{
+    size_t stored = size;
+    const esp_err_t ret = nvs_get_blob(persist.nvs, key, blob, &stored);
+    if (ret == ESP_OK && stored == size) {
+        return true;
+    }
+    if (ret != ESP_ERR_NVS_NOT_FOUND) {
+        ESP_LOGW(TAG, "Discarding saved %s: %s", key, (ret == ESP_OK) ? "layout changed" : esp_err_to_name(ret));
+    }
+    memset(blob, 0, size);
+    return false;
+}
+
+static esp_err_t open_partition(void)
+{
+    esp_err_t ret = nvs_flash_init_partition(MICROUSC_PERSIST_PARTITION);
+    if (ret == ESP_ERR_NVS_NO_FREE_PAGES || ret == ESP_ERR_NVS_NEW_VERSION_FOUND) {
+        ESP_LOGW(TAG, "Partition %s is unreadable, erasing it", MICROUSC_PERSIST_PARTITION);
+        nvs_flash_erase_partition(MICROUSC_PERSIST_PARTITION);
+        ret = nvs_flash_init_partition(MICROUSC_PERSIST_PARTITION);
+    }
+    if (ret != ESP_OK) {
+        return ret;
+    }
+    return nvs_open_from_partition(MICROUSC_PERSIST_PARTITION, PERSIST_NAMESPACE, NVS_READWRITE, &persist.nvs);
+}
+
+static __always_inline bool is_crash(const esp_reset_reason_t reason)
+{
+    return reason == ESP_RST_PANIC || reason == ESP_RST_INT_WDT || reason == ESP_RST_TASK_WDT ||
+           reason == ESP_RST_WDT || reason == ESP_RST_BROWNOUT;
+}
+
+/**
+ * @brief Keep the end of the previous run's crash log, replacing the oldest summary.
+ */
+static void save_crash(const esp_reset_reason_t reason)
+{
+    crash_blob_t *blob = &persist.crashes;
+    if (blob->count >= MICROUSC_PERSIST_CRASHES) {
+        memmove(&blob->crashes[0], &blob->crashes[1], sizeof(blob->crashes[0]) * (MICROUSC_PERSIST_CRASHES - 1));
+        blob->count = MICROUSC_PERSIST_CRASHES - 1;
+    }
+    microusc_persist_crash_t *crash = &blob->crashes[blob->count++];
+    memset(crash, 0, sizeof(*crash));
+    crash->boot = persist.system.boots - 1;
+    crash->reason = (uint8_t)reason;
+
+    static microusc_crash_record_t records[MICROUSC_CRASH_LOG_SIZE]; /* only used once, at boot */
+    const size_t count = microusc_crash_log_read(true, records, MICROUSC_CRASH_LOG_SIZE);
+    const size_t keep = (count < MICROUSC_PERSIST_CRASH_RECORDS) ? count : MICROUSC_PERSIST_CRASH_RECORDS;
+    memcpy(crash->records, &records[count - keep], keep * sizeof(records[0]));
+    crash->count = (uint8_t)keep;
+
+    persist.system.crashes++;
+    nvs_set_blob(persist.nvs, PERSIST_CRASHES_KEY, blob, sizeof(*blob));
+}
+
+static void read_live(const struct usc_driver_t *driver, microusc_persist_counters_t *c)
+{
+    const struct usc_driver_counters *s = &driver->stats;
+    c->frames_rx          = atomic_load_explicit(&s->frames_rx, memory_order_relaxed);
+    c->frames_tx          = atomic_load_explicit(&s->frames_tx, memory_order_relaxed);
+    c->bytes_rx           = atomic_load_explicit(&s->bytes_rx, memory_order_relaxed);
+    c->bytes_tx           = atomic_load_explicit(&s->bytes_tx, memory_order_relaxed);
+    c->parse_errors       = atomic_load_explicit(&s->parse_errors, memory_order_relaxed);
+    c->resyncs            = atomic_load_explicit(&s->resyncs, memory_order_relaxed);
+    c->queue_drops        = atomic_load_explicit(&s->queue_drops, memory_order_relaxed);
+    c->handshake_attempts = atomic_load_explicit(&s->handshake_attempts, memory_order_relaxed);
+}
+
+/**
+ * @brief Like read_live(), but zero each counter in the same atomic step it is read.
+ */
+static void take_live(struct usc_driver_t *driver, microusc_persist_counters_t *c)
+{
+    struct usc_driver_counters *s = &driver->stats;
+    c->frames_rx          = atomic_exchange_explicit(&s->frames_rx, 0, memory_order_relaxed);
+    c->frames_tx          = atomic_exchange_explicit(&s->frames_tx, 0, memory_order_relaxed);
+    c->bytes_rx           = atomic_exchange_explicit(&s->bytes_rx, 0, memory_order_relaxed);
+    c->bytes_tx           = atomic_exchange_explicit(&s->bytes_tx, 0, memory_order_relaxed);
+    c->parse_errors       = atomic_exchange_explicit(&s->parse_errors, 0, memory_order_relaxed);
+    c->resyncs            = atomic_exchange_explicit(&s->resyncs, 0, memory_order_relaxed);
+    c->queue_drops        = atomic_exchange_explicit(&s->queue_drops, 0, memory_order_relaxed);
+    c->handshake_attempts = atomic_exchange_explicit(&s->handshake_attempts, 0, memory_order_relaxed);
+}
+
+/* Differences are taken at the live counter's width, so a wrap folds right */
+#define FOLD(field, width) do {                                            \
+        const uint64_t delta = (width)(cur.field - base->field);           \
+        totals->field += delta;                                            \
+        changed |= (delta != 0);                                           \
+    } while (0)
+
+/**
+ * @brief Add what driver index i counted since the last fold, cur being its counters now.
+ *
+ * Must be called with persist.lock held.
+ */
+static void fold_counters(const UBaseType_t i, const microusc_persist_counters_t cur)
+{
+    if (i >= DRIVER_MAX || persist.live[i].slot == PERSIST_NO_SLOT) {
+        return;
+    }
+    microusc_persist_counters_t *base = &persist.live[i].base;
+    microusc_persist_counters_t *totals = &persist.drivers[persist.live[i].slot].totals;
+    bool changed = false;
+    FOLD(frames_rx, uint32_t);
+    FOLD(frames_tx, uint32_t);
+    FOLD(bytes_rx, uint64_t);
+    FOLD(bytes_tx, uint64_t);
+    FOLD(parse_errors, uint32_t);
+    FOLD(resyncs, uint32_t);
+    FOLD(queue_drops, uint32_t);
+    FOLD(handshake_attempts, uint32_t);
+    *base = cur;
+    persist.drivers_dirty |= changed;
+}
+
+#undef FOLD
+
+/**
+ * @brief Add what a live driver counted since the last fold to its totals.
+ *
+ * Must be called with persist.lock held.
+ */
+static void fold_driver(const struct usc_driver_t *driver)
+{
+    microusc_persist_counters_t cur;
+    read_live(driver, &cur);
+    fold_counters(driver->priority, cur);
+}
+
+/**
+ * @brief Record the most processor stack a live driver has used.
+ *
+ * Must be called with persist.lock held.
+ */
+static void measure_stack(const struct usc_driver_t *driver)
+{
+    const UBaseType_t i = driver->priority;
+    if (i >= DRIVER_MAX || persist.live[i].slot == PERSIST_NO_SLOT || driver->uart_processor.task == NULL) {
+        return;
+    }
+    const size_t free_bytes = uxTaskGetStackHighWaterMark(driver->uart_processor.task); /* bytes on ESP-IDF */
+    if (free_bytes >= driver->uart_processor.stack_size) {
+        return;
+    }
+    const uint32_t used = (uint32_t)(driver->uart_processor.stack_size - free_bytes);
+    microusc_persist_driver_t *record = &persist.drivers[persist.live[i].slot];
+    if (used > record->stack_peak) {
+        record->stack_peak = used;
+        persist.drivers_dirty = true;
+    }
+}
+
+static int find_slot(const char *name)
+{
+    for (int s = 0; s < MICROUSC_PERSIST_DRIVERS; s++) {
+        if (persist.drivers[s].name[0] != '\0' && strncmp(persist.drivers[s].name, name, MICROUSC_PERSIST_NAME_SIZE) == 0) {
+            return s;
+        }
+    }
+    return PERSIST_NO_SLOT;
+}
+
+static bool slot_live(const int slot)
+{
+    for (UBaseType_t i = 0; i < DRIVER_MAX; i++) {
+        if (persist.live[i].slot == slot) {
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * @brief Slot for a name never seen: a free one, or the least recently installed.
+ */
+static int claim_slot(const char *name)
+{
+    int victim = PERSIST_NO_SLOT;
+    for (int s = 0; s < MICROUSC_PERSIST_DRIVERS; s++) {
+        if (persist.drivers[s].name[0] == '\0') {
+            victim = s;
+            break;
+        }
+        if (!slot_live(s) && (victim == PERSIST_NO_SLOT || persist.drivers[s].last_boot < persist.drivers[victim].last_boot)) {
+            victim = s;
+        }
+    }
+    if (victim != PERSIST_NO_SLOT) {
+        memset(&persist.drivers[victim], 0, sizeof(persist.drivers[victim]));
+        strncpy(persist.drivers[victim].name, name, MICROUSC_PERSIST_NAME_SIZE - 1);
+    }
+    return victim;
+}
+
+/**
+ * @brief Map a live driver to its record and take its configuration.
+ *
+ * Must be called with persist.lock held.
+ */
+static void remember_driver(const struct usc_driver_t *driver)
+{
+    const UBaseType_t i = driver->priority;
+    if (i >= DRIVER_MAX) {
+        return;
+    }
+    int slot = find_slot(driver->driver_name);
+    if (slot == PERSIST_NO_SLOT) {
+        slot = claim_slot(driver->driver_name);
+    }
+    persist.live[i].slot = slot;
+    if (slot == PERSIST_NO_SLOT) {
+        return;
+    }
+    microusc_persist_driver_t *record = &persist.drivers[slot];
+    record->uart_config = driver->uart_config;
+    record->port_config = driver->port_config;
+    record->stack_size = (uint32_t)driver->uart_processor.stack_size;
+    record->installs++;
+    record->last_boot = persist.system.boots;
+    read_live(driver, &persist.live[i].base);
+    persist.drivers_dirty = true;
+}
+
+static void flush_work(void *ctx)
+{
+    (void)ctx;
+    const esp_err_t ret = microusc_persist_flush();
+    if (ret != ESP_OK) {
+        ESP_LOGW(TAG, "Flush failed: %s", esp_err_to_name(ret));
+    }
+}
+
+void microusc_persist_init(void)
+{
+    if (persist.lock != NULL) {
+        return;
+    }
+    persist.lock = xSemaphoreCreateMutexStatic(&persist.lock_buffer);
+    for (UBaseType_t i = 0; i < DRIVER_MAX; i++) {
+        persist.live[i].slot = PERSIST_NO_SLOT;
+    }
+    persist.uptime_mark_us = esp_timer_get_time();
+
+    const esp_err_t ret = open_partition();
+    if (ret != ESP_OK) {
+        ESP_LOGW(TAG, "Partition %s unavailable, nothing is kept: %s", MICROUSC_PERSIST_PARTITION, esp_err_to_name(ret));
+        return;
+    }
+    persist.open = true;
+
+    load_blob(PERSIST_SYSTEM_KEY, &persist.system, sizeof(persist.system));
+    load_blob(PERSIST_DRIVERS_KEY, persist.drivers, sizeof(persist.drivers));
+    load_blob(PERSIST_CRASHES_KEY, &persist.crashes, sizeof(persist.crashes));
+    if (persist.crashes.count > MICROUSC_PERSIST_CRASHES) {
+        memset(&persist.crashes, 0, sizeof(persist.crashes));
+    }
+    for (int s = 0; s < MICROUSC_PERSIST_DRIVERS; s++) {
+        persist.drivers[s].name[MICROUSC_PERSIST_NAME_SIZE - 1] = '\0';
+    }
+
+    const esp_reset_reason_t reason = microusc_crash_log_reset_reason();
+    if (reason == ESP_RST_DEEPSLEEP) {
+        /* A wake-up is counted with the next batch; the sleep may have carried newer totals */
+        if (carry.magic == PERSIST_CARRY_MAGIC && carry.crc == carry_crc()) {
+            persist.system = carry.system;
+            memcpy(persist.drivers, carry.drivers, sizeof(persist.drivers));
+            persist.drivers_dirty = carry.drivers_dirty;
+            persist.written_us = carry.written_us;
+            persist.uptime_mark_us -= carry.uptime_rest_us;
+        }
+        persist.system.boots++;
+        persist.system_dirty = true;
+    }
+    else {
+        /* The boot count and a crash are written right away; everything else is batched */
+        persist.system.boots++;
+        if (is_crash(reason)) {
+            save_crash(reason);
+        }
+        nvs_set_blob(persist.nvs, PERSIST_SYSTEM_KEY, &persist.system, sizeof(persist.system));
+        nvs_commit(persist.nvs);
+        persist.written_us = now_us();
+    }
+    carry.magic = 0; /* taken, a later wake-up without a carry loads the flash copy */
+
+    /* A peak only holds for the image it was measured on; an update learns it again */
+    uint8_t image[PERSIST_IMAGE_SIZE], saved[PERSIST_IMAGE_SIZE];
+    memcpy(image, esp_app_get_description()->app_elf_sha256, PERSIST_IMAGE_SIZE);
+    if (!load_blob(PERSIST_IMAGE_KEY, saved, sizeof(saved)) || memcmp(image, saved, PERSIST_IMAGE_SIZE) != 0) {
+        for (int s = 0; s < MICROUSC_PERSIST_DRIVERS; s++) {
+            persist.drivers[s].stack_peak = 0;
+        }
+        persist.drivers_dirty = true;
+        nvs_set_blob(persist.nvs, PERSIST_IMAGE_KEY, image, sizeof(image)); /* committed with the next batch */
+    }
+
+    if (microusc_post_periodic(flush_work, NULL, pdMS_TO_TICKS(MICROUSC_PERSIST_FLUSH_MS), NULL) != ESP_OK) {
+        ESP_LOGW(TAG, "No periodic flush, call microusc_persist_flush()");
+    }
+    ESP_LOGI(TAG, "Boot %" PRIu32 ", %" PRIu32 " crash(es) so far", persist.system.boots, persist.system.crashes);
+}
+
+stack_size_t microusc_persist_stack_size(const char *name, stack_size_t requested)
+{
+    if (!persist.open || name == NULL || MICROUSC_PERSIST_STACK_MARGIN == 0) {
+        return requested;
+    }
+    stack_size_t tuned = requested;
+    xSemaphoreTake(persist.lock, portMAX_DELAY);
+    const int slot = find_slot(name);
+    if (slot != PERSIST_NO_SLOT && persist.drivers[slot].stack_peak != 0) {
+        tuned = (persist.drivers[slot].stack_peak + MICROUSC_PERSIST_STACK_MARGIN + 15) & ~(stack_size_t)15;
+    }
+    xSemaphoreGive(persist.lock);
+
+    if (tuned != requested) {
+        ESP_LOGI(TAG, "%s processor stack %u bytes, learned (requested %u)", name, (unsigned)tuned, (unsigned)requested);
+    }
+    return tuned;
+}
+
+void microusc_persist_driver_installed(const struct usc_driver_t *driver)
+{
+    if (!persist.open) {
+        return;
+    }
+    xSemaphoreTake(persist.lock, portMAX_DELAY);
+    remember_driver(driver);
+    xSemaphoreGive(persist.lock);
+}
+
+void microusc_persist_driver_reset(struct usc_driver_t *driver)
+{
+    const UBaseType_t i = driver->priority;
+    microusc_persist_counters_t cur;
+    if (!persist.open || i >= DRIVER_MAX) {
+        take_live(driver, &cur); /* no totals to keep */
+        return;
+    }
+    xSemaphoreTake(persist.lock, portMAX_DELAY);
+    take_live(driver, &cur);
+    fold_counters(i, cur);
+    memset(&persist.live[i].base, 0, sizeof(persist.live[i].base)); /* the counters restart from 0 */
+    xSemaphoreGive(persist.lock);
+}
+
+void microusc_persist_driver_removed(const struct usc_driver_t *driver)
+{
+    const UBaseType_t i = driver->priority;
+    if (!persist.open || i >= DRIVER_MAX) {
+        return;
+    }
+    xSemaphoreTake(persist.lock, portMAX_DELAY);
+    fold_driver(driver);
+    measure_stack(driver);
+    persist.live[i].slot = PERSIST_NO_SLOT;
+    xSemaphoreGive(persist.lock);
+}
+
+/**
+ * @brief Fold the live counters, stack peaks and run time into RAM.
+ *
+ * @return ESP_OK with persist.lock held, or ESP_ERR_TIMEOUT without it.
+ */
+static esp_err_t collect(void)
+{
+    /* driver_system.lock before persist.lock, the order usc_driver_deinit() takes them in */
+    const bool drivers_locked = (xSemaphoreTake(driver_system.lock, PERSIST_LOCK_WAIT) == pdTRUE);
+    if (xSemaphoreTake(persist.lock, PERSIST_LOCK_WAIT) != pdTRUE) {
+        if (drivers_locked) {
+            xSemaphoreGive(driver_system.lock);
+        }
+        return ESP_ERR_TIMEOUT;
+    }
+
+    if (drivers_locked) {
+        struct usc_driverList *item, *tmp;
+        list_for_each_entry_safe(item, tmp, &driver_system.driver_list.list, list) {
+            fold_driver(&item->driver);
+            measure_stack(&item->driver);
+        }
+        xSemaphoreGive(driver_system.lock);
+    }
+    else {
+        ESP_LOGW(TAG, "Driver list busy, counters folded at the next flush");
+    }
+
+    const int64_t now = esp_timer_get_time();
+    const uint64_t seconds = (uint64_t)(now - persist.uptime_mark_us) / 1000000ULL;
+    persist.uptime_mark_us += (int64_t)seconds * 1000000LL;
+    persist.system.uptime_s += seconds;
+    persist.system_dirty |= (seconds != 0);
+    return ESP_OK;
+}
+
+/**
+ * @brief Write what changed since the last write. Must be called with persist.lock held.
+ */
+static esp_err_t write_changes(void)
+{
+    esp_err_t ret = ESP_OK;
+    if (persist.drivers_dirty) {
+        ret = nvs_set_blob(persist.nvs, PERSIST_DRIVERS_KEY, persist.drivers, sizeof(persist.drivers));
+        persist.drivers_dirty = (ret != ESP_OK);
+        persist.system_dirty = true;
+    }
+    if (persist.system_dirty && ret == ESP_OK) {
+        persist.system.flushes++;
+        ret = nvs_set_blob(persist.nvs, PERSIST_SYSTEM_KEY, &persist.system, sizeof(persist.system));
+        persist.system_dirty = (ret != ESP_OK);
+        if (ret == ESP_OK) {
+            ret = nvs_commit(persist.nvs);
+        }
+    }
+    if (ret == ESP_OK) {
+        persist.written_us = now_us();
+    }
+    return ret;
+}
+
+esp_err_t microusc_persist_flush(void)
+{
+    if (!persist.open) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    esp_err_t ret = collect();
+    if (ret == ESP_OK) {
+        ret = write_changes();
+        xSemaphoreGive(persist.lock);
+    }
+    return ret;
+}
+
+void microusc_persist_sleep(void)
+{
+    if (!persist.open || collect() != ESP_OK) {
+        return;
+    }
+    const uint64_t now = now_us();
+    const bool due = now < persist.written_us || now - persist.written_us >= MICROUSC_PERSIST_FLUSH_MS * 1000ULL;
+    if (due && write_changes() != ESP_OK) {
+        ESP_LOGW(TAG, "Flush before sleep failed, kept in RTC memory");
+    }
+
+    carry.drivers_dirty = persist.drivers_dirty;
+    carry.uptime_rest_us = (uint32_t)(esp_timer_get_time() - persist.uptime_mark_us);
+    carry.written_us = persist.written_us;
+    carry.system = persist.system;
+    memcpy(carry.drivers, persist.drivers, sizeof(carry.drivers));
+    carry.magic = PERSIST_CARRY_MAGIC;
+    carry.crc = carry_crc();
+    xSemaphoreGive(persist.lock);
+}
+
+esp_err_t microusc_persist_get_driver(const char *name, microusc_persist_driver_t *driver)
+{
+    if (name == NULL || driver == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (persist.lock == NULL) {
+        return ESP_ERR_NOT_FOUND;
+    }
+    xSemaphoreTake(persist.lock, portMAX_DELAY);
+    const int slot = find_slot(name);
+    if (slot != PERSIST_NO_SLOT) {
+        *driver = persist.drivers[slot];
+    }
+    xSemaphoreGive(persist.lock);
+    return (slot != PERSIST_NO_SLOT) ? ESP_OK : ESP_ERR_NOT_FOUND;
+}
+
+void microusc_persist_get_system(microusc_persist_system_t *system)
+{
+    if (system == NULL) {
+        return;
+    }
+    if (persist.lock == NULL) {
+        memset(system, 0, sizeof(*system));
+        return;
+    }
+    xSemaphoreTake(persist.lock, portMAX_DELAY);
+    *system = persist.system;
+    xSemaphoreGive(persist.lock);
+}
+
+size_t microusc_persist_read_crashes(microusc_persist_crash_t *crashes, size_t max)
+{
+    if (crashes == NULL || persist.lock == NULL) {
+        return 0;
+    }
+    xSemaphoreTake(persist.lock, portMAX_DELAY);
+    const size_t count = (persist.crashes.count < max) ? persist.crashes.count : max;
+    memcpy(crashes, persist.crashes.crashes, count * sizeof(crashes[0]));
+    xSemaphoreGive(persist.lock);
+    return count;
+}
+
+esp_err_t microusc_persist_erase(void)
+{
+    if (!persist.open) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    xSemaphoreTake(driver_system.lock, portMAX_DELAY); /* before persist.lock, see microusc_persist_flush() */
+    xSemaphoreTake(persist.lock, portMAX_DELAY);
+    esp_err_t ret = nvs_erase_all(persist.nvs);
+    if (ret == ESP_OK) {
+        ret = nvs_commit(persist.nvs);
+    }
+    memset(&persist.system, 0, sizeof(persist.system));
+    memset(persist.drivers, 0, sizeof(persist.drivers));
+    memset(&persist.crashes, 0, sizeof(persist.crashes));
+    persist.system_dirty = false;
+    persist.drivers_dirty = false;
+    persist.uptime_mark_us = esp_timer_get_time();
+    for (UBaseType_t i = 0; i < DRIVER_MAX; i++) {
+        persist.live[i].slot = PERSIST_NO_SLOT;
+    }
+
+    /* Installed drivers start over from their current counters */
+    struct usc_driverList *item, *tmp;
+    list_for_each_entry_safe(item, tmp, &driver_system.driver_list.list, list) {
+        remember_driver(&item->driver);
+    }
+    xSemaphoreGive(persist.lock);
+    xSemaphoreGive(driver_system.lock);
+    return ret;
+}
+
+void microusc_persist_print(void)
+{
+    microusc_persist_system_t system;
+    microusc_persist_get_system(&system);
+    ESP_LOGI(TAG, "%" PRIu32 " boots, %" PRIu32 " crashes, %llu s up, %" PRIu32 " flushes",
+             system.boots, system.crashes, (unsigned long long)system.uptime_s, system.flushes);
+    if (persist.lock == NULL) {
+        return;
+    }
+
+    xSemaphoreTake(persist.lock, portMAX_DELAY);
+    for (int s = 0; s < MICROUSC_PERSIST_DRIVERS; s++) {
+        const microusc_persist_driver_t *d = &persist.drivers[s];
+        if (d->name[0] == '\0') {
+            continue;
+        }
+        ESP_LOGI(TAG, "%s: UART%d %d baud, stack %" PRIu32 " (peak %" PRIu32 "), %" PRIu32 " installs",
+                 d->name, (int)d->port_config.port, d->uart_config.baud_rate, d->stack_size, d->stack_peak, d->installs);
+        ESP_LOGI(TAG, "  rx %llu frames %llu bytes, tx %llu frames %llu bytes, %" PRIu32 " parse errors, %" PRIu32 " drops",
+                 (unsigned long long)d->totals.frames_rx, (unsigned long long)d->totals.bytes_rx,
+                 (unsigned long long)d->totals.frames_tx, (unsigned long long)d->totals.bytes_tx,
+                 d->totals.parse_errors, d->totals.queue_drops);
+    }
+    for (uint32_t c = 0; c < persist.crashes.count; c++) {
+        const microusc_persist_crash_t *crash = &persist.crashes.crashes[c];
+        ESP_LOGI(TAG, "crash in boot %" PRIu32 ": reset reason %u, %u log record(s)",
+                 crash->boot, (unsigned)crash->reason, (unsigned)crash->count);
+    }
+    xSemaphoreGive(persist.lock);
+}
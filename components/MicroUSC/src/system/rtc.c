@@ -1,74 +1,211 @@
-#include "MicroUSC/system/rtc.h"
-#include "MicroUSC/internal/USC_driver_config.h"
-#include "MicroUSC/internal/uscdef.h"
-#include "esp_system.h"
+#include "MicroUSC/internal/system/rtc.h"
+#include "freertos/FreeRTOS.h"
+#include "esp_attr.h"
 #include "esp_log.h"
-#include "esp_heap_caps.h"
+#include "esp_rom_crc.h"
+#include <stdbool.h>
+#include <stddef.h>
+#include <string.h>
 
 #define TAG "[RTC MEMORY]"
 
-#define RTC_MEMORY_BUFFER_SIZE (256) // Size of the memory buffer
-#define RTC_MEMORY_STORAGE_KEY_SIZE (32) // Size of the key for the memory storage
+#define RTC_STORE_MAGIC   ( 0x55535232 ) // "USR2"
+#define RTC_STORE_ALIGN   ( 4 )
+#define RTC_STORE_NO_SLOT ( 0 )          // index value of a key that is not stored
 
-struct rtc_map {
-    char key;
-    uint8_t size;
+_Static_assert(MICROUSC_RTC_STORE_SIZE % RTC_STORE_ALIGN == 0, "RTC store size must be a multiple of 4");
+_Static_assert(MICROUSC_RTC_STORE_SIZE <= UINT16_MAX, "RTC store offsets are 16 bits");
+_Static_assert(MICROUSC_RTC_STORE_KEYS < UINT8_MAX, "RTC store slots are indexed with a byte");
+
+struct rtc_entry {
+    char key;         // '\0' for a value dropped at boot, its space stays allocated
+    uint8_t reserved;
+    uint16_t size;
+    uint16_t offset;  // into data, RTC_STORE_ALIGN aligned
+    uint16_t reserved2;
 };
 
-RTC_NOINIT_ATTR struct rtc_memory_t {
-    struct rtc_map mapping[RTC_MEMORY_STORAGE_KEY_SIZE];
-    uint8_t buf[RTC_MEMORY_BUFFER_SIZE]; // RTC memory buffer
+/* Lives across resets; every field is validated before use since power-on leaves it random */
+typedef struct {
+    uint32_t magic;
+    uint16_t used;    // bytes of data allocated
+    uint8_t count;    // entries in use, dropped ones included
+    uint8_t reserved;
+    struct rtc_entry entries[MICROUSC_RTC_STORE_KEYS];
+    uint32_t crc;     // CRC32 of the fields above
+    uint32_t value_crc[MICROUSC_RTC_STORE_KEYS]; // CRC32 per value, outside the header CRC
+    uint8_t data[MICROUSC_RTC_STORE_SIZE] __attribute__((aligned(RTC_STORE_ALIGN)));
+} rtc_store_t;
+
+RTC_NOINIT_ATTR static rtc_store_t rtc_store;
+
+/* Rebuilt at boot, so it lives in ordinary RAM */
+static struct {
+    uint8_t slot[256]; // entry index + 1 per key, RTC_STORE_NO_SLOT if absent
+    bool initialized;
     portMUX_TYPE lock;
-    int address_key_index; // Index for the address key
-    int remaining_mem;
-} rtc_memory = {.mapping = {}, .buf = {0}, .lock = portMUX_INITIALIZER_UNLOCKED, .address_key_index = 0, .remaining_mem = RTC_MEMORY_BUFFER_SIZE};
-
-#define INITIALIZE_RTC_MEMORY { \
-    .mapping = {}, \
-    .buf = {0}, \
-    .lock = portMUX_INITIALIZER_UNLOCKED, \
-    .address_key_index = 0, \
-    .remaining_mem = RTC_MEMORY_BUFFER_SIZE \
+} rtc_index = {
+    .lock = portMUX_INITIALIZER_UNLOCKED,
+};
+
+static __always_inline uint32_t header_crc(void)
+{
+    return esp_rom_crc32_le(0, (const uint8_t *)&rtc_store, offsetof(rtc_store_t, crc));
 }
 
-void save_system_rtc_var(void *var, const size_t size, const char key)
+static __always_inline uint32_t value_crc(const struct rtc_entry *entry)
 {
-    if (var == NULL || size == 0 || key == '\0') {
-        ESP_LOGE(TAG, "Invalid parameters for saving RTC variable");
+    return esp_rom_crc32_le(0, rtc_store.data + entry->offset, entry->size);
+}
+
+static __always_inline bool entry_valid(const uint8_t i)
+{
+    const struct rtc_entry *entry = &rtc_store.entries[i];
+    return entry->key != '\0' &&
+           entry->size != 0 &&
+           entry->offset % RTC_STORE_ALIGN == 0 &&
+           (size_t)entry->offset + entry->size <= rtc_store.used &&
+           rtc_index.slot[(uint8_t)entry->key] == RTC_STORE_NO_SLOT && /* first of duplicate keys wins */
+           rtc_store.value_crc[i] == value_crc(entry);
+}
+
+static void rtc_store_reset(void)
+{
+    memset(&rtc_store, 0, offsetof(rtc_store_t, data));
+    rtc_store.magic = RTC_STORE_MAGIC;
+    rtc_store.crc = header_crc();
+    memset(rtc_index.slot, RTC_STORE_NO_SLOT, sizeof(rtc_index.slot));
+}
+
+/**
+ * @brief Validate the store and index its keys. Must be called with the lock held.
+ */
+static void rtc_store_load(void)
+{
+    memset(rtc_index.slot, RTC_STORE_NO_SLOT, sizeof(rtc_index.slot));
+    rtc_index.initialized = true;
+
+    if (rtc_store.magic != RTC_STORE_MAGIC || rtc_store.crc != header_crc() ||
+        rtc_store.used > MICROUSC_RTC_STORE_SIZE || rtc_store.count > MICROUSC_RTC_STORE_KEYS) {
+        rtc_store_reset(); /* power-on or corrupted, start over */
         return;
     }
 
-    portENTER_CRITICAL(&rtc_memory.lock);
-    {
-        if (size <= rtc_memory.remaining_mem && rtc_memory.address_key_index < RTC_MEMORY_STORAGE_KEY_SIZE) {
-            const int offset = RTC_MEMORY_BUFFER_SIZE - rtc_memory.remaining_mem;
-            uint8_t *ptr = rtc_memory.buf + offset;
-            memcpy(ptr, var, size); // Copy the variable to the RTC memory
-            rtc_memory.remaining_mem -= size; // Decrease the remaining size
-            rtc_memory.mapping[rtc_memory.address_key_index++].key = key; // Save the key            
-            ESP_LOGI(TAG, "Saved %u bytes to RTC memory", size);
+    bool dropped = false;
+    for (uint8_t i = 0; i < rtc_store.count; i++) {
+        struct rtc_entry *entry = &rtc_store.entries[i];
+        if (entry_valid(i)) {
+            rtc_index.slot[(uint8_t)entry->key] = i + 1;
         }
-        else{
-            ESP_LOGE(TAG, "Not enough space in RTC memory");
+        else if (entry->key != '\0') {
+            entry->key = '\0'; /* torn by a reset during a save */
+            dropped = true;
         }
     }
-    portEXIT_CRITICAL(&rtc_memory.lock);
+    if (dropped) {
+        rtc_store.crc = header_crc();
+    }
 }
 
-void *get_system_rtc_var(const char key)
+void microusc_rtc_store_init(void)
 {
-    uintptr_t address = 0; // 'NULL' equivalent
-    portENTER_CRITICAL(&rtc_memory.lock);
+    size_t count = 0;
+    portENTER_CRITICAL(&rtc_index.lock);
+    if (!rtc_index.initialized) {
+        rtc_store_load();
+    }
+    for (size_t i = 0; i < sizeof(rtc_index.slot); i++) {
+        count += (rtc_index.slot[i] != RTC_STORE_NO_SLOT);
+    }
+    portEXIT_CRITICAL(&rtc_index.lock);
+    ESP_LOGI(TAG, "%u variable(s) kept, %u of %u bytes used",
+             (unsigned)count, (unsigned)rtc_store.used, (unsigned)MICROUSC_RTC_STORE_SIZE);
+}
+
+esp_err_t save_system_rtc_var(const void *var, const size_t size, const char key)
+{
+    if (var == NULL || size == 0 || key == '\0') {
+        ESP_LOGE(TAG, "Invalid parameters for saving RTC variable");
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    esp_err_t ret = ESP_OK;
+    portENTER_CRITICAL(&rtc_index.lock);
     {
-        size_t offset = 0;
-        define_iteration(rtc_memory.mapping, struct rtc_map, map, RTC_MEMORY_STORAGE_KEY_SIZE) {
-            if (map->key == key) {
-                address = (uintptr_t)rtc_memory.buf + offset;
-                break;
+        if (!rtc_index.initialized) {
+            rtc_store_load();
+        }
+
+        struct rtc_entry *entry = NULL;
+        bool added = false;
+        const uint8_t slot = rtc_index.slot[(uint8_t)key];
+        if (slot != RTC_STORE_NO_SLOT) {
+            entry = &rtc_store.entries[slot - 1];
+            if (entry->size != size) {
+                ret = ESP_ERR_INVALID_SIZE;
+            }
+        }
+        else {
+            const size_t aligned = (size + RTC_STORE_ALIGN - 1) & ~(size_t)(RTC_STORE_ALIGN - 1);
+            if (rtc_store.count == MICROUSC_RTC_STORE_KEYS || aligned > MICROUSC_RTC_STORE_SIZE - rtc_store.used) {
+                ret = ESP_ERR_NO_MEM;
+            }
+            else {
+                entry = &rtc_store.entries[rtc_store.count];
+                *entry = (struct rtc_entry){ .key = key, .size = (uint16_t)size, .offset = rtc_store.used };
+                rtc_store.used += aligned;
+                rtc_store.count++;
+                rtc_index.slot[(uint8_t)key] = rtc_store.count;
+                added = true;
+            }
+        }
+
+        if (ret == ESP_OK) {
+            /*
+             * Value, then its CRC. Both are outside the header CRC, so a reset in between
+             * only loses this value. Adding a key also rewrites the header, and a reset
+             * before its CRC is updated below loses the whole store.
+             */
+            memcpy(rtc_store.data + entry->offset, var, size);
+            rtc_store.value_crc[entry - rtc_store.entries] = value_crc(entry);
+            if (added) {
+                rtc_store.crc = header_crc();
             }
-            offset += map->size;
         }
     }
-    portEXIT_CRITICAL(&rtc_memory.lock);
-    return (void *)address;
-}
\ No newline at end of file
+    portEXIT_CRITICAL(&rtc_index.lock);
+
+    if (ret == ESP_ERR_INVALID_SIZE) {
+        ESP_LOGE(TAG, "Key '%c' was saved with a different size", key);
+    }
+    else if (ret == ESP_ERR_NO_MEM) {
+        ESP_LOGE(TAG, "Not enough space in RTC memory");
+    }
+    return ret;
+}
+
+void *get_system_rtc_var(const char key)
+{
+    if (!rtc_index.initialized) {
+        microusc_rtc_store_init();
+    }
+    const uint8_t slot = rtc_index.slot[(uint8_t)key];
+    return (slot != RTC_STORE_NO_SLOT) ? rtc_store.data + rtc_store.entries[slot - 1].offset : NULL;
+}
+
+size_t get_system_rtc_var_size(const char key)
+{
+    if (!rtc_index.initialized) {
+        microusc_rtc_store_init();
+    }
+    const uint8_t slot = rtc_index.slot[(uint8_t)key];
+    return (slot != RTC_STORE_NO_SLOT) ? rtc_store.entries[slot - 1].size : 0;
+}
+
+void clear_system_rtc_vars(void)
+{
+    portENTER_CRITICAL(&rtc_index.lock);
+    rtc_store_reset();
+    rtc_index.initialized = true;
+    portEXIT_CRITICAL(&rtc_index.lock);
+}
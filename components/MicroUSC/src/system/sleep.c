@@ -1,52 +1,516 @@
-#include "MicroUSC/system/sleep.h"
+#include "MicroUSC/internal/system/sleep.h"
+#include "MicroUSC/internal/system/work_queue.h"
+#include "MicroUSC/internal/system/crash_log.h"
+#include "MicroUSC/internal/system/persist.h"
+#include "MicroUSC/internal/driverList.h"
+#include "MicroUSC/system/manager.h"
+#include "MicroUSC/system/rtc.h"
+#include "MicroUSC/USCdriver.h"
 #include "esp_sleep.h"
+#include "esp_timer.h"
+#include "esp_log.h"
+#include <inttypes.h>
+#include <string.h>
+
+#define TAG "[SLEEP]"
+
+#define SLEEP_RX_KEY ( (char)(MICROUSC_RTC_KEY_RESERVED + 9) ) // after the warm boot keys
+#define SLEEP_RX_NO_PORT ( -1 )
+
+#define LIGHT_PORT_DEFAULT ( 0 )  // MICROUSC_LIGHT_SLEEP_UART_THRESHOLD
+#define LIGHT_PORT_IGNORED ( -1 ) // does not wake the system, does not prevent sleep
+
+_Static_assert(MICROUSC_SLEEP_RX_WORDS <= UINT8_MAX, "saved word counts are 8 bits");
 
 struct sleep_config_t {
     gpio_num_t wakeup_pin;
     uint64_t time;
     bool wakeup_pin_enable;
     bool sleep_time_enable;
+    bool persist_rx;
+    bool wake_for_work;
 } deep_sleep;
 
-void sleep_mode_timer_wakeup(uint64_t time) 
+/* Unread words of every driver, saved in the RTC store right before deep sleep */
+typedef struct {
+    int8_t port[DRIVER_MAX];   // SLEEP_RX_NO_PORT for an unused or restored slot
+    uint8_t count[DRIVER_MAX];
+    uint32_t words[DRIVER_MAX][MICROUSC_SLEEP_RX_WORDS];
+} sleep_rx_t;
+
+/* Automatic light sleep, run by a periodic item on the system task */
+static struct {
+    sleep_auto_light_config_t config;
+    sleep_auto_light_stats_t stats;
+    microusc_work_id_t check;      // 0 while disabled
+    int threshold[UART_NUM_MAX];   // LIGHT_PORT_DEFAULT, LIGHT_PORT_IGNORED or RX edges
+    bool warned[UART_NUM_MAX];     // port that cannot wake was reported
+    uint32_t activity[DRIVER_MAX]; // frames of each driver at the last check
+    int64_t idle_since_us;
+    portMUX_TYPE lock;
+} light = {
+    .lock = portMUX_INITIALIZER_UNLOCKED,
+};
+
+void sleep_mode_timer_wakeup(uint64_t time)
 {
     deep_sleep.time = time;
 }
 
-void sleep_mode_timer(bool option) 
+void sleep_mode_timer(bool option)
 {
     deep_sleep.sleep_time_enable = option;
 }
- 
-void sleep_mode_wakeup_pin(gpio_num_t pin) 
+
+void sleep_mode_wakeup_pin(gpio_num_t pin)
 {
     deep_sleep.wakeup_pin = pin;
 }
- 
+
 void sleep_mode_wakeup_pin_status(bool option)
 {
     deep_sleep.wakeup_pin_enable = option;
 }
 
-void sleep_mode_wakeup_default(void) 
+void sleep_mode_persist_rx(bool option)
+{
+    deep_sleep.persist_rx = option;
+}
+
+void sleep_mode_wake_for_work(bool option)
+{
+    deep_sleep.wake_for_work = option;
+}
+
+void sleep_mode_wakeup_default(void)
 {
     sleep_mode_timer_wakeup(DEFAULT_LIGHTMODE_TIME);
     sleep_mode_timer(true);
     sleep_mode_wakeup_pin(GPIO_NUM_NC);
     sleep_mode_wakeup_pin_status(false);
+    sleep_mode_persist_rx(true);
+    sleep_mode_wake_for_work(true);
+}
+
+/**
+ * @brief Microseconds until the next work item, UINT64_MAX if none is scheduled.
+ */
+static uint64_t next_work_us(void)
+{
+    const TickType_t ticks = microusc_work_next_timeout();
+    return (ticks == portMAX_DELAY) ? UINT64_MAX : (uint64_t)ticks * portTICK_PERIOD_MS * 1000ULL;
+}
+
+uint64_t sleep_mode_next_wakeup(void)
+{
+    uint64_t wakeup = deep_sleep.sleep_time_enable ? deep_sleep.time : UINT64_MAX;
+    if (deep_sleep.wake_for_work) {
+        const uint64_t work = next_work_us();
+        wakeup = (work < wakeup) ? work : wakeup;
+    }
+    return (wakeup == UINT64_MAX) ? 0 : wakeup;
+}
+
+void microusc_sleep_init(void)
+{
+    if (microusc_crash_log_reset_reason() == ESP_RST_DEEPSLEEP) {
+        return;
+    }
+    sleep_rx_t *saved = get_system_rtc_var(SLEEP_RX_KEY);
+    if (saved != NULL && get_system_rtc_var_size(SLEEP_RX_KEY) == sizeof(sleep_rx_t)) {
+        sleep_rx_t none;
+        memset(&none, 0, sizeof(none));
+        memset(none.port, SLEEP_RX_NO_PORT, sizeof(none.port));
+        save_system_rtc_var(&none, sizeof(none), SLEEP_RX_KEY); /* not from a sleep, stale */
+    }
+}
+
+void microusc_sleep_restore_rx(struct usc_driver_t *driver)
+{
+    const sleep_rx_t *saved = get_system_rtc_var(SLEEP_RX_KEY);
+    if (saved == NULL || get_system_rtc_var_size(SLEEP_RX_KEY) != sizeof(sleep_rx_t)) {
+        return;
+    }
+
+    for (UBaseType_t i = 0; i < DRIVER_MAX; i++) {
+        if (saved->port[i] != (int8_t)driver->port_config.port) {
+            continue;
+        }
+        sleep_rx_t rest = *saved;
+        const uint8_t count = (rest.count[i] <= MICROUSC_SLEEP_RX_WORDS) ? rest.count[i] : 0;
+        for (uint8_t w = 0; w < count; w++) {
+            dataStorageQueue_add(driver->data, rest.words[i][w]);
+        }
+        rest.port[i] = SLEEP_RX_NO_PORT;
+        rest.count[i] = 0;
+        save_system_rtc_var(&rest, sizeof(rest), SLEEP_RX_KEY);
+        if (count != 0) {
+            ESP_LOGI(TAG, "%u word(s) received before sleep queued for %s", (unsigned)count, driver->driver_name);
+        }
+        return;
+    }
+}
+
+/**
+ * @brief Stop every driver and drain it before the chip powers down.
+ *
+ * Each driver lock is taken and kept, so no reader or sender touches the UART again.
+ * Must only be called right before esp_deep_sleep_start().
+ */
+static void quiesce_drivers(void)
+{
+    sleep_rx_t rx;
+    memset(&rx, 0, sizeof(rx));
+    memset(rx.port, SLEEP_RX_NO_PORT, sizeof(rx.port));
+    size_t kept = 0, lost = 0;
+
+    xSemaphoreTake(driver_system.lock, portMAX_DELAY);
+    struct usc_driverList *item, *tmp;
+    list_for_each_entry_safe(item, tmp, &driver_system.driver_list.list, list) {
+        struct usc_driver_t *driver = &item->driver;
+        if (xSemaphoreTake(driver->sync_signal, pdMS_TO_TICKS(MICROUSC_SLEEP_QUIESCE_MS)) != pdTRUE) {
+            ESP_LOGW(TAG, "%s is busy, sleeping without draining it", driver->driver_name);
+            continue;
+        }
+        if (uart_wait_tx_done(driver->port_config.port, pdMS_TO_TICKS(MICROUSC_SLEEP_QUIESCE_MS)) != ESP_OK) {
+            ESP_LOGW(TAG, "%s TX did not drain", driver->driver_name);
+        }
+
+        const UBaseType_t i = driver->priority;
+        if (!deep_sleep.persist_rx || i >= DRIVER_MAX) {
+            continue;
+        }
+        rx.port[i] = (int8_t)driver->port_config.port;
+        uint32_t word;
+        while ((word = dataStorageQueue_top(driver->data)) != 0) {
+            if (rx.count[i] < MICROUSC_SLEEP_RX_WORDS) {
+                rx.words[i][rx.count[i]++] = word;
+                kept++;
+            }
+            else {
+                lost++;
+            }
+        }
+    }
+    xSemaphoreGive(driver_system.lock);
+
+    if (deep_sleep.persist_rx && save_system_rtc_var(&rx, sizeof(rx), SLEEP_RX_KEY) != ESP_OK) {
+        lost += kept;
+        kept = 0;
+    }
+    if (lost != 0) {
+        ESP_LOGW(TAG, "%u unread word(s) dropped, see MICROUSC_SLEEP_RX_WORDS", (unsigned)lost);
+    }
+    ESP_LOGI(TAG, "%u unread word(s) kept across sleep", (unsigned)kept);
+}
+
+static void sleep_retry(void *ctx)
+{
+    (void)ctx;
+    send_microusc_system_status(USC_SYSTEM_SLEEP);
 }
 
 void sleep_mode(void)
 {
-    if (!(deep_sleep.sleep_time_enable || deep_sleep.wakeup_pin_enable)) {
+    const uint64_t work = deep_sleep.wake_for_work ? next_work_us() : UINT64_MAX;
+    if (work < MICROUSC_SLEEP_MIN_US) {
+        /* Sleeping now would wake right away; run the work, then try again */
+        const TickType_t delay = microusc_work_next_timeout() + 1;
+        if (microusc_post_delayed(sleep_retry, NULL, delay, NULL) == ESP_OK) {
+            ESP_LOGI(TAG, "Work due, sleep deferred");
+            return;
+        }
+    }
+
+    const uint64_t wakeup = sleep_mode_next_wakeup();
+    if (wakeup == 0 && !deep_sleep.wakeup_pin_enable) {
+        ESP_LOGW(TAG, "No wakeup source, not sleeping");
         return; // do nothing as timer is completely disabled
     }
 
-    if (deep_sleep.sleep_time_enable) {
-        esp_sleep_enable_timer_wakeup(deep_sleep.time);
+    microusc_persist_sleep();
+    quiesce_drivers();
+
+    if (wakeup != 0) {
+        esp_sleep_enable_timer_wakeup(wakeup);
     }
     if (deep_sleep.wakeup_pin_enable) {
         esp_sleep_enable_ext0_wakeup(deep_sleep.wakeup_pin, 1);
     }
+    ESP_LOGI(TAG, "Deep sleep, timer %llu us", (unsigned long long)wakeup);
     esp_deep_sleep_start();
-}
\ No newline at end of file
+}
+
+esp_err_t sleep_mode_uart_wakeup(uart_port_t port, int threshold)
+{
+    if (port < 0 || port >= UART_NUM_MAX ||
+        (threshold != 0 && threshold < MICROUSC_LIGHT_SLEEP_UART_THRESHOLD)) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    portENTER_CRITICAL(&light.lock);
+    light.threshold[port] = (threshold == 0) ? LIGHT_PORT_IGNORED : threshold;
+    light.warned[port] = false;
+    portEXIT_CRITICAL(&light.lock);
+    return ESP_OK;
+}
+
+void sleep_mode_auto_light_stats(sleep_auto_light_stats_t *stats)
+{
+    if (stats == NULL) {
+        return;
+    }
+    portENTER_CRITICAL(&light.lock);
+    *stats = light.stats;
+    portEXIT_CRITICAL(&light.lock);
+}
+
+/**
+ * @brief Take the driver list and every driver lock if every driver is idle.
+ *
+ * On success the locks are kept, so no frame is sent and no driver is removed until
+ * release_drivers(). On failure nothing is held.
+ *
+ * @return Number of drivers held, or -1 if one of them is busy.
+ */
+static int hold_idle_drivers(struct usc_driver_t *held[DRIVER_MAX], int64_t now)
+{
+    if (xSemaphoreTake(driver_system.lock, 0) != pdTRUE) {
+        return -1;
+    }
+    int count = 0;
+    bool idle = true;
+    struct usc_driverList *item, *tmp;
+    list_for_each_entry_safe(item, tmp, &driver_system.driver_list.list, list) {
+        struct usc_driver_t *driver = &item->driver;
+        const UBaseType_t i = driver->priority;
+        if (i >= DRIVER_MAX || xSemaphoreTake(driver->sync_signal, 0) != pdTRUE) {
+            idle = false;
+            break;
+        }
+        held[count++] = driver;
+
+        const uint32_t activity = atomic_load_explicit(&driver->stats.frames_rx, memory_order_relaxed) +
+                                  atomic_load_explicit(&driver->stats.frames_tx, memory_order_relaxed);
+        size_t rx_buffered = 0;
+        uart_get_buffered_data_len(driver->port_config.port, &rx_buffered);
+        if (activity != light.activity[i]) {
+            light.activity[i] = activity;
+            light.idle_since_us = now;
+            idle = false;
+        }
+        if (dataStorageQueue_count(driver->data) != 0 || rx_buffered != 0 ||
+            uart_wait_tx_done(driver->port_config.port, 0) != ESP_OK) {
+            idle = false;
+        }
+        if (!idle) {
+            break;
+        }
+    }
+    if (idle) {
+        return count;
+    }
+
+    while (count > 0) {
+        xSemaphoreGive(held[--count]->sync_signal);
+    }
+    xSemaphoreGive(driver_system.lock);
+    return -1;
+}
+
+static void release_drivers(struct usc_driver_t *held[DRIVER_MAX], int count)
+{
+    while (count > 0) {
+        xSemaphoreGive(held[--count]->sync_signal);
+    }
+    xSemaphoreGive(driver_system.lock);
+}
+
+/**
+ * @brief Arm UART wake-up on every held driver's port.
+ *
+ * @return Number of ports armed, or -1 if a port that must wake the system cannot.
+ */
+static int arm_uart_wakeup(struct usc_driver_t *held[DRIVER_MAX], int count)
+{
+    int armed = 0;
+    for (int d = 0; d < count; d++) {
+        const uart_port_t port = held[d]->port_config.port;
+        portENTER_CRITICAL(&light.lock);
+        const int setting = light.threshold[port];
+        portEXIT_CRITICAL(&light.lock);
+        if (setting == LIGHT_PORT_IGNORED) {
+            continue;
+        }
+
+        const int threshold = (setting == LIGHT_PORT_DEFAULT) ? MICROUSC_LIGHT_SLEEP_UART_THRESHOLD : setting;
+        if (uart_set_wakeup_threshold(port, threshold) != ESP_OK || esp_sleep_enable_uart_wakeup(port) != ESP_OK) {
+            if (!light.warned[port]) {
+                light.warned[port] = true;
+                ESP_LOGW(TAG, "UART%d cannot wake from light sleep, see sleep_mode_uart_wakeup()", (int)port);
+            }
+            esp_sleep_disable_wakeup_source(ESP_SLEEP_WAKEUP_UART);
+            return -1;
+        }
+        armed++;
+    }
+    return armed;
+}
+
+static void light_sleep_check(void *ctx);
+
+static void light_sleep_schedule(void)
+{
+    microusc_work_id_t id = 0;
+    if (microusc_post_periodic(light_sleep_check, NULL, pdMS_TO_TICKS(light.config.check_ms), &id) != ESP_OK) {
+        ESP_LOGE(TAG, "Automatic light sleep stopped, work pool is empty");
+        id = 0;
+    }
+    portENTER_CRITICAL(&light.lock);
+    light.check = id;
+    portEXIT_CRITICAL(&light.lock);
+}
+
+/**
+ * @brief Sleep with the drivers held, until a port receives or the timer expires.
+ */
+static void light_sleep_enter(struct usc_driver_t *held[DRIVER_MAX], int count, uint64_t timer)
+{
+    const int ports = arm_uart_wakeup(held, count);
+    if (ports < 0 || (ports == 0 && timer == UINT64_MAX)) {
+        return; // data would be lost, or nothing would wake the system
+    }
+    if (timer != UINT64_MAX) {
+        esp_sleep_enable_timer_wakeup(timer);
+    }
+    for (int d = 0; d < count; d++) {
+        atomic_store_explicit(&held[d]->sleep_wake_pending_us, 0, memory_order_relaxed);
+    }
+
+    const int64_t start = esp_timer_get_time();
+    const esp_err_t ret = esp_light_sleep_start();
+    const int64_t woke = esp_timer_get_time();
+    const esp_sleep_wakeup_cause_t cause = esp_sleep_get_wakeup_cause();
+
+    esp_sleep_disable_wakeup_source(ESP_SLEEP_WAKEUP_UART);
+    esp_sleep_disable_wakeup_source(ESP_SLEEP_WAKEUP_TIMER);
+    if (ret != ESP_OK) {
+        ESP_LOGW(TAG, "Light sleep rejected: %s", esp_err_to_name(ret));
+        return;
+    }
+
+    for (int d = 0; d < count; d++) {
+        atomic_store_explicit(&held[d]->sleep_wake_pending_us, (uint32_t)woke | 1U, memory_order_relaxed);
+    }
+    portENTER_CRITICAL(&light.lock);
+    light.stats.sleeps++;
+    light.stats.slept_us += (uint64_t)(woke - start);
+    if (cause == ESP_SLEEP_WAKEUP_UART) {
+        light.stats.uart_wakes++;
+    }
+    else if (cause == ESP_SLEEP_WAKEUP_TIMER) {
+        light.stats.timer_wakes++;
+    }
+    portEXIT_CRITICAL(&light.lock);
+}
+
+static void light_sleep_check(void *ctx)
+{
+    (void)ctx;
+    const int64_t now = esp_timer_get_time();
+    struct usc_driver_t *held[DRIVER_MAX];
+    const int count = hold_idle_drivers(held, now);
+    if (count < 0) {
+        portENTER_CRITICAL(&light.lock);
+        light.stats.busy++;
+        portEXIT_CRITICAL(&light.lock);
+        return;
+    }
+    if (now - light.idle_since_us < (int64_t)light.config.idle_ms * 1000) {
+        release_drivers(held, count);
+        return;
+    }
+
+    /* This check is periodic work itself; without it the next deadline is the real work */
+    portENTER_CRITICAL(&light.lock);
+    const microusc_work_id_t self = light.check;
+    portEXIT_CRITICAL(&light.lock);
+    microusc_cancel_work(self);
+
+    uint64_t timer = next_work_us();
+    if (light.config.max_sleep_us != 0 && light.config.max_sleep_us < timer) {
+        timer = light.config.max_sleep_us;
+    }
+    if (timer >= MICROUSC_SLEEP_MIN_US) {
+        light_sleep_enter(held, count, timer);
+    }
+    release_drivers(held, count);
+
+    light.idle_since_us = esp_timer_get_time(); // let the frame that woke the system arrive
+    portENTER_CRITICAL(&light.lock);
+    const bool enabled = (light.check == self);
+    portEXIT_CRITICAL(&light.lock);
+    if (enabled) {
+        light_sleep_schedule();
+    }
+}
+
+esp_err_t sleep_mode_auto_light_enable(const sleep_auto_light_config_t *config)
+{
+    const sleep_auto_light_config_t defaults = SLEEP_AUTO_LIGHT_CONFIG_DEFAULT();
+    if (config == NULL) {
+        config = &defaults;
+    }
+    if (config->check_ms == 0 || pdMS_TO_TICKS(config->check_ms) == 0) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    sleep_mode_auto_light_disable();
+    portENTER_CRITICAL(&light.lock);
+    light.config = *config;
+    memset(&light.stats, 0, sizeof(light.stats));
+    portEXIT_CRITICAL(&light.lock);
+    light.idle_since_us = esp_timer_get_time();
+
+    microusc_work_id_t id;
+    const esp_err_t ret = microusc_post_periodic(light_sleep_check, NULL, pdMS_TO_TICKS(config->check_ms), &id);
+    if (ret != ESP_OK) {
+        return ret;
+    }
+    portENTER_CRITICAL(&light.lock);
+    light.check = id;
+    portEXIT_CRITICAL(&light.lock);
+    ESP_LOGI(TAG, "Automatic light sleep after %" PRIu32 " ms idle", config->idle_ms);
+    return ESP_OK;
+}
+
+void sleep_mode_auto_light_disable(void)
+{
+    portENTER_CRITICAL(&light.lock);
+    const microusc_work_id_t id = light.check;
+    light.check = 0;
+    portEXIT_CRITICAL(&light.lock);
+    if (id != 0) {
+        microusc_cancel_work(id);
+    }
+}
+
+void sleep_mode_auto_light_print(void)
+{
+    sleep_auto_light_stats_t s;
+    sleep_mode_auto_light_stats(&s);
+    ESP_LOGI(TAG, "light sleep: %" PRIu32 " sleeps, %llu us asleep, %" PRIu32 " UART wakes, %" PRIu32 " timer wakes, %" PRIu32 " busy checks",
+             s.sleeps, (unsigned long long)s.slept_us, s.uart_wakes, s.timer_wakes, s.busy);
+
+    xSemaphoreTake(driver_system.lock, portMAX_DELAY);
+    struct usc_driverList *item, *tmp;
+    list_for_each_entry_safe(item, tmp, &driver_system.driver_list.list, list) {
+        usc_driver_stats_t stats;
+        if (usc_driver_get_stats(&item->driver, &stats) != ESP_OK || stats.sleep_wakes == 0) {
+            continue;
+        }
+        ESP_LOGI(TAG, "%s wake to first frame: %" PRIu32 " times, avg %llu us, max %" PRIu32 " us",
+                 item->driver.driver_name, stats.sleep_wakes,
+                 (unsigned long long)(stats.sleep_wake_us / stats.sleep_wakes), stats.sleep_wake_max_us);
+    }
+    xSemaphoreGive(driver_system.lock);
+}
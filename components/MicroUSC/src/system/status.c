@@ -1,14 +1,21 @@
 #include "MicroUSC/system/status.h"
 #include "MicroUSC/internal/driverList.h"
 #include "MicroUSC/USCdriver.h"
+#include "MicroUSC/system/crash_log.h"
 #include "esp_chip_info.h"
 #include "esp_system.h"
+#include "esp_timer.h"
+#include <inttypes.h>
+#include <string.h>
 
 #define TAG "[STATUS]"
 #define MEMORY_TAG "[MEMORY]"
 
+/* A reader iteration holds the lock for one 10 ms read, wait out a few of them at most */
+#define STATUS_LOCK_WAIT pdMS_TO_TICKS(50)
+
 // best to save SRAM for the esp32 which is essentail, log(n) time complexity
-static char *status_str(usc_status_t status)
+static const char *status_str(usc_status_t status)
 {
     switch (status) {
         case NOT_CONNECTED:         return "NOT_CONNECTED";
@@ -28,68 +35,322 @@ static char *status_str(usc_status_t status)
     }
 }
 
-void usc_print_driver_configurations(void)
+#if CONFIG_FREERTOS_GENERATE_RUN_TIME_STATS
+/**
+ * @brief Share of one core a task used since its previous sample, in permille.
+ */
+static uint16_t cpu_permille(const TaskHandle_t task, configRUN_TIME_COUNTER_TYPE *previous,
+                             const configRUN_TIME_COUNTER_TYPE elapsed)
+{
+    if (task == NULL || elapsed == 0) {
+        return 0;
+    }
+    const configRUN_TIME_COUNTER_TYPE now = ulTaskGetRunTimeCounter(task);
+    const uint64_t used = (configRUN_TIME_COUNTER_TYPE)(now - *previous);
+    *previous = now;
+    return (used >= elapsed) ? 1000 : (uint16_t)(used * 1000 / elapsed);
+}
+#endif
+
+/**
+ * @brief Copy one driver into a snapshot record.
+ *
+ * Name and pins are fixed at install time and read without the lock; the state and CPU
+ * samples are copied under it, the counters are atomic.
+ */
+static void capture_driver(struct usc_driver_t *driver, usc_status_record_t *out)
+{
+    memset(out, 0, sizeof(*out));
+    strncpy(out->name, driver->driver_name, sizeof(out->name) - 1);
+    out->port = (uint8_t)driver->port_config.port;
+    out->tx_pin = (int8_t)driver->port_config.tx;
+    out->rx_pin = (int8_t)driver->port_config.rx;
+    out->baud_rate = driver->uart_config.baud_rate;
+
+    if (xSemaphoreTake(driver->sync_signal, STATUS_LOCK_WAIT) == pdTRUE) {
+        out->status = (uint8_t)driver->status;
+#if CONFIG_FREERTOS_GENERATE_RUN_TIME_STATS
+        const configRUN_TIME_COUNTER_TYPE now = portGET_RUN_TIME_COUNTER_VALUE();
+        const configRUN_TIME_COUNTER_TYPE elapsed = now - driver->cpu_sample.total;
+        driver->cpu_sample.total = now;
+        /* A deactivated reader is suspended, and only usc_driver_deinit() deletes it */
+        out->reader_cpu_permille = cpu_permille(driver->uart_reader.active ? driver->uart_reader.task : NULL,
+                                                &driver->cpu_sample.reader, elapsed);
+        out->processor_cpu_permille = cpu_permille(driver->uart_processor.task, &driver->cpu_sample.processor, elapsed);
+#else
+        out->reader_cpu_permille = USC_STATUS_CPU_UNAVAILABLE;
+        out->processor_cpu_permille = USC_STATUS_CPU_UNAVAILABLE;
+#endif
+        xSemaphoreGive(driver->sync_signal);
+    }
+    else {
+        out->flags |= USC_STATUS_LOCK_BUSY;
+        out->reader_cpu_permille = USC_STATUS_CPU_UNAVAILABLE;
+        out->processor_cpu_permille = USC_STATUS_CPU_UNAVAILABLE;
+    }
+
+    usc_driver_stats_t stats;
+    usc_driver_get_stats(driver, &stats);
+    out->wakes = stats.wakes;
+    out->wake_avg_us = stats.wakes ? (uint32_t)(stats.wake_us / stats.wakes) : 0;
+    out->wake_max_us = stats.wake_max_us;
+    out->frames_rx = stats.frames_rx;
+    out->frames_tx = stats.frames_tx;
+    out->parse_errors = stats.parse_errors;
+    out->queue_drops = stats.queue_drops;
+}
+
+static const char *record_status_str(const usc_status_record_t *record)
+{
+    return (record->flags & USC_STATUS_LOCK_BUSY) ? "LOCK_BUSY" : status_str((usc_status_t)record->status);
+}
+
+static void capture_system(usc_status_header_t *header)
+{
+    esp_chip_info_t chip_info;
+    esp_chip_info(&chip_info);
+    header->chip_model = (uint8_t)chip_info.model;
+    header->chip_cores = chip_info.cores;
+    header->chip_revision = chip_info.revision;
+    header->chip_features = chip_info.features;
+    header->sections |= USC_STATUS_SYSTEM;
+}
+
+static void capture_memory(usc_status_header_t *header)
 {
-    int i = 0;
+    // DMA memory is required for hardware DMA operations and is typically limited,
+    // internal memory is fast SRAM, preferred for performance-critical operations
+#ifdef __XTENSA__
+    header->dma_total = heap_caps_get_total_size(MALLOC_CAP_DMA);
+    header->dma_free = heap_caps_get_free_size(MALLOC_CAP_DMA);
+    header->internal_total = heap_caps_get_total_size(MALLOC_CAP_INTERNAL);
+    header->internal_free = heap_caps_get_free_size(MALLOC_CAP_INTERNAL);
+    header->sections |= USC_STATUS_MEMORY;
+#else
+    (void)header;
+#endif
+}
+
+size_t usc_status_capture(uint8_t sections, void *buffer, size_t size)
+{
+    if (buffer == NULL || size < sizeof(usc_status_header_t)) {
+        return 0;
+    }
+
+    usc_status_header_t header = {
+        .magic = USC_STATUS_MAGIC,
+        .version = USC_STATUS_VERSION,
+        .record_size = sizeof(usc_status_record_t),
+        .uptime_ms = (uint32_t)(esp_timer_get_time() / 1000),
+    };
+    if (sections & USC_STATUS_SYSTEM) {
+        capture_system(&header);
+    }
+    if (sections & USC_STATUS_MEMORY) {
+        capture_memory(&header);
+    }
+
+    size_t len = sizeof(header);
+    if (sections & USC_STATUS_DRIVERS) {
+        header.sections |= USC_STATUS_DRIVERS;
+        struct usc_driverList *current, *tmp;
+        xSemaphoreTake(driver_system.lock, portMAX_DELAY); /* usc_driver_deinit() frees nodes */
+        list_for_each_entry_safe(current, tmp, &driver_system.driver_list.list, list) {
+            if (len + sizeof(usc_status_record_t) > size) {
+                break;
+            }
+            usc_status_record_t record;
+            capture_driver(&current->driver, &record);
+            memcpy((uint8_t *)buffer + len, &record, sizeof(record));
+            len += sizeof(record);
+            header.driver_count++;
+        }
+        xSemaphoreGive(driver_system.lock);
+    }
+
+    header.size = (uint16_t)len;
+    memcpy(buffer, &header, sizeof(header));
+    return len;
+}
+
+size_t usc_get_driver_status(usc_driver_status_t *status, size_t max)
+{
+    if (status == NULL) {
+        return 0;
+    }
+
+    size_t count = 0;
     struct usc_driverList *current, *tmp;
+    xSemaphoreTake(driver_system.lock, portMAX_DELAY);
     list_for_each_entry_safe(current, tmp, &driver_system.driver_list.list, list) {
-        struct usc_driver_t *driver = &current->driver;
-        SemaphoreHandle_t lock = driver->sync_signal;
-        if (xSemaphoreTake(lock, SEMAPHORE_WAIT_TIME) == pdTRUE) {
-            printf("%s       %s", "DRIVER",  driver->driver_name);
-            printf("%s     %d", "Baud Rate",  driver->uart_config.baud_rate);
-            printf("%s        %s", "Status",  status_str(driver->status));
-            printf("%s     %d", "UART Port",  driver->port_config.port);
-            printf("%s   %d", "UART TX Pin",  driver->port_config.tx);
-            printf("%s   %d", "UART RX Pin",  driver->port_config.rx);
-            printf("%s", "--------");
-            xSemaphoreGive(lock);
-            i++;
+        if (count == max) {
+            break;
         }
-        else {
-            ESP_LOGE(TAG, "Could not get lock for driver");
+        usc_status_record_t record;
+        capture_driver(&current->driver, &record);
+
+        usc_driver_status_t *s = &status[count++];
+        memcpy(s->name, record.name, sizeof(s->name));
+        s->status = record_status_str(&record);
+        s->port = record.port;
+        s->tx_pin = record.tx_pin;
+        s->rx_pin = record.rx_pin;
+        s->baud_rate = record.baud_rate;
+        s->reader_cpu_permille = record.reader_cpu_permille;
+        s->processor_cpu_permille = record.processor_cpu_permille;
+        s->wakes = record.wakes;
+        s->wake_avg_us = record.wake_avg_us;
+        s->wake_max_us = record.wake_max_us;
+    }
+    xSemaphoreGive(driver_system.lock);
+    return count;
+}
+
+static void print_system(const usc_status_header_t *header)
+{
+    printf("ESP32 Chip Info:\n");
+    printf("  Model: %s\n", header->chip_model == CHIP_ESP32 ? "ESP32" : "Other");
+    printf("  Cores: %u\n", header->chip_cores);
+    printf("  Features: WiFi%s%s\n",
+           (header->chip_features & CHIP_FEATURE_BT) ? "/BT" : "",
+           (header->chip_features & CHIP_FEATURE_BLE) ? "/BLE" : "");
+}
+
+static void print_memory(const usc_status_header_t *header)
+{
+    printf(" %s DMA capable memory:\n", MEMORY_TAG);
+    printf(" %s  Total: %" PRIu32 " bytes\n", MEMORY_TAG, header->dma_total);
+    printf(" %s  Free: %" PRIu32 " bytes\n", MEMORY_TAG, header->dma_free);
+    printf(" %s Internal memory:\n", MEMORY_TAG);
+    printf(" %s  Total: %" PRIu32 " bytes\n", MEMORY_TAG, header->internal_total);
+    printf(" %s  Free: %" PRIu32 " bytes\n", MEMORY_TAG, header->internal_free);
+}
+
+static void print_record(const usc_status_record_t *r)
+{
+    printf("%s       %.*s\n", "DRIVER", (int)sizeof(r->name), r->name);
+    printf("%s    %" PRIu32 "\n", "Baud Rate",  r->baud_rate);
+    printf("%s       %s\n", "Status",  record_status_str(r));
+    printf("%s    %u\n", "UART Port",  r->port);
+    printf("%s  %d\n", "UART TX Pin",  r->tx_pin);
+    printf("%s  %d\n", "UART RX Pin",  r->rx_pin);
+    if (r->reader_cpu_permille != USC_STATUS_CPU_UNAVAILABLE) {
+        printf("%s   %u.%u%%\n", "Reader CPU", r->reader_cpu_permille / 10, r->reader_cpu_permille % 10);
+        printf("%s    %u.%u%%\n", "Proc. CPU", r->processor_cpu_permille / 10, r->processor_cpu_permille % 10);
+    }
+    printf("%s      avg %" PRIu32 " us, max %" PRIu32 " us (%" PRIu32 " wakes)\n", "Wake-up",
+           r->wake_avg_us, r->wake_max_us, r->wakes);
+    printf("%s       rx %" PRIu32 ", tx %" PRIu32 ", %" PRIu32 " bad, %" PRIu32 " dropped\n", "Frames",
+           r->frames_rx, r->frames_tx, r->parse_errors, r->queue_drops);
+    printf("%s\n", "--------");
+}
+
+esp_err_t usc_status_print(const void *snapshot, size_t len)
+{
+    if (snapshot == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (len < sizeof(usc_status_header_t)) {
+        return ESP_ERR_INVALID_SIZE;
+    }
+
+    usc_status_header_t header;
+    memcpy(&header, snapshot, sizeof(header));
+    if (header.magic != USC_STATUS_MAGIC || header.version != USC_STATUS_VERSION) {
+        return ESP_ERR_INVALID_VERSION;
+    }
+    if (header.size > len || header.record_size < sizeof(usc_status_record_t) ||
+        sizeof(header) + (size_t)header.driver_count * header.record_size > header.size) {
+        return ESP_ERR_INVALID_SIZE;
+    }
+
+    if (header.sections & USC_STATUS_SYSTEM) {
+        print_system(&header);
+    }
+    if (header.sections & USC_STATUS_MEMORY) {
+        print_memory(&header);
+    }
+    const uint8_t *records = (const uint8_t *)snapshot + sizeof(header);
+    for (size_t i = 0; i < header.driver_count; i++) {
+        usc_status_record_t record;
+        memcpy(&record, records + i * header.record_size, sizeof(record));
+        print_record(&record);
+    }
+    return ESP_OK;
+}
+
+esp_err_t usc_status_send(struct usc_driver_t *driver, const void *snapshot, size_t len)
+{
+    if (driver == NULL || snapshot == NULL || len == 0 || len > 0xFFFFFF) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    const uint8_t *bytes = snapshot;
+    esp_err_t ret = usc_send_data(driver, (USC_STATUS_STREAM_START << 24) | (uint32_t)len);
+    for (size_t i = 0; i < len && ret == ESP_OK; i += 3) {
+        uint32_t word = USC_STATUS_STREAM_DATA << 24;
+        for (size_t j = 0; j < 3 && i + j < len; j++) {
+            word |= (uint32_t)bytes[i + j] << (16 - 8 * j);
         }
+        ret = usc_send_data(driver, word);
     }
+    return ret;
+}
+
+bool usc_status_stream_feed(usc_status_stream_t *stream, uint32_t word)
+{
+    if (stream == NULL || stream->buffer == NULL) {
+        return false;
+    }
+
+    const uint32_t value = word & 0xFFFFFF;
+    switch (word >> 24) {
+        case USC_STATUS_STREAM_START:
+            stream->len = 0;
+            stream->expected = (value <= stream->size) ? value : 0; /* does not fit, ignore its data */
+            return false;
+        case USC_STATUS_STREAM_DATA:
+            if (stream->expected == 0) {
+                return false;
+            }
+            for (int shift = 16; shift >= 0 && stream->len < stream->expected; shift -= 8) {
+                stream->buffer[stream->len++] = (uint8_t)(value >> shift);
+            }
+            if (stream->len < stream->expected) {
+                return false;
+            }
+            stream->expected = 0;
+            return true;
+        default:
+            return false;
+    }
+}
+
+void usc_print_driver_configurations(void)
+{
+    uint8_t snapshot[USC_STATUS_SNAPSHOT_MAX_SIZE];
+    const size_t len = usc_status_capture(USC_STATUS_DRIVERS, snapshot, sizeof(snapshot));
+
+    /* Formatting happens here, after every driver lock was released */
+    usc_status_print(snapshot, len);
     ESP_LOGI(TAG, "Finished literating drivers");
 }
 
 void print_system_info(void) 
 {
-    esp_chip_info_t chip_info;
-    esp_chip_info(&chip_info);
-
-    printf("ESP32 Chip Info:\n");
-    printf("  Model: %s\n", chip_info.model == CHIP_ESP32 ? "ESP32" : "Other");
-    printf("  Cores: %d\n", chip_info.cores);
-    printf("  Features: WiFi%s%s\n", 
-           (chip_info.features & CHIP_FEATURE_BT) ? "/BT" : "",
-           (chip_info.features & CHIP_FEATURE_BLE) ? "/BLE" : "");
+    usc_status_header_t snapshot;
+    const size_t len = usc_status_capture(USC_STATUS_SYSTEM, &snapshot, sizeof(snapshot));
+    usc_status_print(&snapshot, len);
+    microusc_crash_log_print(); /* what happened before the last reset */
 }
 
 void show_memory_usage(void) 
 {
-    // Local macro for consistent logging tag - scoped only to this function    
-    // Query DMA capable memory statistics
-    // DMA memory is required for hardware DMA operations and is typically limited
-    #ifdef __XTENSA__
-    const size_t total_dma = heap_caps_get_total_size(MALLOC_CAP_DMA);
-    const size_t free_dma = heap_caps_get_free_size(MALLOC_CAP_DMA);
-    
-    // Log DMA memory information
-    printf(" %s DMA capable memory:", MEMORY_TAG);
-    printf(" %s  Total: %d bytes", MEMORY_TAG, total_dma);
-    printf(" %s  Free: %d bytes", MEMORY_TAG, free_dma);
-
-    // Query internal SRAM memory statistics
-    // Internal memory is fast SRAM, preferred for performance-critical operations
-    const size_t total_internal = heap_caps_get_total_size(MALLOC_CAP_INTERNAL);
-    const size_t free_internal = heap_caps_get_free_size(MALLOC_CAP_INTERNAL);
-    
-    // Log internal memory information
-    printf(" %s Internal memory:", MEMORY_TAG);
-    printf(" %s  Total: %d bytes", MEMORY_TAG, total_internal);
-    printf(" %s  Free: %d bytes", MEMORY_TAG, free_internal);
-    #else
-    printf(" %s Memory statistics are not available on this platform.", MEMORY_TAG);
-    #endif
-}
\ No newline at end of file
+    usc_status_header_t snapshot;
+    const size_t len = usc_status_capture(USC_STATUS_MEMORY, &snapshot, sizeof(snapshot));
+    if ((snapshot.sections & USC_STATUS_MEMORY) == 0) {
+        printf(" %s Memory statistics are not available on this platform.\n", MEMORY_TAG);
+        return;
+    }
+    usc_status_print(&snapshot, len);
+}
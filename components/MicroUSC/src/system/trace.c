@@ -0,0 +1,213 @@
+#include "MicroUSC/system/trace.h"
+#include "MicroUSC/system/work_queue.h"
+#include "freertos/FreeRTOS.h"
+#include "esp_attr.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include <inttypes.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdio.h>
+
+#define TAG "[MICROUSC TRACE]"
+
+_Static_assert((MICROUSC_TRACE_SIZE & (MICROUSC_TRACE_SIZE - 1)) == 0, "Trace size must be a power of 2");
+#define TRACE_SEQ_VALID ( 0x8000u )             // set in every published seq, 0 means "being written"
+#define TRACE_SEQ_MASK  ( TRACE_SEQ_VALID - 1u ) // position bits kept in a seq
+
+_Static_assert(MICROUSC_TRACE_SIZE <= TRACE_SEQ_MASK, "Trace seq must tell a slot's laps apart");
+
+/*
+ * A slot is published by writing its seq last. The reader copies a slot and keeps it
+ * only if seq is the expected one before and after the copy, so a slot being rewritten
+ * by a writer that lapped the reader is counted as lost instead of returned torn.
+ */
+struct trace_slot {
+    _Atomic uint16_t seq;
+    microusc_trace_record_t record;
+};
+
+struct trace_ring {
+    _Atomic uint32_t head; // next position to claim, only the owning core adds to it
+    uint32_t tail;         // next position to drain, reader only
+    struct trace_slot slots[MICROUSC_TRACE_SIZE];
+};
+
+static struct {
+    struct trace_ring ring[portNUM_PROCESSORS];
+    uint32_t lost;
+    portMUX_TYPE lock; // reader side only, writers never take it
+} trace = {
+    .lock = portMUX_INITIALIZER_UNLOCKED,
+};
+
+/* Seq 0 marks a slot being written, so every published seq has TRACE_SEQ_VALID set */
+static __always_inline uint16_t position_seq(const uint32_t position)
+{
+    return (uint16_t)((position & TRACE_SEQ_MASK) | TRACE_SEQ_VALID);
+}
+
+void IRAM_ATTR microusc_trace_write(uint8_t event, uint8_t driver, uint32_t arg0, uint32_t arg1)
+{
+    struct trace_ring *ring = &trace.ring[xPortGetCoreID()];
+    const uint32_t position = atomic_fetch_add_explicit(&ring->head, 1, memory_order_relaxed);
+    struct trace_slot *slot = &ring->slots[position & (MICROUSC_TRACE_SIZE - 1)];
+
+    atomic_store_explicit(&slot->seq, 0, memory_order_relaxed);
+    atomic_thread_fence(memory_order_release);
+    slot->record.timestamp_us = (uint32_t)esp_timer_get_time();
+    slot->record.seq = position_seq(position);
+    slot->record.event = event;
+    slot->record.driver = driver;
+    slot->record.arg0 = arg0;
+    slot->record.arg1 = arg1;
+    atomic_store_explicit(&slot->seq, position_seq(position), memory_order_release);
+}
+
+/**
+ * @brief Copy one slot if it still holds the record of position.
+ */
+static bool trace_read_slot(const struct trace_ring *ring, const uint32_t position, microusc_trace_record_t *out)
+{
+    const struct trace_slot *slot = &ring->slots[position & (MICROUSC_TRACE_SIZE - 1)];
+    const uint16_t expected = position_seq(position);
+
+    if (atomic_load_explicit(&slot->seq, memory_order_acquire) != expected) {
+        return false; /* not published yet, or already overwritten */
+    }
+    *out = slot->record;
+    atomic_thread_fence(memory_order_acquire);
+    return atomic_load_explicit(&slot->seq, memory_order_relaxed) == expected;
+}
+
+size_t microusc_trace_drain(microusc_trace_record_t *records, uint8_t *cores, size_t max)
+{
+    if (records == NULL) {
+        return 0;
+    }
+
+    uint32_t head[portNUM_PROCESSORS];
+    bool pending[portNUM_PROCESSORS];
+    size_t count = 0;
+
+    portENTER_CRITICAL(&trace.lock);
+    for (int core = 0; core < portNUM_PROCESSORS; core++) {
+        struct trace_ring *ring = &trace.ring[core];
+        head[core] = atomic_load_explicit(&ring->head, memory_order_acquire);
+        if (head[core] - ring->tail > MICROUSC_TRACE_SIZE) {
+            trace.lost += head[core] - ring->tail - MICROUSC_TRACE_SIZE; /* lapped by the writers */
+            ring->tail = head[core] - MICROUSC_TRACE_SIZE;
+        }
+        pending[core] = (ring->tail != head[core]);
+    }
+
+    /* Take the cores in turn so a partial drain still covers the same time span on each */
+    bool progress = true;
+    while (progress && count < max) {
+        progress = false;
+        for (int core = 0; core < portNUM_PROCESSORS && count < max; core++) {
+            struct trace_ring *ring = &trace.ring[core];
+            if (!pending[core]) {
+                continue;
+            }
+
+            if (trace_read_slot(ring, ring->tail, &records[count])) {
+                if (cores != NULL) {
+                    cores[count] = (uint8_t)core;
+                }
+                count++;
+            }
+            else if (atomic_load_explicit(&ring->head, memory_order_relaxed) - ring->tail > MICROUSC_TRACE_SIZE) {
+                trace.lost++; /* overwritten while we were reading */
+            }
+            else {
+                pending[core] = false; /* claimed but not published yet, picked up next time */
+                continue;
+            }
+            ring->tail++;
+            pending[core] = (ring->tail != head[core]);
+            progress = true;
+        }
+    }
+    portEXIT_CRITICAL(&trace.lock);
+    return count;
+}
+
+uint32_t microusc_trace_lost(void)
+{
+    portENTER_CRITICAL(&trace.lock);
+    const uint32_t lost = trace.lost;
+    portEXIT_CRITICAL(&trace.lock);
+    return lost;
+}
+
+static const char *trace_event_str(uint8_t event)
+{
+    switch (event) {
+        case MICROUSC_TRACE_FRAME_RX:      return "FRAME_RX";
+        case MICROUSC_TRACE_FRAME_TX:      return "FRAME_TX";
+        case MICROUSC_TRACE_RESYNC:        return "RESYNC";
+        case MICROUSC_TRACE_WORD_STORED:   return "WORD_STORED";
+        case MICROUSC_TRACE_WORD_DROPPED:  return "WORD_DROPPED";
+        case MICROUSC_TRACE_DISPATCH:      return "DISPATCH";
+        case MICROUSC_TRACE_HANDSHAKE:     return "HANDSHAKE";
+        case MICROUSC_TRACE_SYSTEM_EVENT:  return "SYSTEM_EVENT";
+        case MICROUSC_TRACE_ROUTE:         return "ROUTE";
+        default:                           return (event >= MICROUSC_TRACE_USER) ? "USER" : "UNKNOWN";
+    }
+}
+
+void microusc_trace_print(void)
+{
+    enum { BATCH = 16 };
+    microusc_trace_record_t records[BATCH];
+    uint8_t cores[BATCH];
+    uint8_t order[BATCH];
+    size_t count;
+
+    while ((count = microusc_trace_drain(records, cores, BATCH)) != 0) {
+        /* Merge the cores of this batch by time, insertion sort on indices */
+        for (size_t i = 0; i < count; i++) {
+            size_t pos = i;
+            while (pos > 0 && (int32_t)(records[order[pos - 1]].timestamp_us - records[i].timestamp_us) > 0) {
+                order[pos] = order[pos - 1];
+                pos--;
+            }
+            order[pos] = (uint8_t)i;
+        }
+
+        for (size_t i = 0; i < count; i++) {
+            const microusc_trace_record_t *record = &records[order[i]];
+            printf("%10" PRIu32 " us  cpu%u  %-12s drv %3u  0x%08" PRIx32 " 0x%08" PRIx32 "\n",
+                   record->timestamp_us, cores[order[i]], trace_event_str(record->event),
+                   record->driver, record->arg0, record->arg1);
+        }
+    }
+
+    const uint32_t lost = microusc_trace_lost();
+    if (lost != 0) {
+        ESP_LOGW(TAG, "%" PRIu32 " record(s) lost since boot, drain more often or raise MICROUSC_TRACE_SIZE", lost);
+    }
+}
+
+static void trace_drain_work(void *ctx)
+{
+    microusc_trace_print();
+}
+
+esp_err_t microusc_trace_start_drainer(uint32_t period_ms)
+{
+    static _Atomic bool started = false;
+    if (period_ms == 0) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (atomic_exchange(&started, true)) {
+        return ESP_OK;
+    }
+
+    const esp_err_t ret = microusc_post_periodic(trace_drain_work, NULL, pdMS_TO_TICKS(period_ms), NULL);
+    if (ret != ESP_OK) {
+        atomic_store(&started, false);
+    }
+    return ret;
+}
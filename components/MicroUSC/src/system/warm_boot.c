@@ -0,0 +1,309 @@
+#include "MicroUSC/internal/system/warm_boot.h"
+#include "MicroUSC/internal/system/crash_log.h"
+#include "MicroUSC/system/rtc.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include "esp_app_desc.h"
+#include "esp_log.h"
+#include <string.h>
+#include <sys/time.h>
+
+#define TAG "[WARM BOOT]"
+
+#define WARM_BOOT_HEADER_KEY  ( MICROUSC_RTC_KEY_RESERVED )
+#define WARM_BOOT_DRIVER_KEY(i) ( (char)(MICROUSC_RTC_KEY_RESERVED + 1 + (i)) )
+#define WARM_BOOT_IMAGE_SIZE  ( 8 ) // bytes of the app ELF SHA-256 identifying the image
+
+_Static_assert(DRIVER_MAX <= 8, "warm boot driver mask is 8 bits");
+
+/* Saved in the RTC store, so only valid for the image that wrote them */
+typedef struct {
+    uint8_t image[WARM_BOOT_IMAGE_SIZE];
+    uint32_t session_ttl_ms;
+    uint8_t enabled;
+    uint8_t driver_mask;  // bit per driver index with a saved record
+    uint8_t reserved[2];
+} warm_header_t;
+
+typedef struct {
+    driver_name_t name;
+    uart_config_t uart_config;
+    uart_port_config_t port_config;
+    usc_process_t process;   // address in the image identified by the header
+    uint32_t stack_size;
+    uint64_t session_us;     // wall-clock time of the last handshake, 0 if none
+} warm_driver_t;
+
+static struct {
+    warm_header_t header;
+    warm_driver_t drivers[DRIVER_MAX]; // every installed driver, saved only while enabled
+    uint8_t installed;                 // bit per index in drivers[]
+    uint64_t pending_session_us;       // handed from resume to the next microusc_warm_boot_record()
+    struct {
+        uart_port_t port;
+        usc_process_t process;         // NULL once usc_driver_install() claimed it
+    } restored[DRIVER_MAX];
+    size_t restored_count;
+    SemaphoreHandle_t lock;
+    StaticSemaphore_t lock_buffer;
+} warm;
+
+/* Survives software resets and deep sleep, unlike esp_timer_get_time() */
+static uint64_t now_us(void)
+{
+    struct timeval tv;
+    gettimeofday(&tv, NULL);
+    return (uint64_t)tv.tv_sec * 1000000ULL + (uint64_t)tv.tv_usec;
+}
+
+static void current_image(uint8_t image[WARM_BOOT_IMAGE_SIZE])
+{
+    memcpy(image, esp_app_get_description()->app_elf_sha256, WARM_BOOT_IMAGE_SIZE);
+}
+
+static __always_inline bool session_valid(const warm_driver_t *record, const uint32_t ttl_ms, const uint64_t now)
+{
+    return ttl_ms != 0 && record->session_us != 0 && now >= record->session_us &&
+           now - record->session_us <= (uint64_t)ttl_ms * 1000ULL;
+}
+
+/**
+ * @brief Load the saved header into warm.header.
+ *
+ * @return false when nothing usable was saved.
+ */
+static bool load_header(void)
+{
+    const warm_header_t *saved = get_system_rtc_var(WARM_BOOT_HEADER_KEY);
+    if (saved == NULL || get_system_rtc_var_size(WARM_BOOT_HEADER_KEY) != sizeof(warm_header_t)) {
+        return false;
+    }
+    warm.header = *saved;
+    return true;
+}
+
+static bool load_driver(const UBaseType_t i, warm_driver_t *record)
+{
+    const warm_driver_t *saved = get_system_rtc_var(WARM_BOOT_DRIVER_KEY(i));
+    if (saved == NULL || get_system_rtc_var_size(WARM_BOOT_DRIVER_KEY(i)) != sizeof(warm_driver_t)) {
+        return false;
+    }
+    *record = *saved;
+    record->name[DRIVER_NAME_SIZE - 1] = '\0';
+    return record->process != NULL;
+}
+
+/**
+ * @brief Whether the previous run ended in a MicroUSC error or hang report.
+ *
+ * Both reboot through esp_restart(), so the reset reason alone reads as a planned
+ * software reset. Driver status records may still land between the report and the
+ * restart, so they are skipped.
+ */
+static bool previous_run_failed(void)
+{
+    static microusc_crash_record_t records[MICROUSC_CRASH_LOG_SIZE]; /* only used once, at boot */
+    size_t count = microusc_crash_log_read(true, records, MICROUSC_CRASH_LOG_SIZE);
+    while (count > 0 && records[count - 1].type == MICROUSC_CRASH_DRIVER_STATUS) {
+        count--;
+    }
+    return count > 0 && (records[count - 1].type == MICROUSC_CRASH_ERROR ||
+                         records[count - 1].type == MICROUSC_CRASH_HANG);
+}
+
+size_t microusc_warm_boot_resume(void)
+{
+    if (warm.lock == NULL) {
+        warm.lock = xSemaphoreCreateMutexStatic(&warm.lock_buffer);
+    }
+    if (!load_header() || !warm.header.enabled) {
+        memset(&warm.header, 0, sizeof(warm.header));
+        return 0;
+    }
+
+    /* Take the saved records out before the drivers are installed and saved again */
+    const esp_reset_reason_t reason = microusc_crash_log_reset_reason();
+    uint8_t image[WARM_BOOT_IMAGE_SIZE];
+    current_image(image);
+    const bool same_image = memcmp(image, warm.header.image, WARM_BOOT_IMAGE_SIZE) == 0;
+    const bool failed = reason == ESP_RST_SW && previous_run_failed();
+    const bool resumable = same_image && !failed && (reason == ESP_RST_SW || reason == ESP_RST_DEEPSLEEP);
+
+    warm_driver_t records[DRIVER_MAX];
+    uint8_t mask = 0;
+    for (UBaseType_t i = 0; i < DRIVER_MAX && resumable; i++) {
+        if ((warm.header.driver_mask & BIT(i)) && load_driver(i, &records[i])) {
+            mask |= BIT(i);
+        }
+    }
+    memcpy(warm.header.image, image, WARM_BOOT_IMAGE_SIZE);
+    warm.header.driver_mask = 0;
+    save_system_rtc_var(&warm.header, sizeof(warm.header), WARM_BOOT_HEADER_KEY);
+
+    if (!resumable) {
+        ESP_LOGI(TAG, "Cold boot (%s)", !same_image ? "new firmware image" : failed ? "error reboot" : "reset reason");
+        return 0;
+    }
+
+    const uint64_t now = now_us();
+    size_t sessions = 0;
+    for (UBaseType_t i = 0; i < DRIVER_MAX; i++) {
+        if (!(mask & BIT(i))) {
+            continue;
+        }
+        const warm_driver_t *record = &records[i];
+        const bool has_access = session_valid(record, warm.header.session_ttl_ms, now);
+        warm.pending_session_us = has_access ? record->session_us : 0;
+        esp_err_t ret = usc_driver_install_restored(record->name, record->uart_config, record->port_config,
+                                                    record->process, record->stack_size, has_access);
+        warm.pending_session_us = 0;
+        if (ret != ESP_OK) {
+            ESP_LOGW(TAG, "Could not restore %s: %s", record->name, esp_err_to_name(ret));
+            continue;
+        }
+        warm.restored[warm.restored_count].port = record->port_config.port;
+        warm.restored[warm.restored_count].process = record->process;
+        warm.restored_count++;
+        sessions += has_access;
+    }
+
+    ESP_LOGI(TAG, "Restored %u driver(s), %u without a handshake",
+             (unsigned)warm.restored_count, (unsigned)sessions);
+    return warm.restored_count;
+}
+
+/**
+ * @brief Write one driver's record, and the header if the driver is new to it.
+ *
+ * Must be called with warm.lock held and warm boot enabled.
+ */
+static esp_err_t save_driver(const UBaseType_t i)
+{
+    esp_err_t ret = save_system_rtc_var(&warm.drivers[i], sizeof(warm_driver_t), WARM_BOOT_DRIVER_KEY(i));
+    if (ret == ESP_OK && !(warm.header.driver_mask & BIT(i))) {
+        warm.header.driver_mask |= BIT(i);
+        ret = save_system_rtc_var(&warm.header, sizeof(warm.header), WARM_BOOT_HEADER_KEY);
+    }
+    return ret;
+}
+
+void microusc_warm_boot_record(const struct usc_driver_t *driver)
+{
+    const UBaseType_t i = driver->priority;
+    if (warm.lock == NULL || i >= DRIVER_MAX) {
+        return;
+    }
+
+    esp_err_t ret = ESP_OK;
+    xSemaphoreTake(warm.lock, portMAX_DELAY);
+    {
+        warm_driver_t *record = &warm.drivers[i];
+        memset(record, 0, sizeof(*record));
+        memcpy(record->name, driver->driver_name, DRIVER_NAME_SIZE);
+        record->uart_config = driver->uart_config;
+        record->port_config = driver->port_config;
+        record->process = driver->uart_processor.process;
+        record->stack_size = (uint32_t)driver->uart_processor.stack_size;
+        record->session_us = warm.pending_session_us; /* a restored session keeps its age */
+        warm.installed |= BIT(i);
+        if (warm.header.enabled) {
+            ret = save_driver(i);
+        }
+    }
+    xSemaphoreGive(warm.lock);
+
+    if (ret != ESP_OK) {
+        ESP_LOGW(TAG, "%s will not be restored: %s", driver->driver_name, esp_err_to_name(ret));
+    }
+}
+
+void microusc_warm_boot_session(const struct usc_driver_t *driver)
+{
+    const UBaseType_t i = driver->priority;
+    if (warm.lock == NULL || i >= DRIVER_MAX) {
+        return;
+    }
+
+    xSemaphoreTake(warm.lock, portMAX_DELAY);
+    warm.drivers[i].session_us = now_us();
+    if (warm.header.enabled && (warm.header.driver_mask & BIT(i))) {
+        save_system_rtc_var(&warm.drivers[i], sizeof(warm_driver_t), WARM_BOOT_DRIVER_KEY(i));
+    }
+    xSemaphoreGive(warm.lock);
+}
+
+void microusc_warm_boot_forget(const struct usc_driver_t *driver)
+{
+    const UBaseType_t i = driver->priority;
+    if (warm.lock == NULL || i >= DRIVER_MAX) {
+        return;
+    }
+
+    xSemaphoreTake(warm.lock, portMAX_DELAY);
+    warm.installed &= ~BIT(i);
+    if (warm.header.driver_mask & BIT(i)) {
+        warm.header.driver_mask &= ~BIT(i);
+        save_system_rtc_var(&warm.header, sizeof(warm.header), WARM_BOOT_HEADER_KEY);
+    }
+    for (size_t r = 0; r < warm.restored_count; r++) {
+        if (warm.restored[r].port == driver->port_config.port) {
+            warm.restored[r].process = NULL; /* installing the port again really installs it */
+        }
+    }
+    xSemaphoreGive(warm.lock);
+}
+
+bool microusc_warm_boot_restored_port(uart_port_t port, usc_process_t process)
+{
+    for (size_t i = 0; i < warm.restored_count; i++) {
+        if (warm.restored[i].port == port && warm.restored[i].process != NULL &&
+            warm.restored[i].process == process) {
+            warm.restored[i].process = NULL; /* claimed once, a second install is a real duplicate */
+            return true;
+        }
+    }
+    return false;
+}
+
+esp_err_t usc_warm_boot_enable(uint32_t session_ttl_ms)
+{
+    if (warm.lock == NULL) {
+        ESP_LOGE(TAG, "init_MicroUSC_system() has not run");
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    esp_err_t ret = ESP_OK;
+    xSemaphoreTake(warm.lock, portMAX_DELAY);
+    {
+        current_image(warm.header.image);
+        warm.header.session_ttl_ms = session_ttl_ms;
+        warm.header.enabled = true;
+        ret = save_system_rtc_var(&warm.header, sizeof(warm.header), WARM_BOOT_HEADER_KEY);
+        for (UBaseType_t i = 0; i < DRIVER_MAX && ret == ESP_OK; i++) {
+            if (warm.installed & BIT(i)) {
+                ret = save_driver(i);
+            }
+        }
+    }
+    xSemaphoreGive(warm.lock);
+    return ret;
+}
+
+void usc_warm_boot_disable(void)
+{
+    if (warm.lock == NULL) {
+        return;
+    }
+    xSemaphoreTake(warm.lock, portMAX_DELAY);
+    if (warm.header.enabled) {
+        warm.header.enabled = false;
+        warm.header.driver_mask = 0;
+        save_system_rtc_var(&warm.header, sizeof(warm.header), WARM_BOOT_HEADER_KEY);
+    }
+    xSemaphoreGive(warm.lock);
+}
+
+size_t usc_warm_boot_restored(void)
+{
+    return warm.restored_count;
+}
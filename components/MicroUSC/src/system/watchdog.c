@@ -0,0 +1,172 @@
+#include "MicroUSC/system/watchdog.h"
+#include "MicroUSC/system/work_queue.h"
+#include "MicroUSC/system/manager.h"
+#include "MicroUSC/internal/system/crash_log.h"
+#include "esp_log.h"
+#include <inttypes.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <string.h>
+
+#define TAG "[MICROUSC WATCHDOG]"
+
+struct watchdog_entry {
+    TaskHandle_t task;
+    char name[MICROUSC_WATCHDOG_NAME_LEN];
+    TickType_t timeout;
+    _Atomic uint32_t last_feed;  // tick count of the last heartbeat
+    _Atomic bool reported;       // hang already reported, cleared by the next feed
+    bool used;
+};
+
+static struct {
+    struct watchdog_entry table[MICROUSC_WATCHDOG_MAX];
+    microusc_watchdog_hang_t last_hang;
+    uint32_t hang_count;
+    _Atomic bool check_started;
+    portMUX_TYPE lock;
+} watchdog = {
+    .lock = portMUX_INITIALIZER_UNLOCKED,
+};
+
+void microusc_watchdog_feed(microusc_watchdog_id_t id)
+{
+    if (id == 0 || id > MICROUSC_WATCHDOG_MAX) {
+        return;
+    }
+    struct watchdog_entry *entry = &watchdog.table[id - 1];
+    atomic_store_explicit(&entry->last_feed, xTaskGetTickCount(), memory_order_relaxed);
+    atomic_store_explicit(&entry->reported, false, memory_order_relaxed);
+}
+
+/**
+ * @brief Capture a silent task's state, log it and hand it to the error handler.
+ */
+static void watchdog_report(const struct watchdog_entry *entry, int slot, TaskHandle_t task, eTaskState state, TickType_t silent)
+{
+    microusc_watchdog_hang_t hang = {
+        .task = task,
+        .state = state,
+        .priority = uxTaskPriorityGet(task),
+        .stack_high_water = uxTaskGetStackHighWaterMark(task),
+        .silent_ms = silent * portTICK_PERIOD_MS,
+    };
+    memcpy(hang.name, entry->name, sizeof(hang.name));
+
+    portENTER_CRITICAL(&watchdog.lock);
+    hang.hang_count = ++watchdog.hang_count;
+    watchdog.last_hang = hang;
+    portEXIT_CRITICAL(&watchdog.lock);
+
+    ESP_LOGE(TAG, "Task %s silent for %" PRIu32 " ms (state %d, priority %u, stack left %u words)",
+             hang.name, hang.silent_ms, (int)hang.state, (unsigned)hang.priority, (unsigned)hang.stack_high_water);
+
+    microusc_crash_log_record(MICROUSC_CRASH_HANG, (uint8_t)state, (uint8_t)(slot + 1), hang.silent_ms);
+    send_microusc_system_status(USC_SYSTEM_ERROR);
+}
+
+/* Periodic work on the system task */
+static void watchdog_check(void *ctx)
+{
+    const TickType_t now = xTaskGetTickCount();
+
+    for (int i = 0; i < MICROUSC_WATCHDOG_MAX; i++) {
+        struct watchdog_entry *entry = &watchdog.table[i];
+        TaskHandle_t task;
+        TickType_t timeout;
+
+        portENTER_CRITICAL(&watchdog.lock);
+        task = entry->used ? entry->task : NULL;
+        timeout = entry->timeout;
+        portEXIT_CRITICAL(&watchdog.lock);
+
+        if (task == NULL || atomic_load_explicit(&entry->reported, memory_order_relaxed)) {
+            continue;
+        }
+
+        const eTaskState state = eTaskGetState(task);
+        if (state == eSuspended || state == eDeleted) {
+            microusc_watchdog_feed((microusc_watchdog_id_t)(i + 1)); /* paused on purpose, restart the window */
+            continue;
+        }
+
+        const TickType_t silent = now - (TickType_t)atomic_load_explicit(&entry->last_feed, memory_order_relaxed);
+        if (silent > timeout) {
+            atomic_store_explicit(&entry->reported, true, memory_order_relaxed);
+            watchdog_report(entry, i, task, state, silent);
+        }
+    }
+}
+
+esp_err_t microusc_watchdog_add(TaskHandle_t task, const char *name, uint32_t timeout_ms, microusc_watchdog_id_t *id)
+{
+    if (id == NULL || timeout_ms < MICROUSC_WATCHDOG_CHECK_MS) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (task == NULL) {
+        task = xTaskGetCurrentTaskHandle();
+    }
+
+    /* The table is checked by one periodic work item, started with the first task */
+    if (!atomic_exchange(&watchdog.check_started, true)) {
+        const esp_err_t ret = microusc_post_periodic(watchdog_check, NULL, pdMS_TO_TICKS(MICROUSC_WATCHDOG_CHECK_MS), NULL);
+        if (ret != ESP_OK) {
+            atomic_store(&watchdog.check_started, false);
+            return ret;
+        }
+    }
+
+    int slot = -1;
+    portENTER_CRITICAL(&watchdog.lock);
+    for (int i = 0; i < MICROUSC_WATCHDOG_MAX; i++) {
+        struct watchdog_entry *entry = &watchdog.table[i];
+        if (!entry->used) {
+            entry->task = task;
+            entry->timeout = pdMS_TO_TICKS(timeout_ms);
+            strncpy(entry->name, (name != NULL) ? name : "", sizeof(entry->name) - 1);
+            entry->name[sizeof(entry->name) - 1] = '\0';
+            atomic_store(&entry->last_feed, xTaskGetTickCount());
+            atomic_store(&entry->reported, false);
+            entry->used = true;
+            slot = i;
+            break;
+        }
+    }
+    portEXIT_CRITICAL(&watchdog.lock);
+
+    if (slot < 0) {
+        ESP_LOGE(TAG, "Watchdog table is full (%d tasks)", MICROUSC_WATCHDOG_MAX);
+        return ESP_ERR_NO_MEM;
+    }
+    *id = (microusc_watchdog_id_t)(slot + 1);
+    return ESP_OK;
+}
+
+esp_err_t microusc_watchdog_remove(microusc_watchdog_id_t id)
+{
+    if (id == 0) {
+        return ESP_OK;
+    }
+    if (id > MICROUSC_WATCHDOG_MAX) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    portENTER_CRITICAL(&watchdog.lock);
+    watchdog.table[id - 1].used = false;
+    watchdog.table[id - 1].task = NULL;
+    portEXIT_CRITICAL(&watchdog.lock);
+    return ESP_OK;
+}
+
+esp_err_t microusc_watchdog_last_hang(microusc_watchdog_hang_t *hang)
+{
+    esp_err_t ret = ESP_ERR_NOT_FOUND;
+
+    portENTER_CRITICAL(&watchdog.lock);
+    if (watchdog.hang_count != 0) {
+        *hang = watchdog.last_hang;
+        ret = ESP_OK;
+    }
+    portEXIT_CRITICAL(&watchdog.lock);
+    return ret;
+}
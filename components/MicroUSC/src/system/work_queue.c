@@ -0,0 +1,259 @@
+#include "MicroUSC/internal/system/work_queue.h"
+#include "MicroUSC/internal/system/event_queue.h"
+#include "MicroUSC/system/memory_pool.h"
+#include "freertos/task.h"
+#include "esp_log.h"
+#include <stdbool.h>
+#include <string.h>
+
+#define TAG "[MICROUSC WORK]"
+
+struct microusc_work {
+    microusc_work_fn_t fn;
+    void *ctx;
+    TickType_t deadline;
+    TickType_t period;   // 0 for one-shot work
+    uint32_t seq;        // posting order, breaks deadline ties
+    microusc_work_id_t id;
+};
+
+static struct {
+    memory_pool_t pool;
+    struct microusc_work *heap[MICROUSC_WORK_MAX]; // min-heap ordered by deadline
+    size_t count;
+    uint32_t next_seq;
+    microusc_work_id_t next_id;
+    microusc_work_id_t running_id;                 // item currently executing on the system task
+    bool running_cancelled;
+    bool initialized;
+    portMUX_TYPE lock;
+} work_queue = {
+    .lock = portMUX_INITIALIZER_UNLOCKED,
+};
+
+static __always_inline bool work_before(const struct microusc_work *a, const struct microusc_work *b)
+{
+    /* Signed difference keeps the order correct across tick counter wraparound */
+    const int32_t diff = (int32_t)(a->deadline - b->deadline);
+    if (diff != 0) {
+        return diff < 0;
+    }
+    return (int32_t)(a->seq - b->seq) < 0;
+}
+
+static void heap_sift_up(size_t i)
+{
+    struct microusc_work *item = work_queue.heap[i];
+    while (i > 0) {
+        const size_t parent = (i - 1) / 2;
+        if (!work_before(item, work_queue.heap[parent])) {
+            break;
+        }
+        work_queue.heap[i] = work_queue.heap[parent];
+        i = parent;
+    }
+    work_queue.heap[i] = item;
+}
+
+static void heap_sift_down(size_t i)
+{
+    struct microusc_work *item = work_queue.heap[i];
+    while (1) {
+        size_t child = 2 * i + 1;
+        if (child >= work_queue.count) {
+            break;
+        }
+        if (child + 1 < work_queue.count && work_before(work_queue.heap[child + 1], work_queue.heap[child])) {
+            child++;
+        }
+        if (!work_before(work_queue.heap[child], item)) {
+            break;
+        }
+        work_queue.heap[i] = work_queue.heap[child];
+        i = child;
+    }
+    work_queue.heap[i] = item;
+}
+
+/* All heap helpers below must be called with work_queue.lock held */
+
+static void heap_push(struct microusc_work *item)
+{
+    item->seq = work_queue.next_seq++;
+    work_queue.heap[work_queue.count] = item;
+    heap_sift_up(work_queue.count++);
+}
+
+static void heap_remove(size_t i)
+{
+    work_queue.count--;
+    if (i == work_queue.count) {
+        return;
+    }
+    work_queue.heap[i] = work_queue.heap[work_queue.count];
+    heap_sift_down(i);
+    heap_sift_up(i);
+}
+
+esp_err_t microusc_work_init(void)
+{
+    if (work_queue.initialized) {
+        return ESP_OK;
+    }
+    if (!memory_pool_init(&work_queue.pool, sizeof(struct microusc_work), MICROUSC_WORK_MAX)) {
+        return ESP_ERR_NO_MEM;
+    }
+    work_queue.count = 0;
+    work_queue.next_id = 1;
+    work_queue.initialized = true;
+    return ESP_OK;
+}
+
+static esp_err_t microusc_work_schedule( microusc_work_fn_t fn,
+                                         void *ctx,
+                                         TickType_t delay,
+                                         TickType_t period,
+                                         microusc_work_id_t *id
+) {
+    if (fn == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (!work_queue.initialized) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    bool is_next = false;
+    struct microusc_work *item;
+
+    portENTER_CRITICAL(&work_queue.lock);
+    {
+        item = memory_pool_alloc(&work_queue.pool);
+        if (item != NULL) {
+            item->fn = fn;
+            item->ctx = ctx;
+            item->deadline = xTaskGetTickCount() + delay;
+            item->period = period;
+            item->id = work_queue.next_id++;
+            if (work_queue.next_id == 0) {
+                work_queue.next_id = 1; /* 0 stays invalid */
+            }
+            heap_push(item);
+            is_next = (work_queue.heap[0] == item);
+            if (id != NULL) {
+                *id = item->id;
+            }
+        }
+    }
+    portEXIT_CRITICAL(&work_queue.lock);
+
+    if (item == NULL) {
+        ESP_LOGE(TAG, "Work pool exhausted (%d items)", MICROUSC_WORK_MAX);
+        return ESP_ERR_NO_MEM;
+    }
+
+    /* The system task only needs to recompute its timeout if the earliest deadline changed */
+    if (is_next) {
+        microusc_event_queue_kick();
+    }
+    return ESP_OK;
+}
+
+esp_err_t microusc_post_work(microusc_work_fn_t fn, void *ctx)
+{
+    return microusc_work_schedule(fn, ctx, 0, 0, NULL);
+}
+
+esp_err_t microusc_post_delayed(microusc_work_fn_t fn, void *ctx, TickType_t delay, microusc_work_id_t *id)
+{
+    return microusc_work_schedule(fn, ctx, delay, 0, id);
+}
+
+esp_err_t microusc_post_periodic(microusc_work_fn_t fn, void *ctx, TickType_t period, microusc_work_id_t *id)
+{
+    if (period == 0) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    return microusc_work_schedule(fn, ctx, period, period, id);
+}
+
+esp_err_t microusc_cancel_work(microusc_work_id_t id)
+{
+    esp_err_t ret = ESP_ERR_NOT_FOUND;
+    if (id == 0) {
+        return ret;
+    }
+
+    portENTER_CRITICAL(&work_queue.lock);
+    {
+        if (id == work_queue.running_id) {
+            work_queue.running_cancelled = true; /* not rescheduled once it returns */
+            ret = ESP_OK;
+        }
+        else {
+            for (size_t i = 0; i < work_queue.count; i++) {
+                struct microusc_work *item = work_queue.heap[i];
+                if (item->id == id) {
+                    heap_remove(i);
+                    memory_pool_free(&work_queue.pool, item);
+                    ret = ESP_OK;
+                    break;
+                }
+            }
+        }
+    }
+    portEXIT_CRITICAL(&work_queue.lock);
+    return ret;
+}
+
+TickType_t microusc_work_next_timeout(void)
+{
+    TickType_t timeout = portMAX_DELAY;
+
+    portENTER_CRITICAL(&work_queue.lock);
+    if (work_queue.count != 0) {
+        const int32_t remaining = (int32_t)(work_queue.heap[0]->deadline - xTaskGetTickCount());
+        timeout = (remaining > 0) ? (TickType_t)remaining : 0;
+    }
+    portEXIT_CRITICAL(&work_queue.lock);
+
+    return timeout;
+}
+
+void microusc_work_run_due(void)
+{
+    for (int run = 0; run < MICROUSC_WORK_MAX; run++) {
+        struct microusc_work *item = NULL;
+
+        portENTER_CRITICAL(&work_queue.lock);
+        if (work_queue.count != 0 && (int32_t)(work_queue.heap[0]->deadline - xTaskGetTickCount()) <= 0) {
+            item = work_queue.heap[0];
+            heap_remove(0);
+            work_queue.running_id = item->id;
+            work_queue.running_cancelled = false;
+        }
+        portEXIT_CRITICAL(&work_queue.lock);
+
+        if (item == NULL) {
+            return;
+        }
+
+        item->fn(item->ctx); /* outside the lock, the function may post or cancel work */
+
+        portENTER_CRITICAL(&work_queue.lock);
+        {
+            if (item->period != 0 && !work_queue.running_cancelled) {
+                const TickType_t now = xTaskGetTickCount();
+                item->deadline += item->period;
+                if ((int32_t)(item->deadline - now) <= 0) {
+                    item->deadline = now + item->period; /* late, skip the missed runs */
+                }
+                heap_push(item);
+            }
+            else {
+                memory_pool_free(&work_queue.pool, item);
+            }
+            work_queue.running_id = 0;
+        }
+        portEXIT_CRITICAL(&work_queue.lock);
+    }
+}
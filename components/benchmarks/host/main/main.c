@@ -0,0 +1,8 @@
+#include "micro_benchmarks.h"
+#include <stdlib.h>
+
+void app_main(void)
+{
+    run_micro_benchmarks();
+    exit(0);
+}
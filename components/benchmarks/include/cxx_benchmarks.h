@@ -0,0 +1,32 @@
+#pragma once
+
+/*
+ * Benchmarks of the C++ layer in MicroUSC/USCdriver.hpp against the same calls written
+ * by hand in C.
+ *
+ * Each operation is timed twice, `c.<op>` with the C API and `cxx.<op>` through the
+ * wrapper, and printed as BENCH lines (see debugging/bench.h). A `CXX` line per pair
+ * gives the difference of the medians, which should be within the noise of the harness.
+ *
+ * A driver is installed on the given port for the duration of the run and removed by
+ * the microusc::Driver destructor, so this may run next to the application's drivers
+ * when one slot is free.
+ */
+
+#include "MicroUSC/USCdriver.h"
+#include "esp_err.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Install a driver on port, run every pair and remove the driver.
+ *
+ * @return ESP_OK, or the error of installing the driver.
+ */
+esp_err_t run_cxx_benchmarks(uart_port_config_t port);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,79 @@
+#pragma once
+
+/*
+ * End-to-end loopback benchmarks of the MicroUSC driver stack.
+ *
+ * Drivers are installed through usc_driver_install() and each one is looped back on
+ * itself, either inside the UART peripheral or with a wire from its TX to its RX pin, so
+ * every frame goes through the real write path, the UART, the reader task, the dispatch
+ * table and a consumer. A run streams numbered messages over every active link and is
+ * repeated for each combination of driver count, baud rate, payload size and consumer
+ * style.
+ *
+ * Each run prints one line, `LOOPBACK {json}`, with frames/s, goodput, message latency
+ * percentiles and CPU time per frame. CPU time needs CONFIG_FREERTOS_GENERATE_RUN_TIME_STATS
+ * and is null without it.
+ *
+ * The suite leaves its drivers installed when it ends, so run this instead of the
+ * application's own drivers, from a task that may block for the duration of the sweep.
+ */
+
+#include "MicroUSC/USCdriver.h"
+#include "esp_err.h"
+#include <stdbool.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define LOOPBACK_MAX_LINKS    (DRIVER_MAX - 1) // drivers the MicroUSC system accepts
+#define LOOPBACK_MAX_SWEEP    (4)              // values per swept parameter, 0 ends a list
+
+typedef enum {
+    LOOPBACK_CONSUMER_POLL = 1 << 0,  ///< Processor task polls usc_driver_get_data()
+    LOOPBACK_CONSUMER_BLOCK = 1 << 1, ///< Default handler feeds a queue the processor task blocks on
+} loopback_consumer_t;
+
+typedef struct {
+    uart_port_config_t ports[LOOPBACK_MAX_LINKS]; // one driver per port, port_count used
+    uint8_t port_count;
+    bool internal_loopback;                       // loop TX to RX inside the UART, no wiring needed
+    uint32_t baud_rates[LOOPBACK_MAX_SWEEP];
+    uint8_t payload_words[LOOPBACK_MAX_SWEEP];    // words per message, 4 payload bytes each, up to 255
+    uint8_t consumers;                            // loopback_consumer_t flags
+    uint16_t messages;                            // per link and run
+    uint8_t window;                               // messages in flight per link
+    uint32_t loss_timeout_ms;                     // a message not back by then counts as lost
+} loopback_config_t;
+
+#define LOOPBACK_CONFIG_DEFAULT {                                                        \
+        .ports = {                                                                       \
+            { .port = UART_NUM_1, .tx = GPIO_NUM_4, .rx = GPIO_NUM_5 },                  \
+            { .port = UART_NUM_2, .tx = GPIO_NUM_17, .rx = GPIO_NUM_16 },                \
+        },                                                                               \
+        .port_count = 2,                                                                 \
+        .internal_loopback = true,                                                       \
+        .baud_rates = { 115200, 460800, 921600 },                                        \
+        .payload_words = { 1, 4, 16 },                                                   \
+        .consumers = LOOPBACK_CONSUMER_POLL | LOOPBACK_CONSUMER_BLOCK,                   \
+        .messages = 200,                                                                 \
+        .window = 4,                                                                     \
+        .loss_timeout_ms = 500,                                                          \
+    }
+
+/**
+ * @brief Install the drivers and run the whole sweep, one LOOPBACK line per run.
+ *
+ * Drivers are added one at a time, so every run with n drivers happens while exactly n
+ * are installed.
+ *
+ * @param config NULL for LOOPBACK_CONFIG_DEFAULT.
+ * @return ESP_OK, ESP_ERR_INVALID_ARG, ESP_ERR_NO_MEM, or ESP_ERR_TIMEOUT if a link never
+ *         came up (check the wiring when internal_loopback is off).
+ */
+esp_err_t run_loopback_benchmarks(const loopback_config_t *config);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,8 @@
+#pragma once
+
+/*
+ * Micro-benchmarks of the MicroUSC building blocks, see debugging/bench.h for the output format.
+ * The event queue benchmarks reset the system event queue, so on chip run this before
+ * init_MicroUSC_system().
+ */
+void run_micro_benchmarks(void);
@@ -0,0 +1,108 @@
+#include "cxx_benchmarks.h"
+#include "bench.h"
+#include "MicroUSC/USCdriver.hpp"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "esp_log.h"
+#include <cstdio>
+#include <cstring>
+
+#define TAG "[CXX BENCH]"
+
+#define CXX_BENCH_STACK_SIZE (2048)
+
+namespace {
+
+struct reading_t {
+    uint16_t sensor;
+    int16_t value;
+};
+
+volatile uint32_t sink; // keeps results alive so calls are not optimized out
+volatile reading_t reading_in = { 7, -42 };
+
+void idle_processor(void *)
+{
+    for (;;) {
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY); /* words stay in the queue */
+    }
+}
+
+void c_encode(void *)
+{
+    const reading_t r = { reading_in.sensor, reading_in.value };
+    uint32_t word = 0;
+    memcpy(&word, &r, sizeof(r));
+    sink = word;
+}
+
+void cxx_encode(void *)
+{
+    const reading_t r = { reading_in.sensor, reading_in.value };
+    sink = microusc::detail::to_word(r);
+}
+
+void c_get_data(void *ctx)
+{
+    sink = usc_driver_get_data(static_cast<uscDriverHandler>(ctx));
+}
+
+void cxx_receive(void *ctx)
+{
+    reading_t r;
+    const bool got = microusc::DriverRef(static_cast<uscDriverHandler>(ctx)).receive(r);
+    sink = got ? r.sensor : 0;
+}
+
+void c_lock_get_unlock(void *ctx)
+{
+    uscDriverHandler driver = static_cast<uscDriverHandler>(ctx);
+    if (usc_driver_lock(driver, portMAX_DELAY) == ESP_OK) {
+        sink = usc_driver_get_data_locked(driver);
+        usc_driver_unlock(driver);
+    }
+}
+
+void cxx_lock_guard(void *ctx)
+{
+    const microusc::DriverLock lock = microusc::DriverRef(static_cast<uscDriverHandler>(ctx)).lock();
+    uint32_t word;
+    if (lock && lock.receive(word)) {
+        sink = word;
+    }
+}
+
+void run_pair(const char *op, bench_fn_t c_fn, bench_fn_t cxx_fn, void *ctx)
+{
+    char c_name[32], cxx_name[32];
+    snprintf(c_name, sizeof(c_name), "c.%s", op);
+    snprintf(cxx_name, sizeof(cxx_name), "cxx.%s", op);
+
+    bench_result_t c_result = {}, cxx_result = {};
+    if (bench_run(c_name, c_fn, ctx, nullptr, &c_result) != ESP_OK ||
+        bench_run(cxx_name, cxx_fn, ctx, nullptr, &cxx_result) != ESP_OK) {
+        return;
+    }
+    printf("CXX {\"op\":\"%s\",\"c_median_ns\":%.1f,\"cxx_median_ns\":%.1f,\"diff_ns\":%.1f}\n",
+           op, c_result.median_ns, cxx_result.median_ns, cxx_result.median_ns - c_result.median_ns);
+}
+
+} // namespace
+
+extern "C" esp_err_t run_cxx_benchmarks(uart_port_config_t port)
+{
+    run_pair("encode", c_encode, cxx_encode, nullptr);
+
+    const uart_config_t uart_config = STANDARD_UART_CONFIG;
+    microusc::Driver driver;
+    const esp_err_t ret = microusc::Driver::install("cxx bench", uart_config, port, idle_processor,
+                                                    CXX_BENCH_STACK_SIZE, driver);
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "Could not install the benchmark driver: %s", esp_err_to_name(ret));
+        return ret;
+    }
+
+    run_pair("get_data", c_get_data, cxx_receive, driver.handle());
+    run_pair("lock_get_unlock", c_lock_get_unlock, cxx_lock_guard, driver.handle());
+    return ESP_OK; /* the driver is removed here */
+}
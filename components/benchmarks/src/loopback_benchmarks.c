@@ -0,0 +1,386 @@
+#include "loopback_benchmarks.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/queue.h"
+#include "freertos/semphr.h"
+#include "driver/uart.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include <inttypes.h>
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define TAG "[LOOPBACK]"
+
+#define LOOPBACK_STACK_SIZE      (4096)
+#define LOOPBACK_QUEUE_LENGTH    (64)   // words the blocking consumer's queue holds
+#define LOOPBACK_LINK_TIMEOUT_MS (5000) // install, handshake and first probe
+#define LOOPBACK_PROBE_MS        (50)
+#define LOOPBACK_SETTLE_MS       (20)   // after a baud change, before draining
+
+/* A word carries a run tag (never 0), the message index and the word index in the message */
+#define LOOPBACK_WORD(tag, message, index) (((uint32_t)(tag) << 24) | ((uint32_t)(message) << 8) | (uint32_t)(index))
+#define WORD_TAG(word)     ((word) >> 24)
+#define WORD_MESSAGE(word) (((word) >> 8) & 0xFFFF)
+#define WORD_INDEX(word)   ((word) & 0xFF)
+#define LOOPBACK_PROBE     LOOPBACK_WORD(0, 0xFFFF, 0xA5) // tag 0, never part of a run
+
+_Static_assert(LOOPBACK_MAX_LINKS > 0, "DRIVER_MAX leaves no room for a loopback driver");
+
+struct loopback_link {
+    uscDriverHandler driver;
+    uart_port_t port;
+    TaskHandle_t consumer;     // the driver's processor task
+    SemaphoreHandle_t credits; // messages the sender may still put in flight
+    QueueHandle_t queue;       // fed by the default handler in the blocking style
+
+    /* Per run, indexed by message */
+    int64_t *sent_us;
+    uint8_t *progress;         // words received so far
+    uint32_t *latency_us;      // completed messages, in completion order
+    uint32_t completed;
+    uint32_t frames;
+    int64_t last_rx_us;
+};
+
+/* Settings of the current run are written by the owner before it wakes consumers and senders */
+static struct {
+    struct loopback_link links[LOOPBACK_MAX_LINKS];
+    _Atomic uint8_t registered;
+    TaskHandle_t owner;
+    uint8_t tag;
+    uint8_t payload;
+    uint16_t messages;
+    uint8_t window;
+    loopback_consumer_t consumer;
+    TickType_t loss_timeout;
+    _Atomic bool stop;
+} bench;
+
+static bool loopback_enqueue(uscDriverHandler driver, uint32_t data, void *ctx)
+{
+    struct loopback_link *link = ctx;
+    return xQueueSend(link->queue, &data, 0) == pdTRUE; /* full: left in the driver queue, counted lost */
+}
+
+static bool loopback_next_word(struct loopback_link *link, uint32_t *word)
+{
+    if (bench.consumer == LOOPBACK_CONSUMER_BLOCK) {
+        return xQueueReceive(link->queue, word, pdMS_TO_TICKS(10)) == pdTRUE;
+    }
+
+    *word = usc_driver_get_data(link->driver);
+    if (*word == 0) {
+        vTaskDelay(1); /* how a polling application waits */
+        return false;
+    }
+    return true;
+}
+
+static void loopback_consume(struct loopback_link *link)
+{
+    for (;;) {
+        uint32_t word;
+        if (!loopback_next_word(link, &word)) {
+            if (atomic_load(&bench.stop)) {
+                return;
+            }
+            continue;
+        }
+
+        const uint32_t message = WORD_MESSAGE(word);
+        if (WORD_TAG(word) != bench.tag || message >= bench.messages || WORD_INDEX(word) >= bench.payload ||
+            link->progress[message] >= bench.payload) {
+            continue; /* earlier run, probe or damaged word */
+        }
+
+        link->frames++;
+        if (++link->progress[message] == bench.payload) {
+            const int64_t now = esp_timer_get_time();
+            link->latency_us[link->completed++] = (uint32_t)(now - link->sent_us[message]);
+            link->last_rx_us = now;
+            xSemaphoreGive(link->credits); /* opens the window */
+        }
+    }
+}
+
+/**
+ * @brief Processor task of every loopback driver, consumes one run each time it is woken.
+ */
+static void loopback_processor(void *p)
+{
+    struct loopback_link *link = &bench.links[atomic_fetch_add(&bench.registered, 1)];
+    link->driver = (uscDriverHandler)p;
+    link->consumer = xTaskGetCurrentTaskHandle();
+    xTaskNotifyGive(bench.owner);
+
+    for (;;) {
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+        loopback_consume(link);
+        xTaskNotifyGive(bench.owner);
+    }
+}
+
+static void loopback_fill_window(struct loopback_link *link)
+{
+    while (xSemaphoreGive(link->credits) == pdTRUE) {
+    }
+}
+
+/**
+ * @brief Stream the run's messages over one link, keeping at most window of them in flight.
+ */
+static void loopback_sender(void *p)
+{
+    struct loopback_link *link = p;
+
+    for (uint32_t message = 0; message < bench.messages; message++) {
+        if (xSemaphoreTake(link->credits, bench.loss_timeout) != pdTRUE) {
+            loopback_fill_window(link); /* nothing came back in time, the messages in flight are lost */
+            xSemaphoreTake(link->credits, 0);
+        }
+
+        link->sent_us[message] = esp_timer_get_time();
+        for (uint32_t index = 0; index < bench.payload; index++) {
+            usc_send_data(link->driver, LOOPBACK_WORD(bench.tag, message, index));
+        }
+    }
+
+    /* Wait for the window to drain, completions arriving later are ignored */
+    for (uint32_t i = 0; i < bench.window && xSemaphoreTake(link->credits, bench.loss_timeout) == pdTRUE; i++) {
+    }
+    xTaskNotifyGive(bench.owner);
+    vTaskDelete(NULL);
+}
+
+static void loopback_drain(struct loopback_link *link)
+{
+    while (usc_driver_get_data(link->driver) != 0) {
+    }
+    xQueueReset(link->queue);
+}
+
+/**
+ * @brief Install one more driver and wait until a probe makes it around the loop.
+ */
+static esp_err_t loopback_add_link(const loopback_config_t *config, const uint8_t index)
+{
+    static const char *const names[] = { "loopback 0", "loopback 1", "loopback 2", "loopback 3" };
+    struct loopback_link *link = &bench.links[index];
+    const uart_port_config_t *port = &config->ports[index];
+
+    uart_config_t uart_config = STANDARD_UART_CONFIG;
+    uart_config.baud_rate = config->baud_rates[0];
+    esp_err_t ret = usc_driver_install(names[index % 4], uart_config, *port, loopback_processor, LOOPBACK_STACK_SIZE);
+    if (ret != ESP_OK) {
+        return ret;
+    }
+    if (ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(LOOPBACK_LINK_TIMEOUT_MS)) == 0) {
+        ESP_LOGE(TAG, "Processor task of UART %d never started", port->port);
+        return ESP_ERR_TIMEOUT;
+    }
+
+    link->port = port->port;
+    link->queue = xQueueCreate(LOOPBACK_QUEUE_LENGTH, sizeof(uint32_t));
+    link->credits = xSemaphoreCreateCounting(config->window, config->window);
+    if (link->queue == NULL || link->credits == NULL) {
+        return ESP_ERR_NO_MEM;
+    }
+    if (config->internal_loopback) {
+        uart_set_loop_back(port->port, true);
+    }
+
+    /* The reader task only delivers words once its key exchange with itself succeeded */
+    const int64_t deadline = esp_timer_get_time() + LOOPBACK_LINK_TIMEOUT_MS * 1000LL;
+    while (esp_timer_get_time() < deadline) {
+        usc_send_data(link->driver, LOOPBACK_PROBE);
+        for (int waited = 0; waited < LOOPBACK_PROBE_MS; waited += portTICK_PERIOD_MS) {
+            if (usc_driver_get_data(link->driver) == LOOPBACK_PROBE) {
+                loopback_drain(link);
+                return ESP_OK;
+            }
+            vTaskDelay(1);
+        }
+    }
+    ESP_LOGE(TAG, "No loopback on UART %d, is TX (GPIO %d) wired to RX (GPIO %d)?", port->port, port->tx, port->rx);
+    return ESP_ERR_TIMEOUT;
+}
+
+static int compare_u32(const void *a, const void *b)
+{
+    const uint32_t x = *(const uint32_t *)a;
+    const uint32_t y = *(const uint32_t *)b;
+    return (x > y) - (x < y);
+}
+
+#if CONFIG_FREERTOS_GENERATE_RUN_TIME_STATS
+/**
+ * @brief Idle time of all cores between two snapshots, in run time counter units (us).
+ */
+static uint64_t loopback_idle_since(const configRUN_TIME_COUNTER_TYPE *before)
+{
+    uint64_t idle = 0;
+    for (int core = 0; core < portNUM_PROCESSORS; core++) {
+        idle += (configRUN_TIME_COUNTER_TYPE)(ulTaskGetRunTimeCounter(xTaskGetIdleTaskHandleForCore(core)) - before[core]);
+    }
+    return idle;
+}
+#endif
+
+/**
+ * @brief One run over the first links drivers, prints its LOOPBACK line.
+ */
+static void loopback_run(const uint8_t links, const uint32_t baud, const uint8_t payload,
+                         const loopback_consumer_t consumer, uint32_t *latencies)
+{
+    static uint8_t tag = 0;
+    tag = (tag == UINT8_MAX) ? 1 : tag + 1;
+
+    bench.tag = tag;
+    bench.payload = payload;
+    bench.consumer = consumer;
+    atomic_store(&bench.stop, false);
+
+    for (uint8_t i = 0; i < links; i++) {
+        struct loopback_link *link = &bench.links[i];
+        uart_set_baudrate(link->port, baud);
+        usc_register_default_handler(link->driver, (consumer == LOOPBACK_CONSUMER_BLOCK) ? loopback_enqueue : NULL, link);
+    }
+    vTaskDelay(pdMS_TO_TICKS(LOOPBACK_SETTLE_MS));
+    for (uint8_t i = 0; i < links; i++) {
+        struct loopback_link *link = &bench.links[i];
+        loopback_drain(link);
+        memset(link->progress, 0, bench.messages);
+        link->completed = 0;
+        link->frames = 0;
+        loopback_fill_window(link);
+        usc_driver_reset_stats(link->driver);
+    }
+
+#if CONFIG_FREERTOS_GENERATE_RUN_TIME_STATS
+    configRUN_TIME_COUNTER_TYPE idle[portNUM_PROCESSORS];
+    for (int core = 0; core < portNUM_PROCESSORS; core++) {
+        idle[core] = ulTaskGetRunTimeCounter(xTaskGetIdleTaskHandleForCore(core));
+    }
+#endif
+    const int64_t start = esp_timer_get_time();
+    for (uint8_t i = 0; i < links; i++) {
+        bench.links[i].last_rx_us = start;
+        xTaskNotifyGive(bench.links[i].consumer);
+    }
+    for (uint8_t i = 0; i < links; i++) {
+        xTaskCreate(loopback_sender, "loopback tx", LOOPBACK_STACK_SIZE, &bench.links[i], uxTaskPriorityGet(NULL), NULL);
+    }
+    for (uint8_t i = 0; i < links; i++) {
+        ulTaskNotifyTake(pdFALSE, portMAX_DELAY); /* senders, bounded by the loss timeout */
+    }
+    const int64_t finished = esp_timer_get_time();
+#if CONFIG_FREERTOS_GENERATE_RUN_TIME_STATS
+    const uint64_t idle_us = loopback_idle_since(idle);
+#endif
+
+    atomic_store(&bench.stop, true);
+    for (uint8_t i = 0; i < links; i++) {
+        ulTaskNotifyTake(pdFALSE, portMAX_DELAY); /* consumers */
+    }
+
+    uint32_t frames = 0, completed = 0, parse_errors = 0, queue_drops = 0;
+    int64_t last_rx = start;
+    for (uint8_t i = 0; i < links; i++) {
+        const struct loopback_link *link = &bench.links[i];
+        usc_driver_stats_t stats;
+        usc_driver_get_stats(link->driver, &stats);
+        memcpy(&latencies[completed], link->latency_us, link->completed * sizeof(uint32_t));
+        frames += link->frames;
+        completed += link->completed;
+        parse_errors += stats.parse_errors;
+        queue_drops += stats.queue_drops;
+        last_rx = (link->last_rx_us > last_rx) ? link->last_rx_us : last_rx;
+    }
+    qsort(latencies, completed, sizeof(uint32_t), compare_u32);
+
+    const double elapsed_s = (last_rx - start) / 1e6;
+    const uint32_t p50 = completed ? latencies[(completed - 1) * 50 / 100] : 0;
+    const uint32_t p99 = completed ? latencies[(completed - 1) * 99 / 100] : 0;
+    char cpu[16] = "null";
+#if CONFIG_FREERTOS_GENERATE_RUN_TIME_STATS
+    const int64_t busy_us = (finished - start) * portNUM_PROCESSORS - (int64_t)idle_us;
+    if (frames != 0) {
+        snprintf(cpu, sizeof(cpu), "%.1f", (double)busy_us / frames);
+    }
+#else
+    (void)finished;
+#endif
+
+    printf("LOOPBACK {\"drivers\":%u,\"baud\":%" PRIu32 ",\"payload_bytes\":%u,\"consumer\":\"%s\",\"messages\":%u,"
+           "\"completed\":%" PRIu32 ",\"lost\":%" PRIu32 ",\"frames_per_s\":%.1f,\"goodput_bytes_per_s\":%.0f,"
+           "\"p50_us\":%" PRIu32 ",\"p99_us\":%" PRIu32 ",\"cpu_us_per_frame\":%s,\"parse_errors\":%" PRIu32
+           ",\"queue_drops\":%" PRIu32 "}\n",
+           links, baud, payload * (unsigned)sizeof(uint32_t), (consumer == LOOPBACK_CONSUMER_BLOCK) ? "block" : "poll",
+           bench.messages, completed, links * bench.messages - completed,
+           elapsed_s > 0 ? frames / elapsed_s : 0.0, elapsed_s > 0 ? frames * sizeof(uint32_t) / elapsed_s : 0.0,
+           p50, p99, cpu, parse_errors, queue_drops);
+}
+
+esp_err_t run_loopback_benchmarks(const loopback_config_t *config)
+{
+    static const loopback_config_t default_config = LOOPBACK_CONFIG_DEFAULT;
+    if (config == NULL) {
+        config = &default_config;
+    }
+    if (config->port_count == 0 || config->port_count > LOOPBACK_MAX_LINKS || config->baud_rates[0] == 0 ||
+        config->payload_words[0] == 0 || config->messages == 0 || config->window == 0 || config->consumers == 0) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (atomic_load(&bench.registered) != 0) {
+        return ESP_ERR_INVALID_STATE; /* drivers stay installed, the sweep runs once per boot */
+    }
+
+    bench.owner = xTaskGetCurrentTaskHandle();
+    bench.messages = config->messages;
+    bench.window = config->window;
+    bench.loss_timeout = pdMS_TO_TICKS(config->loss_timeout_ms);
+
+    uint32_t *latencies = malloc(config->port_count * config->messages * sizeof(uint32_t));
+    esp_err_t ret = (latencies != NULL) ? ESP_OK : ESP_ERR_NO_MEM;
+    for (uint8_t i = 0; i < config->port_count && ret == ESP_OK; i++) {
+        struct loopback_link *link = &bench.links[i];
+        link->sent_us = malloc(config->messages * sizeof(int64_t));
+        link->progress = malloc(config->messages);
+        link->latency_us = malloc(config->messages * sizeof(uint32_t));
+        if (link->sent_us == NULL || link->progress == NULL || link->latency_us == NULL) {
+            ret = ESP_ERR_NO_MEM;
+        }
+    }
+
+    for (uint8_t links = 1; links <= config->port_count && ret == ESP_OK; links++) {
+        ret = loopback_add_link(config, links - 1);
+        for (int b = 0; b < LOOPBACK_MAX_SWEEP && config->baud_rates[b] != 0 && ret == ESP_OK; b++) {
+            for (int p = 0; p < LOOPBACK_MAX_SWEEP && config->payload_words[p] != 0; p++) {
+                if (config->consumers & LOOPBACK_CONSUMER_POLL) {
+                    loopback_run(links, config->baud_rates[b], config->payload_words[p], LOOPBACK_CONSUMER_POLL, latencies);
+                }
+                if (config->consumers & LOOPBACK_CONSUMER_BLOCK) {
+                    loopback_run(links, config->baud_rates[b], config->payload_words[p], LOOPBACK_CONSUMER_BLOCK, latencies);
+                }
+            }
+        }
+    }
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "Loopback sweep stopped: %s", esp_err_to_name(ret));
+    }
+
+    /* Consumers only touch these during a run, and no run is in progress */
+    for (uint8_t i = 0; i < config->port_count; i++) {
+        free(bench.links[i].sent_us);
+        free(bench.links[i].progress);
+        free(bench.links[i].latency_us);
+        bench.links[i].sent_us = NULL;
+        bench.links[i].progress = NULL;
+        bench.links[i].latency_us = NULL;
+    }
+    free(latencies);
+    return ret;
+}
@@ -0,0 +1,210 @@
+#include "micro_benchmarks.h"
+#include "bench.h"
+#include "MicroUSC/synced_driver/atomic_sys_op.h"
+#include "MicroUSC/synced_driver/frame_codec.h"
+#include "MicroUSC/synced_driver/message_schema.h"
+#include "MicroUSC/system/memory_pool.h"
+#include "MicroUSC/internal/hashmap.h"
+#include "MicroUSC/internal/system/event_queue.h"
+#if !CONFIG_IDF_TARGET_LINUX
+#include "MicroUSC/system/manager.h"
+#endif
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#define QUEUE_CAPACITY 256
+#define POOL_BLOCKS    8
+#define POOL_BLOCK     64
+
+static volatile uint32_t sink; // keeps results alive so calls are not optimized out
+
+#define BENCH_SAMPLE_FIELDS(F) F(uint8_t, channel, 4) F(int16_t, value, 12) F(bool, fresh, 1)
+#define BENCH_RATE_FIELDS(F)   F(uint16_t, hz, 16)
+#define BENCH_MESSAGES(M, P)                   \
+    M(P, sample, 0x01, BENCH_SAMPLE_FIELDS)    \
+    M(P, rate,   0x02, BENCH_RATE_FIELDS)
+
+USC_SCHEMA_DECLARE(bench_msg, BENCH_MESSAGES)
+
+static void bench_queue_add_top(void *ctx)
+{
+    SerialDataQueueHandler queue = ctx;
+    dataStorageQueue_add(queue, 0x1234);
+    sink = dataStorageQueue_top(queue);
+}
+
+static void bench_pool_alloc_free(void *ctx)
+{
+    memory_pool_t *pool = ctx;
+    void *block = memory_pool_alloc(pool);
+    memory_pool_free(pool, block);
+}
+
+static void bench_hashmap_get(void *ctx)
+{
+    sink = (uint32_t)(uintptr_t)hashmap_get((HashMap)ctx, "key_5");
+}
+
+static void bench_hashmap_put_remove(void *ctx)
+{
+    hashmap_put((HashMap)ctx, "transient", ctx);
+    hashmap_remove((HashMap)ctx, "transient");
+}
+
+static void bench_frame_encode(void *ctx)
+{
+    usc_frame_encode(sink, ctx);
+}
+
+static void bench_frame_decode(void *ctx)
+{
+    uint32_t word;
+    sink = usc_frame_decode(ctx, USC_FRAME_SIZE, &word) ? word : 0;
+}
+
+static void bench_frame_reject(void *ctx)
+{
+    sink = usc_frame_decode(ctx, USC_FRAME_SIZE, NULL);
+}
+
+static void bench_schema_pack(void *ctx)
+{
+    const bench_msg_sample_t sample = { .channel = sink & 0xF, .value = -300, .fresh = true };
+    sink = bench_msg_sample_pack(sample);
+}
+
+static void bench_schema_unpack(void *ctx)
+{
+    const bench_msg_sample_t sample = bench_msg_sample_unpack(*(const uint32_t *)ctx);
+    sink = (uint32_t)sample.value;
+}
+
+static bool bench_on_sample(struct usc_driver_t *driver, bench_msg_sample_t msg, void *ctx)
+{
+    sink = (uint32_t)msg.value;
+    return true;
+}
+
+static void bench_schema_dispatch(void *ctx)
+{
+    static const bench_msg_handlers_t handlers = { .sample = bench_on_sample };
+    sink = bench_msg_dispatch(NULL, *(const uint32_t *)ctx, (void *)&handlers);
+}
+
+static void bench_event_post_drain(void *ctx)
+{
+    MiscrouscBackTrack_t event;
+    microusc_event_queue_push(ctx, NULL);
+    sink = microusc_event_queue_pop(&event);
+}
+
+static void bench_event_post_full(void *ctx)
+{
+    sink = microusc_event_queue_push(ctx, NULL);
+}
+
+#if !CONFIG_IDF_TARGET_LINUX
+/* The whole public post, caller PC capture included; manager.c only builds on chip */
+static void bench_status_post_drain(void *ctx)
+{
+    MiscrouscBackTrack_t event;
+    send_microusc_system_status(USC_SYSTEM_MEMORY_USAGE);
+    sink = microusc_event_queue_pop(&event);
+}
+
+static void bench_status_post_from_isr_drain(void *ctx)
+{
+    MiscrouscBackTrack_t event;
+    BaseType_t woken = pdFALSE;
+    send_microusc_system_status_from_isr(USC_SYSTEM_MEMORY_USAGE, &woken);
+    sink = microusc_event_queue_pop(&event);
+}
+#endif
+
+static void run_queue_benchmarks(void)
+{
+    static uint8_t storage[64 + QUEUE_CAPACITY * sizeof(uint32_t)] __attribute__((aligned(8)));
+    if (getDataStorageQueueSize() + QUEUE_CAPACITY * sizeof(uint32_t) > sizeof(storage)) {
+        printf("BENCH queue storage too small\n");
+        return;
+    }
+    SerialDataQueueHandler queue = createDataStorageQueueStatic(storage, QUEUE_CAPACITY);
+    bench_run("data_queue.add_top", bench_queue_add_top, queue, NULL, NULL);
+}
+
+static void run_pool_benchmarks(void)
+{
+    memory_pool_t *pool = memory_pool_malloc(POOL_BLOCK, POOL_BLOCKS);
+    if (pool == NULL) {
+        return;
+    }
+    bench_run("memory_pool.alloc_free", bench_pool_alloc_free, pool, NULL, NULL);
+    memory_pool_destroy(pool);
+}
+
+static void run_hashmap_benchmarks(void)
+{
+    static const char *const keys[] = { "key_0", "key_1", "key_2", "key_3", "key_4", "key_5" };
+    HashMap map = hashmap_create();
+    if (map == NULL) {
+        return;
+    }
+    for (size_t i = 0; i < sizeof(keys) / sizeof(keys[0]); i++) {
+        hashmap_put(map, keys[i], (void *)keys[i]);
+    }
+    bench_run("hashmap.get", bench_hashmap_get, map, NULL, NULL);
+    bench_run("hashmap.put_remove", bench_hashmap_put_remove, map, NULL, NULL);
+    free(map); /* created with malloc, there is no hashmap_destroy */
+}
+
+static void run_frame_benchmarks(void)
+{
+    uint8_t frame[USC_FRAME_SIZE];
+    uint8_t bad[USC_FRAME_SIZE] = { 0x00, 1, 2, 3, 4, USC_FRAME_DELIMITER };
+
+    bench_run("frame.encode", bench_frame_encode, frame, NULL, NULL);
+    usc_frame_encode(0xCAFE, frame);
+    bench_run("frame.decode", bench_frame_decode, frame, NULL, NULL);
+    bench_run("frame.decode_reject", bench_frame_reject, bad, NULL, NULL);
+}
+
+static void run_schema_benchmarks(void)
+{
+    static uint32_t word;
+    word = bench_msg_sample_pack((bench_msg_sample_t){ .channel = 3, .value = -300, .fresh = true });
+
+    bench_run("schema.pack", bench_schema_pack, NULL, NULL, NULL);
+    bench_run("schema.unpack", bench_schema_unpack, &word, NULL, NULL);
+    bench_run("schema.dispatch", bench_schema_dispatch, &word, NULL, NULL);
+}
+
+static void run_event_queue_benchmarks(void)
+{
+    static MiscrouscBackTrack_t event = { .status = USC_SYSTEM_MEMORY_USAGE };
+
+    /* No consumer, so posts never notify and the benchmark drains the queue itself */
+    microusc_event_queue_init(NULL);
+    bench_run("event_queue.post_drain", bench_event_post_drain, &event, NULL, NULL);
+
+    while (microusc_event_queue_push(&event, NULL)) {
+    }
+    bench_run("event_queue.post_full", bench_event_post_full, &event, NULL, NULL);
+    microusc_event_queue_init(NULL);
+
+#if !CONFIG_IDF_TARGET_LINUX
+    bench_run("system_status.post_drain", bench_status_post_drain, NULL, NULL, NULL);
+    bench_run("system_status.post_from_isr_drain", bench_status_post_from_isr_drain, NULL, NULL, NULL);
+    microusc_event_queue_init(NULL);
+#endif
+}
+
+void run_micro_benchmarks(void)
+{
+    run_queue_benchmarks();
+    run_pool_benchmarks();
+    run_hashmap_benchmarks();
+    run_frame_benchmarks();
+    run_schema_benchmarks();
+    run_event_queue_benchmarks();
+}
@@ -0,0 +1,136 @@
+#include "bench.h"
+#include "esp_log.h"
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#if CONFIG_IDF_TARGET_LINUX
+#include <time.h>
+#else
+#include "esp_cpu.h"
+#include "esp_private/esp_clk.h"
+#endif
+
+#define TAG "[BENCH]"
+
+#define BENCH_CALIBRATION_SAMPLES 64
+
+/* Raw timestamps: cycles on chip, nanoseconds on the host */
+#if CONFIG_IDF_TARGET_LINUX
+static inline uint32_t bench_now(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint32_t)((uint64_t)ts.tv_sec * 1000000000u + (uint64_t)ts.tv_nsec);
+}
+
+static inline double bench_ticks_to_ns(double ticks)
+{
+    return ticks;
+}
+#else
+static inline uint32_t bench_now(void)
+{
+    return esp_cpu_get_cycle_count();
+}
+
+static inline double bench_ticks_to_ns(double ticks)
+{
+    return ticks * 1e9 / (double)esp_clk_cpu_freq();
+}
+#endif
+
+static void bench_empty(void *ctx)
+{
+}
+
+static int bench_compare_u32(const void *a, const void *b)
+{
+    const uint32_t x = *(const uint32_t *)a;
+    const uint32_t y = *(const uint32_t *)b;
+    return (x > y) - (x < y);
+}
+
+/**
+ * @brief Time `samples` samples of `batch` calls into ticks[].
+ *
+ * Not inlined, so the empty calibration run keeps the same loop as the real one.
+ */
+static __attribute__((noinline)) void bench_sample(bench_fn_t fn, void *ctx, uint32_t batch, uint32_t *ticks, uint32_t samples)
+{
+    for (uint32_t s = 0; s < samples; s++) {
+        const uint32_t start = bench_now();
+        for (uint32_t i = 0; i < batch; i++) {
+            fn(ctx);
+        }
+        ticks[s] = bench_now() - start;
+    }
+}
+
+esp_err_t bench_run(const char *name, bench_fn_t fn, void *ctx, const bench_config_t *config, bench_result_t *result)
+{
+    static const bench_config_t default_config = BENCH_CONFIG_DEFAULT;
+    if (config == NULL) {
+        config = &default_config;
+    }
+    if (name == NULL || fn == NULL || config->samples == 0 || config->batch == 0) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    const uint32_t count = (config->samples > BENCH_CALIBRATION_SAMPLES) ? config->samples : BENCH_CALIBRATION_SAMPLES;
+    uint32_t *ticks = malloc(count * sizeof(uint32_t));
+    if (ticks == NULL) {
+        ESP_LOGE(TAG, "No memory for %" PRIu32 " samples", count);
+        return ESP_ERR_NO_MEM;
+    }
+
+    /* Cost of the loop and the timer alone, taken as the fastest empty sample */
+    bench_sample(bench_empty, NULL, config->batch, ticks, BENCH_CALIBRATION_SAMPLES);
+    uint32_t overhead = ticks[0];
+    for (uint32_t s = 1; s < BENCH_CALIBRATION_SAMPLES; s++) {
+        overhead = (ticks[s] < overhead) ? ticks[s] : overhead;
+    }
+
+    for (uint32_t i = 0; i < config->warmup; i++) {
+        fn(ctx);
+    }
+    bench_sample(fn, ctx, config->batch, ticks, config->samples);
+
+    uint64_t total = 0;
+    for (uint32_t s = 0; s < config->samples; s++) {
+        ticks[s] = (ticks[s] > overhead) ? ticks[s] - overhead : 0;
+        total += ticks[s];
+    }
+    qsort(ticks, config->samples, sizeof(uint32_t), bench_compare_u32);
+
+    const double per_call = 1.0 / (double)config->batch;
+    const uint32_t p99 = (uint32_t)(((uint64_t)config->samples * 99) / 100);
+    bench_result_t r = {
+        .name = name,
+        .samples = config->samples,
+        .batch = config->batch,
+        .min_ns = bench_ticks_to_ns(ticks[0] * per_call),
+        .median_ns = bench_ticks_to_ns(ticks[config->samples / 2] * per_call),
+        .p99_ns = bench_ticks_to_ns(ticks[(p99 < config->samples) ? p99 : config->samples - 1] * per_call),
+        .max_ns = bench_ticks_to_ns(ticks[config->samples - 1] * per_call),
+        .mean_ns = bench_ticks_to_ns((double)total / config->samples * per_call),
+    };
+    r.ops_per_sec = (r.mean_ns > 0.0) ? 1e9 / r.mean_ns : 0.0;
+    free(ticks);
+
+    bench_report(&r);
+    if (result != NULL) {
+        *result = r;
+    }
+    return ESP_OK;
+}
+
+void bench_report(const bench_result_t *result)
+{
+    printf("BENCH {\"name\":\"%s\",\"samples\":%" PRIu32 ",\"batch\":%" PRIu32
+           ",\"min_ns\":%.1f,\"median_ns\":%.1f,\"p99_ns\":%.1f,\"max_ns\":%.1f"
+           ",\"mean_ns\":%.1f,\"ops_per_sec\":%.0f}\n",
+           result->name, result->samples, result->batch,
+           result->min_ns, result->median_ns, result->p99_ns, result->max_ns,
+           result->mean_ns, result->ops_per_sec);
+}
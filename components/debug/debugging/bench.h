@@ -0,0 +1,69 @@
+#pragma once
+
+/*
+ * Statistical micro-benchmark harness.
+ *
+ * Runs a function for a number of warm-up calls, then times `samples` samples of
+ * `batch` calls each. On chip the CPU cycle counter is used, so run from a task pinned
+ * to one core; on the linux host target CLOCK_MONOTONIC is used and a larger batch
+ * hides its resolution. The cost of an empty sample is measured first and subtracted.
+ *
+ * Each result is printed as one line, `BENCH {json}`, so runs can be collected with
+ * `grep '^BENCH '` and compared across releases.
+ */
+
+#include "sdkconfig.h"
+#include "esp_err.h"
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef void (*bench_fn_t)(void *ctx);
+
+typedef struct {
+    uint32_t warmup;  // untimed calls before measuring
+    uint32_t samples; // timed samples, statistics are over these
+    uint32_t batch;   // calls per sample
+} bench_config_t;
+
+#if CONFIG_IDF_TARGET_LINUX
+#define BENCH_CONFIG_DEFAULT { .warmup = 1000, .samples = 2000, .batch = 64 }
+#else
+#define BENCH_CONFIG_DEFAULT { .warmup = 100, .samples = 1000, .batch = 1 }
+#endif
+
+/* Times are per call, in nanoseconds */
+typedef struct {
+    const char *name;
+    uint32_t samples;
+    uint32_t batch;
+    double min_ns;
+    double median_ns;
+    double p99_ns;
+    double max_ns;
+    double mean_ns;
+    double ops_per_sec; // from the mean
+} bench_result_t;
+
+/**
+ * @brief Benchmark fn(ctx).
+ *
+ * @param name   Label of the result, must outlive it.
+ * @param fn     Function under test.
+ * @param ctx    Passed to every call.
+ * @param config NULL for BENCH_CONFIG_DEFAULT.
+ * @param result Receives the statistics, may be NULL to only print them.
+ * @return ESP_OK, ESP_ERR_INVALID_ARG, or ESP_ERR_NO_MEM for the sample buffer.
+ */
+esp_err_t bench_run(const char *name, bench_fn_t fn, void *ctx, const bench_config_t *config, bench_result_t *result);
+
+/**
+ * @brief Print a result as a `BENCH {json}` line.
+ */
+void bench_report(const bench_result_t *result);
+
+#ifdef __cplusplus
+}
+#endif
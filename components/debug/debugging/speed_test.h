@@ -1,6 +1,7 @@
 #pragma once
 
 #include "esp_timer.h"
+#include "esp_cpu.h"
 #include "esp_log.h"
 #include <stdio.h>
 
@@ -24,6 +25,18 @@
         ESP_LOGI("[TIMING]", #func " took %llu microseconds", end - start);   \
     } while (0)
 
+/* Average CPU cycles of one call over `iterations` runs, for calls too short for esp_timer */
+#define CHECK_FUNCTION_CYCLES(func, iterations) do {                          \
+        const uint32_t runs = (iterations);                                   \
+        uint32_t start = esp_cpu_get_cycle_count();                           \
+        for (uint32_t i = 0; i < runs; i++) {                                 \
+            (func);                                                           \
+        }                                                                     \
+        uint32_t end = esp_cpu_get_cycle_count();                             \
+        ESP_LOGI("[TIMING]", #func " took %lu cycles per call",               \
+                 (unsigned long)((end - start) / runs));                      \
+    } while (0)
+
 #define CHECKPOINT_START \
     int check_point_var = 1; \
     ESP_LOGI(TAG, "Starting tests");
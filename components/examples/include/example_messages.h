@@ -0,0 +1,26 @@
+#pragma once
+
+#include "MicroUSC/synced_driver/message_schema.h"
+
+/*
+ * Messages exchanged by system_task() with the device on the other end of the UART.
+ * See docs/api/message_schema.md.
+ */
+
+#define EXAMPLE_ECHO_FIELDS(F) \
+    F(uint16_t, value, 16)     \
+    F(uint8_t, seq, 8)
+
+#define EXAMPLE_LED_FIELDS(F) \
+    F(bool, on, 1)
+
+#define EXAMPLE_READING_FIELDS(F) \
+    F(uint8_t, channel, 4)        \
+    F(int16_t, value, 12)
+
+#define EXAMPLE_MESSAGES(M, P)                  \
+    M(P, echo,    0x01, EXAMPLE_ECHO_FIELDS)    \
+    M(P, led,     0x02, EXAMPLE_LED_FIELDS)     \
+    M(P, reading, 0x03, EXAMPLE_READING_FIELDS)
+
+USC_SCHEMA_DECLARE(example, EXAMPLE_MESSAGES)
@@ -1,5 +1,6 @@
 #include "MicroUSC/USCdriver.h"
 #include "testing_driver.h"
+#include "example_messages.h"
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
 #include "string.h"
@@ -7,31 +8,52 @@
 #include "stdint.h"
 #include <inttypes.h>
 
+/* Runs in the driver's reader task, no need to poll for the password request */
+static bool reply_password(uscDriverHandler driver, uint32_t data, void *ctx) {
+    usc_send_data(driver, USC_PROTOCOL_SEND_KEY); // send password
+    return true; // consumed, do not queue
+}
+
+/* Also in the reader task: answer with the value incremented by 1 */
+static bool reply_echo(uscDriverHandler driver, example_echo_t msg, void *ctx) {
+    msg.value++;
+    usc_send_data(driver, example_echo_pack(msg));
+    return true;
+}
+
+static bool set_led(uscDriverHandler driver, example_led_t msg, void *ctx) {
+    ESP_LOGI("driver task", "LED %s", msg.on ? "on" : "off");
+    return true;
+}
+
+/* Readings have no handler and are queued for the loop below */
+static const example_handlers_t example_handlers = {
+    .echo = reply_echo,
+    .led = set_led,
+};
+
 void system_task(void *p) {
     uscDriverHandler driver = (uscDriverHandler)p;
     uint32_t data = 0;
 
+    usc_register_handler(driver, USC_CODE(USC_PROTOCOL_REQUEST_KEY), reply_password, NULL);
+    usc_register_handler(driver, example_codes(), example_dispatch, (void *)&example_handlers);
+    usc_driver_enable_watchdog(driver, 2000, true); // report the driver if it stalls for 2 seconds
+
     while (1) {
+        usc_driver_feed_watchdog(driver);
         data = usc_driver_get_data(driver);
 
-        if (data != 0) {
-            ESP_LOGI("driver task", "Got data: %lu", data);
-            if (data == 0x64) {
-                usc_send_data(driver, 1234); // send password
-            }
-            else {
-                usc_send_data(driver, data + 1); // increment by 1
-            }
-        }
-        
-        switch(data) {
-            case 1: 
-                break;
-            case 2:
-                break;
-            case 3: 
+        switch (example_id(data)) {
+            case example_id_reading: {
+                const example_reading_t reading = example_reading_unpack(data);
+                ESP_LOGI("driver task", "Channel %u: %d", reading.channel, reading.value);
                 break;
+            }
             default:
+                if (data != 0) {
+                    ESP_LOGI("driver task", "Got data: %lu", data); // not a schema message
+                }
                 break;
         }
 
@@ -0,0 +1,207 @@
+#include "uart_sim.h"
+#include "MicroUSC/synced_driver/esp_uart.h"
+#include "MicroUSC/synced_driver/frame_codec.h"
+#include "MicroUSC/synced_driver/message_schema.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/semphr.h"
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define TX_PORT   UART_NUM_1
+#define RX_PORT   UART_NUM_2
+#define FRAMES    2000
+#define BAUD_RATE 115200
+
+#define REQUEST_KEY USC_PROTOCOL_REQUEST_KEY
+#define SERIAL_KEY  USC_PROTOCOL_SERIAL_KEY
+
+typedef struct {
+    const char *name;
+    uart_sim_faults_t faults;
+} scenario_t;
+
+/* Counted by the receiving side of one scenario */
+typedef struct {
+    uint32_t frames_ok;      // valid delimiters and a word that was sent, first time seen
+    uint32_t frames_corrupt; // accepted by the decoder, but not a word that was sent
+    uint32_t frames_repeat;  // a word delivered a second time
+    uint32_t resyncs;
+    uint8_t seen[FRAMES + 1];
+    SemaphoreHandle_t done;
+} rx_result_t;
+
+/* Each word carries its counter twice, the second copy inverted, so damage is detected */
+static uint32_t counter_word(uint32_t counter)
+{
+    return (counter << 16) | (~counter & 0xFFFF);
+}
+
+static bool word_counter(uint32_t word, uint32_t *counter)
+{
+    *counter = word >> 16;
+    return ((word ^ (word >> 16)) & 0xFFFF) == 0xFFFF && *counter >= 1 && *counter <= FRAMES;
+}
+
+static const uart_port_config_t tx_pins = { .port = TX_PORT, .tx = GPIO_NUM_4, .rx = GPIO_NUM_5 };
+static const uart_port_config_t rx_pins = { .port = RX_PORT, .tx = GPIO_NUM_16, .rx = GPIO_NUM_17 };
+
+static void receiver_task(void *p)
+{
+    rx_result_t *result = p;
+    uint8_t buf[USC_FRAME_SIZE];
+    TickType_t idle_since = xTaskGetTickCount();
+
+    /* Stops once nothing has arrived for a second */
+    while (xTaskGetTickCount() - idle_since < pdMS_TO_TICKS(1000)) {
+        uart_frame_status_t status;
+        const uint8_t *frame = uart_read_frame(RX_PORT, buf, sizeof(buf), pdMS_TO_TICKS(10), &status);
+        if (status == UART_FRAME_RESYNC) {
+            result->resyncs++;
+        }
+        if (status == UART_FRAME_INCOMPLETE) {
+            vTaskDelay(1);
+            continue;
+        }
+        idle_since = xTaskGetTickCount();
+        if (frame == NULL || status != UART_FRAME_OK) {
+            continue;
+        }
+
+        uint32_t word, counter;
+        usc_frame_decode(frame, sizeof(buf), &word);
+        if (!word_counter(word, &counter)) {
+            result->frames_corrupt++;
+        }
+        else if (result->seen[counter]) {
+            result->frames_repeat++;
+        }
+        else {
+            result->seen[counter] = 1;
+            result->frames_ok++;
+        }
+    }
+    xSemaphoreGive(result->done);
+    vTaskDelete(NULL);
+}
+
+static void run_stream(const scenario_t *scenario)
+{
+    static rx_result_t result;
+    memset(&result, 0, sizeof(result));
+    result.done = xSemaphoreCreateBinary();
+    uart_sim_stats_t before, stats;
+    uart_sim_set_faults(TX_PORT, &scenario->faults);
+    uart_sim_get_stats(TX_PORT, &before);
+    uart_flush_input(RX_PORT);
+
+    const TickType_t start = xTaskGetTickCount();
+    xTaskCreate(receiver_task, "receiver", 4096, &result, 5, NULL);
+
+    uint8_t frame[USC_FRAME_SIZE];
+    for (uint32_t counter = 1; counter <= FRAMES; counter++) {
+        usc_frame_encode(counter_word(counter), frame);
+        uart_write_bytes(TX_PORT, frame, sizeof(frame));
+    }
+    uart_wait_tx_done(TX_PORT, portMAX_DELAY);
+    xSemaphoreTake(result.done, portMAX_DELAY);
+    vSemaphoreDelete(result.done);
+
+    /* The receiver waits out one idle second before it stops */
+    const uint32_t elapsed_ms = (xTaskGetTickCount() - start) * portTICK_PERIOD_MS - 1000;
+    uart_sim_get_stats(TX_PORT, &stats);
+    printf("SIM {\"scenario\":\"%s\",\"frames\":%d,\"ok\":%" PRIu32 ",\"lost\":%" PRIu32
+           ",\"corrupt\":%" PRIu32 ",\"repeated\":%" PRIu32 ",\"resyncs\":%" PRIu32 ",\"dropped_bytes\":%" PRIu64
+           ",\"flipped_bytes\":%" PRIu64 ",\"garbage_bytes\":%" PRIu64 ",\"frames_per_s\":%.0f}\n",
+           scenario->name, FRAMES, result.frames_ok, FRAMES - result.frames_ok, result.frames_corrupt, result.frames_repeat,
+           result.resyncs, stats.bytes_dropped - before.bytes_dropped, stats.bytes_flipped - before.bytes_flipped,
+           stats.bytes_inserted - before.bytes_inserted,
+           elapsed_ms ? result.frames_ok * 1000.0 / elapsed_ms : 0.0);
+}
+
+/**
+ * @brief Poll for a frame with valid delimiters until timeout_ms passes.
+ */
+static bool read_word(uart_port_t port, uint32_t *word, uint32_t timeout_ms)
+{
+    uint8_t buf[USC_FRAME_SIZE];
+    const TickType_t start = xTaskGetTickCount();
+    do {
+        uart_frame_status_t status;
+        const uint8_t *frame = uart_read_frame(port, buf, sizeof(buf), 0, &status);
+        if (frame != NULL && status == UART_FRAME_OK) {
+            return usc_frame_decode(frame, sizeof(buf), word);
+        }
+        if (status == UART_FRAME_INCOMPLETE) {
+            vTaskDelay(1);
+        }
+    } while (xTaskGetTickCount() - start < pdMS_TO_TICKS(timeout_ms));
+    return false;
+}
+
+/**
+ * @brief The driver's key exchange in miniature: RX_PORT answers REQUEST_KEY with its key,
+ *        TX_PORT repeats the request until the key arrives intact.
+ */
+static void run_handshake(const scenario_t *scenario)
+{
+    uart_sim_set_faults(TX_PORT, &scenario->faults);
+    uart_sim_set_faults(RX_PORT, &scenario->faults);
+    uart_flush_input(RX_PORT);
+    uart_flush_input(TX_PORT);
+
+    uint8_t frame[USC_FRAME_SIZE];
+    uint32_t attempts = 0;
+    bool connected = false;
+
+    while (!connected && attempts < 100) {
+        attempts++;
+        usc_frame_encode(REQUEST_KEY, frame);
+        uart_write_bytes(TX_PORT, frame, sizeof(frame));
+
+        uint32_t word;
+        if (read_word(RX_PORT, &word, 50) && word == REQUEST_KEY) {
+            usc_frame_encode(SERIAL_KEY, frame);
+            uart_write_bytes(RX_PORT, frame, sizeof(frame));
+        }
+        connected = read_word(TX_PORT, &word, 50) && word == SERIAL_KEY;
+    }
+    printf("SIM {\"scenario\":\"%s handshake\",\"connected\":%s,\"attempts\":%" PRIu32 "}\n",
+           scenario->name, connected ? "true" : "false", attempts);
+}
+
+void app_main(void)
+{
+    const uart_config_t config = {
+        .baud_rate = BAUD_RATE,
+        .data_bits = UART_DATA_8_BITS,
+        .parity    = UART_PARITY_DISABLE,
+        .stop_bits = UART_STOP_BITS_1,
+        .flow_ctrl = UART_HW_FLOWCTRL_DISABLE,
+    };
+
+    ESP_ERROR_CHECK(uart_sim_connect(TX_PORT, RX_PORT));
+    uart_init(tx_pins, config);
+    uart_init(rx_pins, config);
+
+    const scenario_t scenarios[] = {
+        { "clean",   { .pace = true } },
+        { "drops",   { .pace = true, .drop_ppm = 2000, .seed = 1 } },
+        { "flips",   { .pace = true, .flip_ppm = 2000, .seed = 2 } },
+        { "garbage", { .pace = true, .garbage_ppm = 2000, .seed = 3 } },
+        { "jitter",  { .pace = true, .latency_us = 2000, .jitter_us = 5000, .seed = 4 } },
+        { "hostile", { .pace = true, .drop_ppm = 5000, .flip_ppm = 5000, .garbage_ppm = 5000,
+                       .latency_us = 1000, .jitter_us = 3000, .seed = 5 } },
+    };
+
+    for (size_t i = 0; i < sizeof(scenarios) / sizeof(scenarios[0]); i++) {
+        run_stream(&scenarios[i]);
+        run_handshake(&scenarios[i]);
+    }
+
+    uart_sim_disconnect(TX_PORT);
+    uart_sim_disconnect(RX_PORT);
+    exit(0);
+}
@@ -0,0 +1,97 @@
+/*
+ * SPDX-FileCopyrightText: 2025 Alejandro Ramirez
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/**
+ * @file uart_sim.h
+ * @brief Host UART simulator for the ESP-IDF linux target.
+ *
+ * Implements the ESP-IDF UART driver calls that esp_uart.h builds on, so the MicroUSC
+ * UART layer runs unmodified on a laptop. Each port is backed by a file descriptor:
+ * one end of a socketpair for two ports wired back to back, or the master side of a
+ * pseudo-terminal so an external program can play the peer.
+ *
+ * Bytes written to a port pass through a transmit thread that holds each write for its
+ * time on the wire at the configured baud rate and injects faults: dropped bytes, bit
+ * flips, inserted garbage and latency with jitter. Faults are drawn from a seeded
+ * generator, so a failing run can be replayed.
+ *
+ * @author Alejandro Ramirez
+ * @date July 31, 2025
+ */
+
+#pragma once
+
+#include "driver/uart.h"
+#include <stdbool.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Impairments applied to the bytes a port transmits.
+ *
+ * Rates are in parts per million of transmitted bytes.
+ */
+typedef struct {
+    bool pace;            ///< Deliver at the configured baud rate instead of instantly
+    uint32_t drop_ppm;    ///< Bytes lost on the wire
+    uint32_t flip_ppm;    ///< Bytes arriving with one bit flipped
+    uint32_t garbage_ppm; ///< Random bytes inserted before a byte
+    uint32_t latency_us;  ///< Fixed delay added to every write
+    uint32_t jitter_us;   ///< Random extra delay per write, 0 to jitter_us; order is kept
+    uint32_t seed;        ///< Fault generator seed, 0 picks a fixed default
+} uart_sim_faults_t;
+
+#define UART_SIM_FAULTS_DEFAULT { .pace = true }
+
+/**
+ * @brief What the transmit thread of a port did, since the port was wired.
+ */
+typedef struct {
+    uint64_t bytes_written;  ///< Accepted by uart_write_bytes()
+    uint64_t bytes_sent;     ///< Put on the wire, including garbage
+    uint64_t bytes_dropped;
+    uint64_t bytes_flipped;
+    uint64_t bytes_inserted;
+} uart_sim_stats_t;
+
+/**
+ * @brief Wire two ports back to back through a socketpair.
+ *
+ * @return ESP_OK, ESP_ERR_INVALID_ARG, ESP_ERR_INVALID_STATE if a port is already wired,
+ *         or ESP_FAIL if the socketpair could not be created.
+ */
+esp_err_t uart_sim_connect(uart_port_t a, uart_port_t b);
+
+/**
+ * @brief Back a port with a new pseudo-terminal.
+ *
+ * @param port       Port to wire.
+ * @param slave_path Receives the path external programs open, for example /dev/pts/3.
+ * @param len        Size of slave_path.
+ */
+esp_err_t uart_sim_open_pty(uart_port_t port, char *slave_path, size_t len);
+
+/**
+ * @brief Set the impairments of a port's transmit direction. Takes effect on the next write.
+ */
+esp_err_t uart_sim_set_faults(uart_port_t port, const uart_sim_faults_t *faults);
+
+/**
+ * @brief Copy the transmit counters of a port.
+ */
+esp_err_t uart_sim_get_stats(uart_port_t port, uart_sim_stats_t *stats);
+
+/**
+ * @brief Disconnect a port and stop its transmit thread.
+ */
+esp_err_t uart_sim_disconnect(uart_port_t port);
+
+#ifdef __cplusplus
+}
+#endif
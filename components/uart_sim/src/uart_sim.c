@@ -0,0 +1,515 @@
+#define _GNU_SOURCE // posix_openpt, ptsname_r
+#include "uart_sim.h"
+#include "freertos/task.h"
+#include "esp_log.h"
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <pthread.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/ioctl.h>
+#include <sys/socket.h>
+#include <termios.h>
+#include <time.h>
+#include <unistd.h>
+
+#define TAG "[UART SIM]"
+
+#define SIM_TX_BYTES    (4096) // transmit buffer per port, like the driver's TX ring
+#define SIM_TX_WRITES   (256)  // writes queued per port
+#define SIM_DEFAULT_SEED (0x2545F491)
+
+struct sim_write {
+    int64_t enqueued_us;
+    uint32_t len;
+};
+
+struct sim_port {
+    int fd;                       // -1 while not wired
+    bool installed;
+    uart_config_t config;
+    uart_sim_faults_t faults;
+    uart_sim_stats_t stats;
+    uint32_t rng;
+
+    /* Transmit queue, filled by uart_write_bytes(), emptied by the port's thread */
+    uint8_t bytes[SIM_TX_BYTES];
+    size_t byte_head;             // positions only grow, index with % SIM_TX_BYTES
+    size_t byte_tail;
+    struct sim_write writes[SIM_TX_WRITES];
+    size_t write_head;
+    size_t write_tail;
+    bool busy;                    // a write is between the queue and the wire
+    int64_t line_free_us;         // when the last byte handed to the wire arrives
+
+    bool running;
+    pthread_t thread;
+    pthread_mutex_t lock;
+    pthread_cond_t cond;
+};
+
+static struct sim_port ports[UART_NUM_MAX];
+static pthread_once_t ports_once = PTHREAD_ONCE_INIT;
+
+static void sim_ports_init(void)
+{
+    for (int i = 0; i < UART_NUM_MAX; i++) {
+        ports[i].fd = -1;
+        ports[i].faults = (uart_sim_faults_t)UART_SIM_FAULTS_DEFAULT;
+        ports[i].rng = SIM_DEFAULT_SEED;
+        pthread_mutex_init(&ports[i].lock, NULL);
+        pthread_cond_init(&ports[i].cond, NULL);
+    }
+}
+
+static struct sim_port *sim_port(uart_port_t uart_num)
+{
+    if (uart_num < 0 || uart_num >= UART_NUM_MAX) {
+        return NULL;
+    }
+    pthread_once(&ports_once, sim_ports_init);
+    return &ports[uart_num];
+}
+
+static int64_t sim_now_us(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (int64_t)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
+static void sim_sleep_until(int64_t deadline_us)
+{
+    const struct timespec ts = {
+        .tv_sec = deadline_us / 1000000,
+        .tv_nsec = (deadline_us % 1000000) * 1000,
+    };
+    while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, NULL) == EINTR) {
+    }
+}
+
+/* xorshift32, cheap and reproducible from the seed */
+static uint32_t sim_random(struct sim_port *port)
+{
+    uint32_t x = port->rng;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    port->rng = x;
+    return x;
+}
+
+static bool sim_chance(struct sim_port *port, uint32_t ppm)
+{
+    return ppm != 0 && (sim_random(port) % 1000000u) < ppm;
+}
+
+/**
+ * @brief Bits one byte occupies on the wire with the port's framing, times two for 1.5 stop bits.
+ */
+static uint32_t sim_half_bits_per_byte(const uart_config_t *config)
+{
+    const uint32_t data = 5 + (uint32_t)config->data_bits;
+    const uint32_t parity = (config->parity == UART_PARITY_DISABLE) ? 0 : 1;
+    const uint32_t half_stop = (config->stop_bits == UART_STOP_BITS_2) ? 4 : (config->stop_bits == UART_STOP_BITS_1_5) ? 3 : 2;
+    return 2 * (1 + data + parity) + half_stop;
+}
+
+static void sim_write_all(int fd, const uint8_t *data, size_t len)
+{
+    while (len > 0) {
+        const ssize_t n = write(fd, data, len);
+        if (n > 0) {
+            data += n;
+            len -= (size_t)n;
+        }
+        else if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+            struct pollfd pfd = { .fd = fd, .events = POLLOUT };
+            poll(&pfd, 1, 10);
+        }
+        else if (n < 0 && errno != EINTR) {
+            return; /* peer gone, the bytes are lost like on an open line */
+        }
+    }
+}
+
+/**
+ * @brief Transmit thread: takes one queued write at a time, impairs it and puts it on
+ *        the wire once its latency and transmission time have passed.
+ */
+static void *sim_tx_thread(void *arg)
+{
+    struct sim_port *port = arg;
+    uint8_t in[SIM_TX_BYTES];
+    uint8_t out[2 * SIM_TX_BYTES]; // worst case every byte gets garbage in front
+
+    /* The FreeRTOS POSIX port drives its scheduler with signals meant for its own threads */
+    sigset_t all;
+    sigfillset(&all);
+    pthread_sigmask(SIG_BLOCK, &all, NULL);
+
+    pthread_mutex_lock(&port->lock);
+    while (port->running) {
+        if (port->write_tail == port->write_head) {
+            pthread_cond_wait(&port->cond, &port->lock);
+            continue;
+        }
+
+        const struct sim_write w = port->writes[port->write_tail % SIM_TX_WRITES];
+        for (uint32_t i = 0; i < w.len; i++) {
+            in[i] = port->bytes[(port->byte_tail + i) % SIM_TX_BYTES];
+        }
+        port->byte_tail += w.len;
+        port->write_tail++;
+        port->busy = true;
+        pthread_cond_broadcast(&port->cond); /* room for blocked writers */
+
+        const uart_sim_faults_t faults = port->faults;
+        size_t n = 0;
+        uint64_t dropped = 0, flipped = 0, inserted = 0;
+        for (uint32_t i = 0; i < w.len; i++) {
+            if (sim_chance(port, faults.garbage_ppm)) {
+                out[n++] = (uint8_t)sim_random(port);
+                inserted++;
+            }
+            if (sim_chance(port, faults.drop_ppm)) {
+                dropped++;
+                continue;
+            }
+            uint8_t byte = in[i];
+            if (sim_chance(port, faults.flip_ppm)) {
+                byte ^= (uint8_t)(1u << (sim_random(port) & 7));
+                flipped++;
+            }
+            out[n++] = byte;
+        }
+
+        int64_t start = w.enqueued_us + faults.latency_us;
+        if (faults.jitter_us != 0) {
+            start += sim_random(port) % (faults.jitter_us + 1);
+        }
+        if (start < port->line_free_us) {
+            start = port->line_free_us; /* the line is still busy, keeps bytes in order */
+        }
+        int64_t wire_us = 0;
+        if (faults.pace && port->config.baud_rate > 0) {
+            wire_us = (int64_t)n * sim_half_bits_per_byte(&port->config) * 1000000 / (2 * (int64_t)port->config.baud_rate);
+        }
+        port->line_free_us = start + wire_us;
+        const int64_t arrival = port->line_free_us;
+        const int fd = port->fd;
+        pthread_mutex_unlock(&port->lock);
+
+        sim_sleep_until(arrival);
+        sim_write_all(fd, out, n);
+
+        pthread_mutex_lock(&port->lock);
+        port->stats.bytes_sent += n;
+        port->stats.bytes_dropped += dropped;
+        port->stats.bytes_flipped += flipped;
+        port->stats.bytes_inserted += inserted;
+        port->busy = false;
+        pthread_cond_broadcast(&port->cond); /* uart_wait_tx_done() */
+    }
+    pthread_mutex_unlock(&port->lock);
+    return NULL;
+}
+
+/**
+ * @brief Attach a descriptor to a port and start its transmit thread.
+ */
+static esp_err_t sim_attach(struct sim_port *port, int fd)
+{
+    fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+
+    pthread_mutex_lock(&port->lock);
+    port->fd = fd;
+    port->byte_head = port->byte_tail = 0;
+    port->write_head = port->write_tail = 0;
+    port->line_free_us = 0;
+    port->busy = false;
+    memset(&port->stats, 0, sizeof(port->stats));
+    port->running = true;
+    pthread_mutex_unlock(&port->lock);
+
+    if (pthread_create(&port->thread, NULL, sim_tx_thread, port) != 0) {
+        ESP_LOGE(TAG, "Could not start the transmit thread");
+        pthread_mutex_lock(&port->lock);
+        port->running = false;
+        port->fd = -1;
+        pthread_mutex_unlock(&port->lock);
+        close(fd);
+        return ESP_FAIL;
+    }
+    return ESP_OK;
+}
+
+esp_err_t uart_sim_connect(uart_port_t a, uart_port_t b)
+{
+    struct sim_port *pa = sim_port(a);
+    struct sim_port *pb = sim_port(b);
+    if (pa == NULL || pb == NULL || a == b) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (pa->fd >= 0 || pb->fd >= 0) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    int fds[2];
+    if (socketpair(AF_UNIX, SOCK_STREAM, 0, fds) != 0) {
+        ESP_LOGE(TAG, "socketpair failed: %s", strerror(errno));
+        return ESP_FAIL;
+    }
+
+    esp_err_t ret = sim_attach(pa, fds[0]);
+    if (ret != ESP_OK) {
+        close(fds[1]);
+        return ret;
+    }
+    ret = sim_attach(pb, fds[1]);
+    if (ret != ESP_OK) {
+        uart_sim_disconnect(a);
+    }
+    return ret;
+}
+
+esp_err_t uart_sim_open_pty(uart_port_t port_num, char *slave_path, size_t len)
+{
+    struct sim_port *port = sim_port(port_num);
+    if (port == NULL || slave_path == NULL || len == 0) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (port->fd >= 0) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    const int fd = posix_openpt(O_RDWR | O_NOCTTY);
+    if (fd < 0 || grantpt(fd) != 0 || unlockpt(fd) != 0 || ptsname_r(fd, slave_path, len) != 0) {
+        ESP_LOGE(TAG, "Could not create a pseudo-terminal: %s", strerror(errno));
+        if (fd >= 0) {
+            close(fd);
+        }
+        return ESP_FAIL;
+    }
+
+    struct termios raw;
+    if (tcgetattr(fd, &raw) == 0) {
+        cfmakeraw(&raw); /* bytes pass untouched, no echo or line editing */
+        tcsetattr(fd, TCSANOW, &raw);
+    }
+    return sim_attach(port, fd);
+}
+
+esp_err_t uart_sim_set_faults(uart_port_t port_num, const uart_sim_faults_t *faults)
+{
+    struct sim_port *port = sim_port(port_num);
+    if (port == NULL || faults == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    pthread_mutex_lock(&port->lock);
+    port->faults = *faults;
+    port->rng = (faults->seed != 0) ? faults->seed : SIM_DEFAULT_SEED;
+    pthread_mutex_unlock(&port->lock);
+    return ESP_OK;
+}
+
+esp_err_t uart_sim_get_stats(uart_port_t port_num, uart_sim_stats_t *stats)
+{
+    struct sim_port *port = sim_port(port_num);
+    if (port == NULL || stats == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    pthread_mutex_lock(&port->lock);
+    *stats = port->stats;
+    pthread_mutex_unlock(&port->lock);
+    return ESP_OK;
+}
+
+esp_err_t uart_sim_disconnect(uart_port_t port_num)
+{
+    struct sim_port *port = sim_port(port_num);
+    if (port == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    pthread_mutex_lock(&port->lock);
+    const bool running = port->running;
+    port->running = false;
+    pthread_cond_broadcast(&port->cond);
+    pthread_mutex_unlock(&port->lock);
+
+    if (running) {
+        pthread_join(port->thread, NULL);
+    }
+    if (port->fd >= 0) {
+        close(port->fd);
+        port->fd = -1;
+    }
+    return ESP_OK;
+}
+
+/* --- ESP-IDF UART driver subset --- */
+
+esp_err_t uart_param_config(uart_port_t uart_num, const uart_config_t *uart_config)
+{
+    struct sim_port *port = sim_port(uart_num);
+    if (port == NULL || uart_config == NULL || uart_config->baud_rate <= 0) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    pthread_mutex_lock(&port->lock);
+    port->config = *uart_config;
+    pthread_mutex_unlock(&port->lock);
+    return ESP_OK;
+}
+
+esp_err_t uart_set_pin(uart_port_t uart_num, int tx_io_num, int rx_io_num, int rts_io_num, int cts_io_num)
+{
+    return (sim_port(uart_num) != NULL) ? ESP_OK : ESP_ERR_INVALID_ARG;
+}
+
+esp_err_t uart_driver_install(uart_port_t uart_num, int rx_buffer_size, int tx_buffer_size,
+                              int queue_size, void *uart_queue, int intr_alloc_flags)
+{
+    struct sim_port *port = sim_port(uart_num);
+    if (port == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (port->fd < 0) {
+        ESP_LOGW(TAG, "UART %d is not wired, writes are discarded", uart_num);
+    }
+    port->installed = true;
+    return ESP_OK;
+}
+
+esp_err_t uart_driver_delete(uart_port_t uart_num)
+{
+    struct sim_port *port = sim_port(uart_num);
+    if (port == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    port->installed = false;
+    return ESP_OK;
+}
+
+esp_err_t uart_get_buffered_data_len(uart_port_t uart_num, size_t *size)
+{
+    struct sim_port *port = sim_port(uart_num);
+    if (port == NULL || size == NULL || !port->installed) {
+        return ESP_FAIL;
+    }
+
+    int available = 0;
+    if (port->fd >= 0 && ioctl(port->fd, FIONREAD, &available) != 0) {
+        available = 0;
+    }
+    *size = (size_t)available;
+    return ESP_OK;
+}
+
+int uart_read_bytes(uart_port_t uart_num, void *buf, uint32_t length, TickType_t ticks_to_wait)
+{
+    struct sim_port *port = sim_port(uart_num);
+    if (port == NULL || buf == NULL || !port->installed) {
+        return -1;
+    }
+    if (port->fd < 0 || length == 0) {
+        return 0;
+    }
+
+    /* Wait with vTaskDelay, a blocking syscall would stall the simulated scheduler */
+    const TickType_t start = xTaskGetTickCount();
+    size_t available = 0;
+    while (uart_get_buffered_data_len(uart_num, &available) == ESP_OK && available < length &&
+           xTaskGetTickCount() - start < ticks_to_wait) {
+        vTaskDelay(1);
+    }
+
+    const ssize_t n = read(port->fd, buf, length);
+    return (n > 0) ? (int)n : 0;
+}
+
+int uart_write_bytes(uart_port_t uart_num, const void *src, size_t size)
+{
+    struct sim_port *port = sim_port(uart_num);
+    if (port == NULL || src == NULL || !port->installed) {
+        return -1;
+    }
+
+    const uint8_t *data = src;
+    size_t left = size;
+    pthread_mutex_lock(&port->lock);
+    if (!port->running) {
+        port->stats.bytes_written += size; /* nothing on the other end of the pin */
+        pthread_mutex_unlock(&port->lock);
+        return (int)size;
+    }
+
+    while (left > 0) {
+        const size_t chunk = (left < SIM_TX_BYTES) ? left : SIM_TX_BYTES;
+        while (port->running &&
+               (SIM_TX_BYTES - (port->byte_head - port->byte_tail) < chunk ||
+                port->write_head - port->write_tail == SIM_TX_WRITES)) {
+            pthread_mutex_unlock(&port->lock);
+            vTaskDelay(1); /* transmit buffer full, like the real driver */
+            pthread_mutex_lock(&port->lock);
+        }
+
+        for (size_t i = 0; i < chunk; i++) {
+            port->bytes[(port->byte_head + i) % SIM_TX_BYTES] = data[i];
+        }
+        port->byte_head += chunk;
+        port->writes[port->write_head % SIM_TX_WRITES] = (struct sim_write){
+            .enqueued_us = sim_now_us(),
+            .len = (uint32_t)chunk,
+        };
+        port->write_head++;
+        port->stats.bytes_written += chunk;
+        pthread_cond_broadcast(&port->cond);
+
+        data += chunk;
+        left -= chunk;
+    }
+    pthread_mutex_unlock(&port->lock);
+    return (int)size;
+}
+
+esp_err_t uart_wait_tx_done(uart_port_t uart_num, TickType_t ticks_to_wait)
+{
+    struct sim_port *port = sim_port(uart_num);
+    if (port == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    const TickType_t start = xTaskGetTickCount();
+    for (;;) {
+        pthread_mutex_lock(&port->lock);
+        const bool done = !port->running || (port->write_head == port->write_tail && !port->busy);
+        pthread_mutex_unlock(&port->lock);
+        if (done) {
+            return ESP_OK;
+        }
+        if (xTaskGetTickCount() - start >= ticks_to_wait) {
+            return ESP_ERR_TIMEOUT;
+        }
+        vTaskDelay(1);
+    }
+}
+
+esp_err_t uart_flush_input(uart_port_t uart_num)
+{
+    struct sim_port *port = sim_port(uart_num);
+    if (port == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    uint8_t discard[256];
+    while (port->fd >= 0 && read(port->fd, discard, sizeof(discard)) > 0) {
+    }
+    return ESP_OK;
+}
@@ -2,8 +2,13 @@
 #include "esp_log.h"
 #include "testing_driver.h"
 #include "speed_test.h"
+#include "micro_benchmarks.h"
+#include "loopback_benchmarks.h"
 
 void app_main(void) {
+    // uncomment the line below to run the micro-benchmarks, see docs/api/benchmarks.md
+    //run_micro_benchmarks();
+
     init_MicroUSC_system();
     
     uart_config_t setting = STANDARD_UART_CONFIG; // only for debugging
@@ -39,6 +44,13 @@ void app_main(void) {
     CHECK_FUNCTION_SPEED_WITH_DEBUG(usc_driver_install("second driver", setting, pinss, driver_action));
     */
 
+    // uncomment the line below to measure the cost of posting a system event
+    //CHECK_FUNCTION_CYCLES(send_microusc_system_status(USC_SYSTEM_MEMORY_USAGE), 1000);
+
+    // uncomment the line below, instead of installing "first driver" above, to run the
+    // loopback benchmarks over UART1 and UART2, see docs/api/benchmarks.md
+    //run_loopback_benchmarks(NULL);
+
     send_microusc_system_status(USC_SYSTEM_LED_ON);
     send_microusc_system_status(USC_SYSTEM_SPECIFICATIONS);
     send_microusc_system_status(USC_SYSTEM_DRIVER_STATUS);
@@ -53,4 +65,4 @@ void app_main(void) {
     //send_microusc_system_status(USC_SYSTEM_ERROR);
     //send_microusc_system_status(USC_SYSTEM_SLEEP);
     printf("End of program\n");
-}
\ No newline at end of file
+}